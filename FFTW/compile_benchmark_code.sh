@@ -2,10 +2,36 @@
 
 FFTW_LIB=$1
 
+# The shared results reader lives in common/src in the repository, but is copied next to the
+# sources in the containers
+COMMON_SRC=../common/src
+if [ ! -d ${COMMON_SRC} ]; then
+    COMMON_SRC=src
+fi
+
 # For linking to FFTW3 libraries + ImageMagick
 export LD_LIBRARY_PATH=${FFTW_LIB}/double/.libs:${FFTW_LIB}/double/threads/.libs:/usr/local/lib
 
-# Compile
-gcc -O  src/guru_real_2D_dft_fftw_malloc.c -std=c11 -Wall -o 2d_fft -I/usr/include -I${FFTW_LIB}/api -L${FFTW_LIB}/double/.libs -L${FFTW_LIB}/double/threads/.libs -lfftw3 -lfftw3_threads -lm -lpthread -I/usr/local/include/ImageMagick-7 -I/usr/local/include/ImageMagick-7/MagickWand -L/usr/local/lib -lMagickCore-7.Q16HDRI -lMagickWand-7.Q16HDRI -DMAGICKCORE_QUANTUM_DEPTH=16 -DMAGICKCORE_HDRI_ENABLE=0
-gcc -O  src/multidimensional_cosine_dft.c -mcmodel=large -shared-libgcc -std=c11 -Wall -o nd_cosine_ffts -I/usr/include -I${FFTW_LIB}/api -L${FFTW_LIB}/double/.libs -L${FFTW_LIB}/double/threads/.libs -lfftw3 -lfftw3_threads -lm -lpthread
-gcc -O  src/plot_multidimensional_cosine_performance_results.c -std=c11 -Wall -o plot_cosine_performance -lm
+# nd_cosine_ffts always runs in double precision. If FFTW was also built in single, long double or
+# quad precision, those are built in too, and picked at runtime with --precision
+PRECISIONS=""
+if [ -d ${FFTW_LIB}/single/.libs ]; then
+    PRECISIONS="${PRECISIONS} -DFFTW3_FLOAT -L${FFTW_LIB}/single/.libs -lfftw3f"
+    export LD_LIBRARY_PATH=${LD_LIBRARY_PATH}:${FFTW_LIB}/single/.libs:${FFTW_LIB}/single/threads/.libs
+fi
+if [ -d ${FFTW_LIB}/long/.libs ]; then
+    PRECISIONS="${PRECISIONS} -DFFTW3_LONG_DOUBLE -L${FFTW_LIB}/long/.libs -lfftw3l"
+    export LD_LIBRARY_PATH=${LD_LIBRARY_PATH}:${FFTW_LIB}/long/.libs:${FFTW_LIB}/long/threads/.libs
+fi
+if [ -d ${FFTW_LIB}/quad/.libs ]; then
+    PRECISIONS="${PRECISIONS} -DFFTW3_QUAD -L${FFTW_LIB}/quad/.libs -lfftw3q -lquadmath"
+    export LD_LIBRARY_PATH=${LD_LIBRARY_PATH}:${FFTW_LIB}/quad/.libs:${FFTW_LIB}/quad/threads/.libs
+fi
+
+# Compile. FFTW's threads backend (libfftw3*_threads or libfftw3*_omp, found in the threads/.libs
+# directories above) is loaded at runtime with --threads-backend, so only the core libraries are
+# linked. -fopenmp is for the busy OpenMP pool of --busy-openmp.
+gcc -O  src/guru_real_2D_dft_fftw_malloc.c src/wisdom_cache.c src/threads_backend.c src/work_pool.c -fopenmp -std=c11 -Wall -o 2d_fft -I/usr/include -I${FFTW_LIB}/api -L${FFTW_LIB}/double/.libs -lfftw3 -lm -lpthread -ldl -I/usr/local/include/ImageMagick-7 -I/usr/local/include/ImageMagick-7/MagickWand -L/usr/local/lib -lMagickCore-7.Q16HDRI -lMagickWand-7.Q16HDRI -DMAGICKCORE_QUANTUM_DEPTH=16 -DMAGICKCORE_HDRI_ENABLE=0
+gcc -O  src/multidimensional_cosine_dft.c src/wisdom_cache.c src/threads_backend.c src/work_pool.c ${COMMON_SRC}/results_json.c -I${COMMON_SRC} -mcmodel=large -shared-libgcc -fopenmp -std=gnu11 -Wall -DFFTW3 -o nd_cosine_ffts -I/usr/include -I${FFTW_LIB}/api ${PRECISIONS} -L${FFTW_LIB}/double/.libs -lfftw3 -lm -lpthread -ldl
+gcc -O  src/compare_fftw_builds.c -std=gnu11 -Wall -o compare_fftw_builds -I/usr/include -I${FFTW_LIB}/api -ldl -lm
+gcc -O  src/plot_multidimensional_cosine_performance_results.c ${COMMON_SRC}/results_json.c -I${COMMON_SRC} -std=c11 -Wall -o plot_cosine_performance -lm
@@ -1,7 +1,7 @@
 #!/bin/bash
 
 usage() {
-    echo "Usage: $0 [-i iterations] [-e executable] [-j json_filename] [-r rank] [-d dimensions] [-f sampling_frequency] [-p] [-t] [-l log_filename] [-v thread_values] [-n] [-h]"
+    echo "Usage: $0 [-i iterations] [-e executable] [-j json_filename] [-r rank] [-d dimensions] [-f sampling_frequency] [-p] [-m planner_rigor] [-P precision] [-I] [-B howmany] [-R r2r_kinds] [-C input_cache_dir] [-w wisdom_dir] [-T threads_backends] [-O busy_openmp_threads] [-t] [-l log_filename] [-v thread_values] [-n] [-h]"
     echo "  REQUIRED:"
     echo "  -i  Number of iterations. For 2d_fft, use this value to emulate the number of images processed. For nd_cosine_ffts, use this value to emulate the number of cosine matrices to perform fourier transforms on."
     echo "  -e  Path to executable."
@@ -14,10 +14,19 @@ usage() {
     echo ""
     echo "  OPTIONAL FOR nd_cosine_ffts:"
     echo "  -p  Use this flag if you wish to plot the results of the cosine FFT program"
+    echo "  -m  FFTW planner rigor: estimate, measure, patient, or exhaustive. (Default: estimate)"
+    echo "  -P  Precision of the DFTs: double, float, long-double, or quad. Only the precisions nd_cosine_ffts was built with are available. (Default: double)"
+    echo "  -I  Run the nd_cosine_ffts DFTs in place, in FFTW's padded layout, to reduce memory use"
+    echo "  -R  Also run these real-to-real kinds with nd_cosine_ffts, e.g. \"REDFT10,REDFT01\" or \"all\""
+    echo "  -B  Run nd_cosine_ffts as a batch of this many transforms of the given dimensions, and compare it with a loop of single transforms"
+    echo "  -C  Directory of the nd_cosine_ffts input cache. Generated inputs are saved to it and memory-mapped by later runs."
     echo ""
     echo "  OPTIONAL:"
     echo "  -t  Max number of threads to use. Omit this option if you want to use the max number of (real) cores on your system."
     echo "  -l  The resulting log of all the runs will be saved to a file with this name. (Default: fftw_runs.log)"
+    echo "  -T  FFTW threads backends to run with: pthreads, openmp, work-stealing, both (pthreads and openmp) or all, e.g. \"pthreads,work-stealing\" to get the thread scaling of each backend (FFTW3 only). (Default: pthreads)"
+    echo "  -O  Keep a busy OpenMP pool of this many threads running alongside the FFTs, to simulate a co-located OpenMP workload (FFTW3 only)"
+    echo "  -w  Directory of the FFTW wisdom cache. Wisdom is imported from and saved to a file in this directory named after the CPU model, ISA and FFTW version (FFTW3 only)."
     echo "  -v  Values of the threads to use. For example, \"2 4 6 8\" will tell this script to run the tests on 2, 4, 6, and 8 threads."
     echo "  -n  Use numactl. This option is not required because Podman can't use numactl without running a privileged container."
     exit
@@ -33,9 +42,18 @@ num_executions=-2222
 rank=-2222
 fs=-2222
 plot=0
+rigor_opt=""
+precision_opt=""
+in_place_opt=""
+batch_opt=""
+r2r_opt=""
+wisdom_opt=""
+input_cache_opt=""
+threads_backends=""
+busy_openmp_opt=""
 json_doc="NULL"
 
-options=":hpi:f:e:t:d:l:v:r:j:n"
+options=":hpi:f:e:t:d:l:v:r:j:m:P:IB:R:C:w:T:O:n"
 while getopts "$options" x
 do
     case "$x" in
@@ -75,6 +93,38 @@ do
       j)
           json_doc=${OPTARG}
           ;;
+      m)
+          rigor_opt="--rigor ${OPTARG}"
+          ;;
+      P)
+          precision_opt="--precision ${OPTARG}"
+          ;;
+      I)
+          in_place_opt="--in-place"
+          ;;
+      B)
+          batch_opt="--batch ${OPTARG}"
+          ;;
+      R)
+          r2r_opt="--r2r ${OPTARG}"
+          ;;
+      C)
+          input_cache_opt="--input-cache ${OPTARG}"
+          ;;
+      w)
+          wisdom_opt="--wisdom-dir ${OPTARG}"
+          ;;
+      T)
+          threads_backends=${OPTARG//,/ }
+          if [ "$threads_backends" == "both" ]; then
+              threads_backends="pthreads openmp"
+          elif [ "$threads_backends" == "all" ]; then
+              threads_backends="pthreads openmp work-stealing"
+          fi
+          ;;
+      O)
+          busy_openmp_opt="--busy-openmp ${OPTARG}"
+          ;;
       *)  
           usage
           ;;
@@ -120,44 +170,56 @@ fi
 ###################################################
 if [ "$executable" == "2d_fft" ]; then
 
-    # If no thread values were supplied, then iterate in powers of two
-    if [ "$thread_values" == -1 ]; then
-        echo "Using default thread values."
-        for (( k=1; k<$max_threads; k*=2 ))
-        do
-            echo "Executing ./2d_fft $k $num_executions"
-            if [ $use_numactl == 1 ]; then
-                numactl -C 0-$((k-1)) -i 0,1 ./2d_fft $k $num_executions $json_doc >> $run_log
-            else
-                ./2d_fft $k $num_executions $json_doc >> $run_log
-            fi
-        done
-        if [ $max_threads > $k ]; then
-            echo "Executing ./2d_fft $max_threads $num_executions"
-            if [ $use_numactl == 1 ]; then
-                numactl -C 0-$((k-1)) -i 0,1 ./2d_fft $max_threads $num_executions $json_doc >> $run_log
-            else
-                ./2d_fft $k $num_executions $json_doc >> $run_log
-            fi
+    # Get the thread scaling of each threads backend. Without -T, the executable's default backend
+    # is used (which is the only one FFTW2 has).
+    for threads_backend in ${threads_backends:-default}; do
+        backend_opt=""
+        if [ "$threads_backend" != "default" ]; then
+            backend_opt="--threads-backend $threads_backend"
         fi
-    # Else, use the thread values the user specified
-    else
-        echo "Using custom thread values."
-        for k in $thread_values; do
-            echo "Executing ./2d_fft $k $num_executions"
-            if [ $use_numactl == 1 ]; then
-                numactl -C 0-$((k-1)) -i 0,1 ./2d_fft $k $num_executions $json_doc >> $run_log
-            else
-                ./2d_fft $k $num_executions $json_doc >> $run_log
+
+        # If no thread values were supplied, then iterate in powers of two
+        if [ "$thread_values" == -1 ]; then
+            echo "Using default thread values."
+            for (( k=1; k<$max_threads; k*=2 ))
+            do
+                echo "Executing ./2d_fft $k $num_executions ($threads_backend backend)"
+                if [ $use_numactl == 1 ]; then
+                    numactl -C 0-$((k-1)) -i 0,1 ./2d_fft $k $num_executions $json_doc $backend_opt $busy_openmp_opt $wisdom_opt >> $run_log
+                else
+                    ./2d_fft $k $num_executions $json_doc $backend_opt $busy_openmp_opt $wisdom_opt >> $run_log
+                fi
+            done
+            if [ $max_threads > $k ]; then
+                echo "Executing ./2d_fft $max_threads $num_executions ($threads_backend backend)"
+                if [ $use_numactl == 1 ]; then
+                    numactl -C 0-$((k-1)) -i 0,1 ./2d_fft $max_threads $num_executions $json_doc $backend_opt $busy_openmp_opt $wisdom_opt >> $run_log
+                else
+                    ./2d_fft $k $num_executions $json_doc $backend_opt $busy_openmp_opt $wisdom_opt >> $run_log
+                fi
             fi
-        done
-    fi
+        # Else, use the thread values the user specified
+        else
+            echo "Using custom thread values."
+            for k in $thread_values; do
+                echo "Executing ./2d_fft $k $num_executions ($threads_backend backend)"
+                if [ $use_numactl == 1 ]; then
+                    numactl -C 0-$((k-1)) -i 0,1 ./2d_fft $k $num_executions $json_doc $backend_opt $busy_openmp_opt $wisdom_opt >> $run_log
+                else
+                    ./2d_fft $k $num_executions $json_doc $backend_opt $busy_openmp_opt $wisdom_opt >> $run_log
+                fi
+            done
+        fi
+    done
 
 ###################################################
 #        FOR THE ND_COSINE_FFTS EXECUTABLE        #
 ###################################################
 elif [ "$executable" == "nd_cosine_ffts" ]; then
 
+    # nd_cosine_ffts exits with an error when its accuracy check fails, so count those runs
+    failed_runs=0
+
     # Make sure the user input a rank. If not, throw an wrror
     if (( $rank == -2222)); then
         echo "Missing argument -r. Please supply a value for -r."
@@ -201,37 +263,51 @@ elif [ "$executable" == "nd_cosine_ffts" ]; then
         should_plot="noplot"
     fi
 
-    # If no thread values were supplied, then iterate in powers of two
-    if [ "$thread_values" == -1 ]; then
-        echo "Using default thread values."
-        for (( k=1; k<$max_threads; k*=2 ))
-        do
-            echo "Executing ./nd_cosine_ffts $should_plot json=$json_doc nthreads=$k num_executions=$num_executions fs=$fs rank=$rank dims=\"$dimensions\""
-            if [ $use_numactl == 1 ]; then
-                numactl -C 0-$((k-1)) -i 0,1 ./nd_cosine_ffts $should_plot $json_doc $k $num_executions $fs $rank $dimensions >> $run_log
-            else
-                ./nd_cosine_ffts $should_plot $json_doc $k $num_executions $fs $rank $dimensions >> $run_log
-            fi
-        done
-        if [ $max_threads > $k ]; then
-            echo "Executing ./nd_cosine_ffts $should_plot json=$json_doc nthreads=$max_threads num_executions=$num_executions fs=$fs rank=$rank dims=\"$dimensions\""
-            if [ $use_numactl == 1 ]; then
-                numactl -C 0-$((max_threads-1)) -i 0,1 ./nd_cosine_ffts $should_plot $json_doc $max_threads $num_executions $fs $rank $dimensions >> $run_log
-            else
-                ./nd_cosine_ffts $should_plot $json_doc $max_threads $num_executions $fs $rank $dimensions >> $run_log
-            fi
+    # Get the thread scaling of each threads backend. Without -T, the executable's default backend
+    # is used (which is the only one FFTW2 has).
+    for threads_backend in ${threads_backends:-default}; do
+        backend_opt=""
+        if [ "$threads_backend" != "default" ]; then
+            backend_opt="--threads-backend $threads_backend"
         fi
-    # Else, use the thread values the user specified
-    else
-        echo "Using custom thread values."
-        for k in ${thread_values//,/ }; do
-            echo "Executing ./nd_cosine_ffts $should_plot json=$json_doc nthreads=$k num_executions=$num_executions fs=$fs rank=$rank dims=\"$dimensions\""
-            if [ $use_numactl == 1 ]; then
-                numactl -C 0-$((k-1)) -i 0,1 ./nd_cosine_ffts $should_plot $json_doc $k $num_executions $fs $rank $dimensions >> $run_log
-            else
-                ./nd_cosine_ffts $should_plot $json_doc $k $num_executions $fs $rank $dimensions >> $run_log
+
+        # If no thread values were supplied, then iterate in powers of two
+        if [ "$thread_values" == -1 ]; then
+            echo "Using default thread values."
+            for (( k=1; k<$max_threads; k*=2 ))
+            do
+                echo "Executing ./nd_cosine_ffts $should_plot json=$json_doc nthreads=$k num_executions=$num_executions fs=$fs rank=$rank dims=\"$dimensions\" backend=$threads_backend"
+                if [ $use_numactl == 1 ]; then
+                    numactl -C 0-$((k-1)) -i 0,1 ./nd_cosine_ffts $should_plot $json_doc $k $num_executions $fs $rank $dimensions $rigor_opt $precision_opt $in_place_opt $batch_opt $r2r_opt $input_cache_opt $backend_opt $busy_openmp_opt $wisdom_opt >> $run_log || failed_runs=$((failed_runs+1))
+                else
+                    ./nd_cosine_ffts $should_plot $json_doc $k $num_executions $fs $rank $dimensions $rigor_opt $precision_opt $in_place_opt $batch_opt $r2r_opt $input_cache_opt $backend_opt $busy_openmp_opt $wisdom_opt >> $run_log || failed_runs=$((failed_runs+1))
+                fi
+            done
+            if [ $max_threads > $k ]; then
+                echo "Executing ./nd_cosine_ffts $should_plot json=$json_doc nthreads=$max_threads num_executions=$num_executions fs=$fs rank=$rank dims=\"$dimensions\" backend=$threads_backend"
+                if [ $use_numactl == 1 ]; then
+                    numactl -C 0-$((max_threads-1)) -i 0,1 ./nd_cosine_ffts $should_plot $json_doc $max_threads $num_executions $fs $rank $dimensions $rigor_opt $precision_opt $in_place_opt $batch_opt $r2r_opt $input_cache_opt $backend_opt $busy_openmp_opt $wisdom_opt >> $run_log || failed_runs=$((failed_runs+1))
+                else
+                    ./nd_cosine_ffts $should_plot $json_doc $max_threads $num_executions $fs $rank $dimensions $rigor_opt $precision_opt $in_place_opt $batch_opt $r2r_opt $input_cache_opt $backend_opt $busy_openmp_opt $wisdom_opt >> $run_log || failed_runs=$((failed_runs+1))
+                fi
             fi
-        done
+        # Else, use the thread values the user specified
+        else
+            echo "Using custom thread values."
+            for k in ${thread_values//,/ }; do
+                echo "Executing ./nd_cosine_ffts $should_plot json=$json_doc nthreads=$k num_executions=$num_executions fs=$fs rank=$rank dims=\"$dimensions\" backend=$threads_backend"
+                if [ $use_numactl == 1 ]; then
+                    numactl -C 0-$((k-1)) -i 0,1 ./nd_cosine_ffts $should_plot $json_doc $k $num_executions $fs $rank $dimensions $rigor_opt $precision_opt $in_place_opt $batch_opt $r2r_opt $input_cache_opt $backend_opt $busy_openmp_opt $wisdom_opt >> $run_log || failed_runs=$((failed_runs+1))
+                else
+                    ./nd_cosine_ffts $should_plot $json_doc $k $num_executions $fs $rank $dimensions $rigor_opt $precision_opt $in_place_opt $batch_opt $r2r_opt $input_cache_opt $backend_opt $busy_openmp_opt $wisdom_opt >> $run_log || failed_runs=$((failed_runs+1))
+                fi
+            done
+        fi
+    done
+
+    if [ $failed_runs -gt 0 ]; then
+        echo "$failed_runs nd_cosine_ffts run(s) failed the accuracy check. See $run_log for details."
+        exit 1
     fi
 
 else
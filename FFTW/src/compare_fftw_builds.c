@@ -0,0 +1,590 @@
+/* Compares several FFTW builds in one run, e.g. the SSE2, AVX, AVX2 and AVX-512 builds of FFTW3 (and
+ * FFTW2, where it is installed), without rebuilding the benchmark or starting one container per ISA.
+ *
+ * Nothing from FFTW is linked in. The libraries of each build are loaded with dlmopen into a link
+ * map namespace of their own, so builds that export the same symbols under the same SONAME don't
+ * clash. Every build then plans the same r2c and c2r DFTs of the same cosine with the same rigor,
+ * on buffers of the same alignment, and the builds take turns executing them, so that a drift in
+ * clock speed or temperature during the run hits every build alike.
+ *
+ * Usage:
+ *     ./compare_fftw_builds <json> <threads> <iterations> <fs> <rank> <dims...>
+ *         --build <name>=<library>[,<library>...] [--build ...] [--rigor <estimate|measure|patient|exhaustive>]
+ *
+ * List the core library of a build first, then the libraries that depend on it, e.g.
+ *     --build avx2=/opt/fftw-avx2/lib/libfftw3.so,/opt/fftw-avx2/lib/libfftw3_threads.so
+ *     --build fftw2=/opt/fftw2/lib/libfftw.so,/opt/fftw2/lib/librfftw.so
+ */
+#define _GNU_SOURCE
+#define PI 3.141592653589793238462643383279
+#define MAX_RANK 100
+#define MAX_BUILDS 16               //glibc allows 16 link map namespaces, including the main one
+#define MAX_BUILD_LIBS 4
+#define MAX_BUILD_NAME_LEN 64
+#define DEFAULT_RIGOR "estimate"
+#define ALIGNMENT 64                //of every build's buffers, enough for AVX-512
+
+// FFTW2 constants (from fftw.h and rfftw.h, which cannot be included alongside fftw3.h)
+#define FFTW2_REAL_TO_COMPLEX -1
+#define FFTW2_COMPLEX_TO_REAL 1
+#define FFTW2_ESTIMATE 0
+#define FFTW2_MEASURE 1
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <dlfcn.h>
+#include <link.h>
+#include <sys/time.h>
+#include <fftw3.h> //types and constants only
+
+typedef enum {API_FFTW3, API_FFTW2} FFTWApi;
+
+typedef struct {
+    char name[MAX_BUILD_NAME_LEN];      //e.g. "avx2"
+    char *libraries;                    //comma separated paths, as given on the command line
+    void *handles[MAX_BUILD_LIBS];
+    int num_handles;
+    FFTWApi api;
+    const char *version;                //fftw_version of the build
+    int nthreads;                       //threads the build runs with (1 if it has no threads support)
+
+    // FFTW3
+    fftw_plan (*plan_dft_r2c)(int rank, const int *n, double *in, fftw_complex *out, unsigned flags);
+    fftw_plan (*plan_dft_c2r)(int rank, const int *n, fftw_complex *in, double *out, unsigned flags);
+    void (*execute)(const fftw_plan plan);
+    void (*destroy_plan)(fftw_plan plan);
+    int (*init_threads)(void);
+    void (*plan_with_nthreads)(int nthreads);
+    void (*flops)(const fftw_plan plan, double *add, double *mul, double *fmas);
+
+    // FFTW2 (plans are rfftwnd_plan, and fftw_complex has the same layout as in FFTW3)
+    void *(*rfftwnd_create_plan)(int rank, const int *n, int dir, int flags);
+    void (*rfftwnd_one_real_to_complex)(void *plan, double *in, fftw_complex *out);
+    void (*rfftwnd_one_complex_to_real)(void *plan, fftw_complex *in, double *out);
+    void (*rfftwnd_threads_one_real_to_complex)(int nthreads, void *plan, double *in, fftw_complex *out);
+    void (*rfftwnd_threads_one_complex_to_real)(int nthreads, void *plan, fftw_complex *in, double *out);
+    int (*threads_init)(void);
+    void (*rfftwnd_destroy_plan)(void *plan);
+
+    // Plans and buffers
+    void *forward_plan;
+    void *backward_plan;
+    double *real;
+    fftw_complex *complex;
+    double *back;
+
+    // Results
+    double forward_plan_time_us;
+    double backward_plan_time_us;
+    double total_f_exec_time_us;
+    double total_b_exec_time_us;
+    double forward_flops;               //floating point operations of one execution of each plan (0 if unknown)
+    double backward_flops;
+    double round_trip_error;            //relative L2 error of the normalized round trip
+    double spectrum_difference;         //largest difference from the first build's spectrum, relative to its peak
+} FFTWBuild;
+
+int parse_build(char *spec, FFTWBuild *build);
+int load_build(FFTWBuild *build, int nthreads);
+void *find_symbol(FFTWBuild *build, const char *name);
+void plan_build(FFTWBuild *build, int rank, int *n, int n_total, int n_complex_total, const char *rigor);
+void execute_forward(FFTWBuild *build);
+void execute_backward(FFTWBuild *build);
+void destroy_build(FFTWBuild *build);
+void print_json_string(FILE *file, const char *string);
+double elapsed_us(struct timeval *start, struct timeval *stop);
+
+int main(int argc, char *argv[]){
+
+    int i, j, b;
+    int num_args = 1;
+    int num_builds = 0;
+    FFTWBuild builds[MAX_BUILDS];
+    char *rigor = DEFAULT_RIGOR;
+    char *pEnd;
+
+    // Parse (and remove) the optional flags so that only the positional arguments are left
+    memset(builds, 0, sizeof(builds));
+    for (i=1; i<argc; i++){
+        if ((strcmp(argv[i], "--build") == 0 || strcmp(argv[i], "--rigor") == 0) && i + 1 >= argc){
+            fprintf(stderr, "%s requires a value.\n", argv[i]);
+            exit(0);
+        }
+
+        if (strcmp(argv[i], "--build") == 0){
+            if (num_builds == MAX_BUILDS - 1){
+                fprintf(stderr, "Too many builds. Please compare at most %d builds per run.\n", MAX_BUILDS - 1);
+                exit(0);
+            }
+            if (parse_build(argv[++i], &builds[num_builds]) != 0)
+                exit(0);
+            num_builds++;
+        }
+        else if (strcmp(argv[i], "--rigor") == 0)
+            rigor = argv[++i];
+        else
+            argv[num_args++] = argv[i];
+    }
+    argc = num_args;
+
+    if (argc < 7){
+        fprintf(stderr, "Please enter: (1.) JSON document name to save results to, (2.) number of threads to use, (3.) number of iterations to execute, (4.) the sampling frequency \"fs\" for the cosine, (5.) the rank of the cosine, (6.) the size of each dimension, and one --build <name>=<library>[,<library>...] per FFTW build.\n");
+        exit(0);
+    }
+    if (num_builds == 0){
+        fprintf(stderr, "No builds to compare. Please pass one --build <name>=<library>[,<library>...] per FFTW build.\n");
+        exit(0);
+    }
+    if (strcmp(rigor, "estimate") != 0 && strcmp(rigor, "measure") != 0 && strcmp(rigor, "patient") != 0 && strcmp(rigor, "exhaustive") != 0){
+        fprintf(stderr, "Invalid rigor '%s'. Please use \"estimate\", \"measure\", \"patient\", or \"exhaustive\".\n", rigor);
+        exit(0);
+    }
+
+    char *filename = argv[1];
+    int nthreads = (int)strtol(argv[2], &pEnd, 10);
+    int niters = (int)strtol(argv[3], &pEnd, 10);
+    double fs = strtod(argv[4], &pEnd);
+    int rank = (int)strtol(argv[5], &pEnd, 10);
+    int n[MAX_RANK];
+    int n_total = 1;
+
+    if (nthreads < 1 || niters < 1){
+        fprintf(stderr, "Please use at least 1 thread and 1 iteration.\n");
+        exit(0);
+    }
+    if (rank < 1 || rank > MAX_RANK || argc != 6 + rank){
+        fprintf(stderr, "Rank %s does not match the %d dimensions given (and must be between 1 and %d).\n", argv[5], argc - 6, MAX_RANK);
+        exit(0);
+    }
+    for (i=0; i<rank; i++){
+        n[i] = (int)strtol(argv[6+i], &pEnd, 10);
+        if (*pEnd != '\0' || n[i] < 1){
+            fprintf(stderr, "Invalid dimension '%s'. Please enter a whole number greater than or equal to 1.\n", argv[6+i]);
+            exit(0);
+        }
+        n_total *= n[i];
+    }
+    int n_complex_total = (n_total / n[rank-1]) * (n[rank-1] / 2 + 1);
+
+    if (access(filename, F_OK) != -1){
+        fprintf(stderr, "'%s' already exists. Please save the comparison to a new JSON document.\n", filename);
+        exit(0);
+    }
+
+    // Load every build before running any of them, so that a bad path fails fast
+    for (b=0; b<num_builds; b++){
+        if (load_build(&builds[b], nthreads) != 0)
+            exit(0);
+        if (builds[b].api == API_FFTW2 && strcmp(rigor, "estimate") != 0 && strcmp(rigor, "measure") != 0){
+            fprintf(stderr, "Build '%s' is FFTW2, which only knows the \"estimate\" and \"measure\" rigors.\n", builds[b].name);
+            exit(0);
+        }
+    }
+
+    // The cosine every build transforms, cos(pi x fs x i) over the flat index i
+    double *cosine = (double*)malloc(n_total * sizeof(double));
+    for (i=0; i<n_total; i++)
+        cosine[i] = cos(PI * fmod(fs * i, 2.0));
+
+    // Plan before filling the buffers, since measuring plans overwrites them
+    for (b=0; b<num_builds; b++)
+        plan_build(&builds[b], rank, n, n_total, n_complex_total, rigor);
+
+    // The builds take turns, iteration by iteration
+    struct timeval start, stop;
+    for (j=0; j<niters; j++){
+        for (b=0; b<num_builds; b++){
+            memcpy(builds[b].real, cosine, n_total * sizeof(double));
+
+            gettimeofday(&start, NULL);
+            execute_forward(&builds[b]);
+            gettimeofday(&stop, NULL);
+            builds[b].total_f_exec_time_us += elapsed_us(&start, &stop);
+
+            gettimeofday(&start, NULL);
+            execute_backward(&builds[b]);
+            gettimeofday(&stop, NULL);
+            builds[b].total_b_exec_time_us += elapsed_us(&start, &stop);
+        }
+    }
+
+    // Check each round trip against the cosine. The backward DFT destroyed the spectrum, so run the
+    // forward DFT once more to compare each build's spectrum with the first build's.
+    long double squared_error_total, squared_cosine_total, error, max_difference, peak = 0.0L;
+    for (b=0; b<num_builds; b++){
+        squared_error_total = 0.0L;
+        squared_cosine_total = 0.0L;
+        for (i=0; i<n_total; i++){
+            error = (long double)builds[b].back[i] / n_total - cosine[i];
+            squared_error_total += error * error;
+            squared_cosine_total += (long double)cosine[i] * cosine[i];
+        }
+        builds[b].round_trip_error = (squared_cosine_total > 0) ? (double)sqrtl(squared_error_total / squared_cosine_total) : 0.0;
+
+        memcpy(builds[b].real, cosine, n_total * sizeof(double));
+        execute_forward(&builds[b]);
+    }
+    for (i=0; i<n_complex_total; i++)
+        peak = fmaxl(peak, hypotl(builds[0].complex[i][0], builds[0].complex[i][1]));
+    for (b=0; b<num_builds; b++){
+        max_difference = 0.0L;
+        for (i=0; i<n_complex_total; i++){
+            error = hypotl((long double)builds[b].complex[i][0] - builds[0].complex[i][0], (long double)builds[b].complex[i][1] - builds[0].complex[i][1]);
+            max_difference = fmaxl(max_difference, error);
+        }
+        builds[b].spectrum_difference = (peak > 0) ? (double)(max_difference / peak) : 0.0;
+    }
+
+    // GFlops as in nd_cosine_ffts, from the operations each build's plans perform (fftw_flops), and
+    // FFTW mflops from FFTW's convention of 2.5 N log2(N) flops per r2c or c2r DFT of N real samples.
+    // FFTW2 builds can't count the operations of a plan, so their GFlops follow the convention. Both
+    // are 0 for DFTs too quick for the timer, to keep the JSON valid.
+    double convention_flops = 2.5 * n_total * log2(n_total);
+    double forward_gflops[MAX_BUILDS], backward_gflops[MAX_BUILDS];
+    double forward_fftw_mflops[MAX_BUILDS], backward_fftw_mflops[MAX_BUILDS];
+    for (b=0; b<num_builds; b++){
+        if (builds[b].forward_flops == 0)
+            builds[b].forward_flops = convention_flops;
+        if (builds[b].backward_flops == 0)
+            builds[b].backward_flops = convention_flops;
+        forward_gflops[b] = (builds[b].total_f_exec_time_us > 0) ? builds[b].forward_flops / (builds[b].total_f_exec_time_us / niters) * (1e-3) : 0.0;
+        backward_gflops[b] = (builds[b].total_b_exec_time_us > 0) ? builds[b].backward_flops / (builds[b].total_b_exec_time_us / niters) * (1e-3) : 0.0;
+        forward_fftw_mflops[b] = (builds[b].total_f_exec_time_us > 0) ? convention_flops / (builds[b].total_f_exec_time_us / niters) : 0.0;
+        backward_fftw_mflops[b] = (builds[b].total_b_exec_time_us > 0) ? convention_flops / (builds[b].total_b_exec_time_us / niters) : 0.0;
+    }
+
+    // Save as JSON
+    time_t raw_time = time(NULL);
+    struct tm *timeinfo = localtime(&raw_time);
+    FILE *json_file = fopen(filename, "w");
+    if (json_file == NULL){
+        fprintf(stderr, "Could not open '%s' for writing.\n", filename);
+        exit(0);
+    }
+    fprintf(json_file, "{\n");
+    fprintf(json_file, "    \"%d-%d-%d %d:%d:%d\": {\n", timeinfo->tm_year+1900, timeinfo->tm_mon+1, timeinfo->tm_mday, timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec);
+    fprintf(json_file, "        \"performance_results\": {\n");
+    fprintf(json_file, "            \"inputs\": {\n");
+    fprintf(json_file, "                \"rank\": %d,\n", rank);
+    fprintf(json_file, "                \"dims\": [");
+    for (i=0; i<rank; i++)
+        fprintf(json_file, " %d%s", n[i], (i < rank - 1) ? "," : "");
+    fprintf(json_file, "],\n");
+    fprintf(json_file, "                \"fs_Hz\": %0.2e,\n", fs);
+    fprintf(json_file, "                \"iterations\": %d,\n", niters);
+    fprintf(json_file, "                \"threads\": %d,\n", nthreads);
+    fprintf(json_file, "                \"rigor\": \"%s\"\n", rigor);
+    fprintf(json_file, "            },\n");
+    fprintf(json_file, "            \"builds\": [\n");
+    for (b=0; b<num_builds; b++){
+        fprintf(json_file, "                {\n");
+        fprintf(json_file, "                    \"name\": ");
+        print_json_string(json_file, builds[b].name);
+        fprintf(json_file, ",\n                    \"libraries\": ");
+        print_json_string(json_file, builds[b].libraries);
+        fprintf(json_file, ",\n                    \"api\": \"%s\",\n", (builds[b].api == API_FFTW3) ? "fftw3" : "fftw2");
+        fprintf(json_file, "                    \"version\": ");
+        print_json_string(json_file, builds[b].version);
+        fprintf(json_file, ",\n                    \"threads\": %d,\n", builds[b].nthreads);
+        fprintf(json_file, "                    \"forward_plan_time_seconds\": %0.6f,\n", builds[b].forward_plan_time_us * (1e-6));
+        fprintf(json_file, "                    \"backward_plan_time_seconds\": %0.6f,\n", builds[b].backward_plan_time_us * (1e-6));
+        fprintf(json_file, "                    \"forward_average_execution_time_seconds\": %0.6f,\n", builds[b].total_f_exec_time_us / niters * (1e-6));
+        fprintf(json_file, "                    \"forward_average_gflops\": %0.5f,\n", forward_gflops[b]);
+        fprintf(json_file, "                    \"forward_flops_per_execution\": %0.0f,\n", builds[b].forward_flops);
+        fprintf(json_file, "                    \"forward_fftw_mflops\": %0.3f,\n", forward_fftw_mflops[b]);
+        fprintf(json_file, "                    \"backward_average_execution_time_seconds\": %0.6f,\n", builds[b].total_b_exec_time_us / niters * (1e-6));
+        fprintf(json_file, "                    \"backward_average_gflops\": %0.5f,\n", backward_gflops[b]);
+        fprintf(json_file, "                    \"backward_flops_per_execution\": %0.0f,\n", builds[b].backward_flops);
+        fprintf(json_file, "                    \"backward_fftw_mflops\": %0.3f,\n", backward_fftw_mflops[b]);
+        fprintf(json_file, "                    \"round_trip_relative_l2_error\": %0.3e,\n", builds[b].round_trip_error);
+        fprintf(json_file, "                    \"spectrum_relative_difference\": %0.3e\n", builds[b].spectrum_difference);
+        fprintf(json_file, "                }%s\n", (b < num_builds - 1) ? "," : "");
+    }
+    fprintf(json_file, "            ]\n");
+    fprintf(json_file, "        }\n");
+    fprintf(json_file, "    }\n");
+    fprintf(json_file, "}\n");
+    fclose(json_file);
+
+    printf("\nFFTW BUILD COMPARISON\n");
+    printf("=====================\n");
+    printf("One %dD cosine: %d", rank, n[0]);
+    for (i=1; i<rank; i++)
+        printf(" x %d", n[i]);
+    printf(" samples, %d iterations, %d threads, rigor %s\n", niters, nthreads, rigor);
+    printf("%-16s %-24s %8s %12s %10s %12s %10s %12s %12s\n", "build", "version", "threads", "forward (s)", "GFlops", "backward (s)", "GFlops",
+           "round trip", "vs. first");
+    for (b=0; b<num_builds; b++){
+        printf("%-16s %-24s %8d %12.6f %10.3f %12.6f %10.3f %12.3e %12.3e\n", builds[b].name, builds[b].version, builds[b].nthreads,
+               builds[b].total_f_exec_time_us / niters * (1e-6), forward_gflops[b], builds[b].total_b_exec_time_us / niters * (1e-6),
+               backward_gflops[b], builds[b].round_trip_error, builds[b].spectrum_difference);
+    }
+
+    for (b=0; b<num_builds; b++)
+        destroy_build(&builds[b]);
+    free(cosine);
+
+    return 0;
+}
+
+int parse_build(char *spec, FFTWBuild *build){
+/* Parses a "<name>=<library>[,<library>...]" build
+ *
+ * Inputs
+ * ======
+ *   char *spec
+ *       The build, as given on the command line
+ *
+ *   FFTWBuild *build
+ *       Holds the name and libraries of the build
+ *
+ * Returns
+ * =======
+ *   0 on success, -1 if the build is invalid
+ */
+    char *libraries = strchr(spec, '=');
+
+    if (libraries == NULL || libraries == spec || libraries[1] == '\0' || (size_t)(libraries - spec) >= MAX_BUILD_NAME_LEN){
+        fprintf(stderr, "Invalid build '%s'. Please use \"<name>=<library>[,<library>...]\".\n", spec);
+        return -1;
+    }
+
+    memcpy(build->name, spec, libraries - spec);
+    build->name[libraries - spec] = '\0';
+    build->libraries = libraries + 1;
+    return 0;
+}
+
+void *find_symbol(FFTWBuild *build, const char *name){
+/* Looks a symbol up in each library of a build (NULL if none of them has it) */
+    int i;
+    void *symbol;
+
+    for (i=0; i<build->num_handles; i++){
+        symbol = dlsym(build->handles[i], name);
+        if (symbol != NULL)
+            return symbol;
+    }
+    return NULL;
+}
+
+int load_build(FFTWBuild *build, int nthreads){
+/* Loads the libraries of a build into a new namespace, and finds its FFTW3 or FFTW2 functions
+ *
+ * Inputs
+ * ======
+ *   FFTWBuild *build
+ *       The build to load, whose name and libraries are set
+ *
+ *   int nthreads
+ *       Number of threads to run with, if the build has threads support
+ *
+ * Returns
+ * =======
+ *   0 on success, -1 if a library could not be loaded or is not FFTW
+ */
+    char libraries[BUFSIZ];
+    char *library, *save_ptr;
+    void *version;
+    Lmid_t namespace = LM_ID_NEWLM;
+
+    snprintf(libraries, BUFSIZ, "%s", build->libraries);
+    for (library=strtok_r(libraries, ",", &save_ptr); library!=NULL; library=strtok_r(NULL, ",", &save_ptr)){
+        if (build->num_handles == MAX_BUILD_LIBS){
+            fprintf(stderr, "Too many libraries in build '%s'. Please use at most %d.\n", build->name, MAX_BUILD_LIBS);
+            return -1;
+        }
+
+        // The later libraries of the build go into the namespace of the first, where their
+        // dependency on it (by SONAME) resolves to it rather than to another build
+        build->handles[build->num_handles] = dlmopen(namespace, library, RTLD_NOW | RTLD_LOCAL);
+        if (build->handles[build->num_handles] == NULL){
+            fprintf(stderr, "Could not load '%s' for build '%s': %s\n", library, build->name, dlerror());
+            return -1;
+        }
+        if (build->num_handles == 0)
+            dlinfo(build->handles[0], RTLD_DI_LMID, &namespace);
+        build->num_handles++;
+    }
+
+    // FFTW3 exports fftw_version as a string, and FFTW2 as a pointer to one
+    version = find_symbol(build, "fftw_version");
+    build->plan_dft_r2c = find_symbol(build, "fftw_plan_dft_r2c");
+    build->rfftwnd_create_plan = find_symbol(build, "rfftwnd_create_plan");
+    if (build->plan_dft_r2c != NULL){
+        build->api = API_FFTW3;
+        build->version = (version != NULL) ? (const char*)version : "unknown";
+        build->plan_dft_c2r = find_symbol(build, "fftw_plan_dft_c2r");
+        build->execute = find_symbol(build, "fftw_execute");
+        build->destroy_plan = find_symbol(build, "fftw_destroy_plan");
+        build->init_threads = find_symbol(build, "fftw_init_threads");
+        build->plan_with_nthreads = find_symbol(build, "fftw_plan_with_nthreads");
+        build->flops = find_symbol(build, "fftw_flops");
+        if (build->plan_dft_c2r == NULL || build->execute == NULL || build->destroy_plan == NULL){
+            fprintf(stderr, "Build '%s' is missing FFTW3 functions.\n", build->name);
+            return -1;
+        }
+        build->nthreads = (build->init_threads != NULL && build->plan_with_nthreads != NULL) ? nthreads : 1;
+        if (build->nthreads > 1)
+            build->init_threads();
+    }
+    else if (build->rfftwnd_create_plan != NULL){
+        build->api = API_FFTW2;
+        build->version = (version != NULL) ? *(const char**)version : "unknown";
+        build->rfftwnd_one_real_to_complex = find_symbol(build, "rfftwnd_one_real_to_complex");
+        build->rfftwnd_one_complex_to_real = find_symbol(build, "rfftwnd_one_complex_to_real");
+        build->rfftwnd_threads_one_real_to_complex = find_symbol(build, "rfftwnd_threads_one_real_to_complex");
+        build->rfftwnd_threads_one_complex_to_real = find_symbol(build, "rfftwnd_threads_one_complex_to_real");
+        build->threads_init = find_symbol(build, "fftw_threads_init");
+        build->rfftwnd_destroy_plan = find_symbol(build, "rfftwnd_destroy_plan");
+        if (build->rfftwnd_one_real_to_complex == NULL || build->rfftwnd_one_complex_to_real == NULL || build->rfftwnd_destroy_plan == NULL){
+            fprintf(stderr, "Build '%s' is missing FFTW2 functions.\n", build->name);
+            return -1;
+        }
+        build->nthreads = (build->threads_init != NULL && build->rfftwnd_threads_one_real_to_complex != NULL &&
+                           build->rfftwnd_threads_one_complex_to_real != NULL) ? nthreads : 1;
+        if (build->nthreads > 1)
+            build->threads_init();
+    }
+    else{
+        fprintf(stderr, "Build '%s' is neither FFTW3 nor FFTW2 (it has no fftw_plan_dft_r2c or rfftwnd_create_plan).\n", build->name);
+        return -1;
+    }
+
+    if (build->nthreads < nthreads)
+        fprintf(stderr, "Build '%s' has no threads support, so it runs on 1 thread. Add its threads library to the build.\n", build->name);
+    return 0;
+}
+
+void plan_build(FFTWBuild *build, int rank, int *n, int n_total, int n_complex_total, const char *rigor){
+/* Allocates the buffers of a build and creates its forward and backward plans
+ *
+ * Inputs
+ * ======
+ *   FFTWBuild *build
+ *       The loaded build
+ *
+ *   int rank, int *n, int n_total, int n_complex_total
+ *       Rank and dimensions of the DFTs, and number of samples in their real and complex arrays
+ *
+ *   const char *rigor
+ *       Planner rigor, "estimate", "measure", "patient" or "exhaustive" (FFTW3 only)
+ */
+    struct timeval start, stop;
+    double add, mul, fmas;
+    unsigned flags = FFTW_ESTIMATE;
+    int fftw2_flags = (strcmp(rigor, "measure") == 0) ? FFTW2_MEASURE : FFTW2_ESTIMATE;
+
+    if (strcmp(rigor, "measure") == 0)
+        flags = FFTW_MEASURE;
+    else if (strcmp(rigor, "patient") == 0)
+        flags = FFTW_PATIENT;
+    else if (strcmp(rigor, "exhaustive") == 0)
+        flags = FFTW_EXHAUSTIVE;
+
+    // Every build gets buffers of the same alignment, rather than whatever its own fftw_malloc gives
+    if (posix_memalign((void**)&build->real, ALIGNMENT, n_total * sizeof(double)) != 0 ||
+        posix_memalign((void**)&build->complex, ALIGNMENT, n_complex_total * sizeof(fftw_complex)) != 0 ||
+        posix_memalign((void**)&build->back, ALIGNMENT, n_total * sizeof(double)) != 0){
+        fprintf(stderr, "Could not allocate the buffers of build '%s'.\n", build->name);
+        exit(0);
+    }
+
+    if (build->api == API_FFTW3){
+        if (build->plan_with_nthreads != NULL && build->nthreads > 1)
+            build->plan_with_nthreads(build->nthreads);
+
+        gettimeofday(&start, NULL);
+        build->forward_plan = build->plan_dft_r2c(rank, n, build->real, build->complex, flags);
+        gettimeofday(&stop, NULL);
+        build->forward_plan_time_us = elapsed_us(&start, &stop);
+
+        gettimeofday(&start, NULL);
+        build->backward_plan = build->plan_dft_c2r(rank, n, build->complex, build->back, flags);
+        gettimeofday(&stop, NULL);
+        build->backward_plan_time_us = elapsed_us(&start, &stop);
+    }
+    else{
+        gettimeofday(&start, NULL);
+        build->forward_plan = build->rfftwnd_create_plan(rank, n, FFTW2_REAL_TO_COMPLEX, fftw2_flags);
+        gettimeofday(&stop, NULL);
+        build->forward_plan_time_us = elapsed_us(&start, &stop);
+
+        gettimeofday(&start, NULL);
+        build->backward_plan = build->rfftwnd_create_plan(rank, n, FFTW2_COMPLEX_TO_REAL, fftw2_flags);
+        gettimeofday(&stop, NULL);
+        build->backward_plan_time_us = elapsed_us(&start, &stop);
+    }
+
+    if (build->forward_plan == NULL || build->backward_plan == NULL){
+        fprintf(stderr, "Build '%s' could not plan the DFTs.\n", build->name);
+        exit(0);
+    }
+
+    // Count the operations of the plans as FFTW does, a fused multiply-add counting as two
+    if (build->flops != NULL){
+        build->flops((fftw_plan)build->forward_plan, &add, &mul, &fmas);
+        build->forward_flops = add + mul + 2 * fmas;
+        build->flops((fftw_plan)build->backward_plan, &add, &mul, &fmas);
+        build->backward_flops = add + mul + 2 * fmas;
+    }
+}
+
+void execute_forward(FFTWBuild *build){
+/* Runs the r2c DFT of a build, from its real buffer to its complex buffer */
+    if (build->api == API_FFTW3)
+        build->execute((fftw_plan)build->forward_plan);
+    else if (build->nthreads > 1)
+        build->rfftwnd_threads_one_real_to_complex(build->nthreads, build->forward_plan, build->real, build->complex);
+    else
+        build->rfftwnd_one_real_to_complex(build->forward_plan, build->real, build->complex);
+}
+
+void execute_backward(FFTWBuild *build){
+/* Runs the c2r DFT of a build, from its complex buffer to its back buffer (destroying the former) */
+    if (build->api == API_FFTW3)
+        build->execute((fftw_plan)build->backward_plan);
+    else if (build->nthreads > 1)
+        build->rfftwnd_threads_one_complex_to_real(build->nthreads, build->backward_plan, build->complex, build->back);
+    else
+        build->rfftwnd_one_complex_to_real(build->backward_plan, build->complex, build->back);
+}
+
+void destroy_build(FFTWBuild *build){
+/* Destroys the plans and frees the buffers of a build. Its libraries stay loaded until exit. */
+    if (build->api == API_FFTW3){
+        build->destroy_plan((fftw_plan)build->forward_plan);
+        build->destroy_plan((fftw_plan)build->backward_plan);
+    }
+    else{
+        build->rfftwnd_destroy_plan(build->forward_plan);
+        build->rfftwnd_destroy_plan(build->backward_plan);
+    }
+    free(build->real);
+    free(build->complex);
+    free(build->back);
+}
+
+void print_json_string(FILE *file, const char *string){
+/* Prints a string as a JSON string, escaping quotes, backslashes and control characters */
+    fputc('"', file);
+    for (; *string != '\0'; string++){
+        if (*string == '"' || *string == '\\')
+            fprintf(file, "\\%c", *string);
+        else if ((unsigned char)*string < 0x20)
+            fprintf(file, "\\u%04x", (unsigned char)*string);
+        else
+            fputc(*string, file);
+    }
+    fputc('"', file);
+}
+
+double elapsed_us(struct timeval *start, struct timeval *stop){
+/* Gets the time between two gettimeofday calls in us */
+    return (stop->tv_sec - start->tv_sec) * (1e6) + (stop->tv_usec - start->tv_usec);
+}
@@ -0,0 +1,693 @@
+/* Template of the N-dimensional cosine DFT benchmark for one FFTW3 precision.
+ *
+ * multidimensional_cosine_dft.c includes this file once per precision, with these macros set:
+ *
+ *     X(name)          Mangles an FFTW name for the precision, e.g. X(plan) -> fftwf_plan
+ *     R                Real type of the precision, e.g. float
+ *     PRECISION_NAME   Name of the precision, e.g. "float"
+ *     BENCHMARK(name)  Mangles the names defined here, e.g. BENCHMARK(run_dft) -> run_dft_float
+ *     R_EPSILON        Machine epsilon of R, e.g. FLT_EPSILON
+ *     R_COS(x), R_PI   Cosine and pi, at least as precise as R (e.g. cosl and acosl(-1) for float)
+ *     LIBRARY_NAME     Name of FFTW's library for the precision, e.g. "fftw3f"
+ *     FUNCTION_PREFIX  Prefix of FFTW's functions for the precision, e.g. "fftwf"
+ *
+ * and undefines them afterward.
+ */
+
+static const WisdomPrecision BENCHMARK(wisdom_precision) = {PRECISION_NAME, X(import_wisdom_from_filename), X(export_wisdom_to_filename)};
+
+// Threads backend the plans are made with, loaded by run_dft (see threads_backend.h)
+static ThreadsBackend BENCHMARK(threads_backend);
+
+typedef struct {
+    X(plan) plan;
+    bool forward;               //r2c if true, c2r otherwise
+    R *real;
+    X(complex) *complex;
+    const BatchLayout *layout;
+    int first, last;            //transforms [first, last) of the batch to execute
+} BENCHMARK(BatchSlice);
+
+static X(plan) BENCHMARK(plan_many)(bool forward, int rank, int *n, int howmany, R *real, X(complex) *complex, const BatchLayout *layout, unsigned flags){
+/* Creates an r2c (forward) or c2r plan of 'howmany' transforms laid out as in 'layout'. The guru64
+ * interface takes every size and stride as a ptrdiff_t, so transforms may have over 2^31 samples. */
+    int i;
+    X(iodim64) dims[MAX_RANK];
+    X(iodim64) howmany_dims;
+
+    for (i=0; i<rank; i++){
+        dims[i].n = n[i];
+        dims[i].is = forward ? layout->real_strides[i] : layout->complex_strides[i];
+        dims[i].os = forward ? layout->complex_strides[i] : layout->real_strides[i];
+    }
+    howmany_dims.n = howmany;
+    howmany_dims.is = forward ? layout->real_dist : layout->complex_dist;
+    howmany_dims.os = forward ? layout->complex_dist : layout->real_dist;
+
+    if (forward)
+        return X(plan_guru64_dft_r2c)(rank, dims, 1, &howmany_dims, real, complex, flags);
+    return X(plan_guru64_dft_c2r)(rank, dims, 1, &howmany_dims, complex, real, flags);
+}
+
+static X(plan) BENCHMARK(plan_dft)(bool forward, int rank, int *n, int howmany, R *real, X(complex) *complex, const BatchLayout *layout,
+                                   int nthreads, unsigned flags, BenchmarkOptions *options, WisdomCache *cache, double *plan_time_us){
+/* Creates and times a plan. With a wisdom cache, the plan is first looked up in the wisdom alone (a
+ * hit) before planning from scratch (a miss).
+ *
+ * Inputs
+ * ======
+ *   bool forward
+ *       Plan an r2c DFT if true, a c2r DFT otherwise
+ *
+ *   int rank, int *n, int howmany
+ *       Rank and dimensions of each transform, and the number of transforms
+ *
+ *   R *real, X(complex) *complex, const BatchLayout *layout
+ *       Arrays to plan with (plans other than FFTW_ESTIMATE overwrite them) and their layout
+ *
+ *   int nthreads, unsigned flags
+ *       Number of threads and planner flags of the plan
+ *
+ *   BenchmarkOptions *options, WisdomCache *cache
+ *       Planner rigor and time limit, for describing the problem to the wisdom cache
+ *
+ *   double *plan_time_us
+ *       Holds how long it took to create the plan
+ */
+    struct timeval plan_start, plan_stop;
+    char kind[MAX_PROBLEM_DESCRIPTION_LEN];
+    char problem[MAX_PROBLEM_DESCRIPTION_LEN];
+    X(plan) plan = NULL;
+    bool hit;
+    int i, len;
+
+    BENCHMARK(threads_backend).plan_with_nthreads(nthreads);
+
+    gettimeofday(&plan_start, NULL);
+    if (cache->enabled)
+        plan = BENCHMARK(plan_many)(forward, rank, n, howmany, real, complex, layout, flags | FFTW_WISDOM_ONLY);
+    hit = (plan != NULL);
+    if (hit == false)
+        plan = BENCHMARK(plan_many)(forward, rank, n, howmany, real, complex, layout, flags);
+    gettimeofday(&plan_stop, NULL);
+    *plan_time_us = (plan_stop.tv_sec - plan_start.tv_sec) * (1e6) + (plan_stop.tv_usec - plan_start.tv_usec);
+
+    // A single transform is described as before batches existed, so that cached plan times still apply
+    if (howmany == 1 && layout->real_stride == 1 && layout->whole && (flags & FFTW_UNALIGNED) == 0)
+        snprintf(kind, MAX_PROBLEM_DESCRIPTION_LEN, "%s", forward ? "r2c" : "c2r");
+    else{
+        len = snprintf(kind, MAX_PROBLEM_DESCRIPTION_LEN, "%s howmany=%d stride=%td dist=%td%s", forward ? "r2c" : "c2r", howmany,
+                       layout->real_stride, layout->real_dist, (flags & FFTW_UNALIGNED) ? " unaligned" : "");
+        for (i=0; i<rank && layout->whole == false && len < MAX_PROBLEM_DESCRIPTION_LEN; i++)
+            len += snprintf(kind + len, MAX_PROBLEM_DESCRIPTION_LEN - len, "%s%d", (i == 0) ? " embed=" : "x", layout->real_embed[i]);
+        if (layout->transposed && len < MAX_PROBLEM_DESCRIPTION_LEN)
+            snprintf(kind + len, MAX_PROBLEM_DESCRIPTION_LEN - len, " transposed");
+    }
+    describe_problem(problem, kind, rank, n, nthreads, options);
+    wisdom_cache_record_plan(cache, problem, hit, *plan_time_us * (1e-6));
+
+    return plan;
+}
+
+static double BENCHMARK(plan_flops)(const X(plan) plan){
+/* Counts the floating point operations of one execution of a plan, as FFTW does: a fused
+ * multiply-add counts as two */
+    double add, mul, fmas;
+
+    X(flops)(plan, &add, &mul, &fmas);
+    return add + mul + 2 * fmas;
+}
+
+static void *BENCHMARK(execute_slice)(void *slice_args){
+/* Executes transforms [first, last) of a batch one at a time with a single-transform plan (which
+ * FFTW allows from several threads at once) */
+    BENCHMARK(BatchSlice) *slice = (BENCHMARK(BatchSlice)*)slice_args;
+    size_t real_offset, complex_offset;
+    int b;
+
+    for (b=slice->first; b<slice->last; b++){
+        real_offset = (size_t)b * slice->layout->real_dist;
+        complex_offset = (size_t)b * slice->layout->complex_dist;
+        if (slice->forward)
+            X(execute_dft_r2c)(slice->plan, slice->real + real_offset, slice->complex + complex_offset);
+        else
+            X(execute_dft_c2r)(slice->plan, slice->complex + complex_offset, slice->real + real_offset);
+    }
+    return NULL;
+}
+
+static void BENCHMARK(execute_loop)(X(plan) plan, bool forward, R *real, X(complex) *complex, const BatchLayout *layout, int nthreads,
+                                    WorkPool *pool){
+/* Executes every transform of a batch with a single-transform plan, split into 'nthreads' slices
+ * which each run on their own thread, or as jobs of the work pool if there is one (or in this
+ * thread if 'nthreads' is 1) */
+    BENCHMARK(BatchSlice) slices[nthreads];
+    pthread_t threads[nthreads];
+    int t;
+
+    for (t=0; t<nthreads; t++){
+        slices[t] = (BENCHMARK(BatchSlice)){plan, forward, real, complex, layout,
+                                            (int)((long)layout->howmany * t / nthreads), (int)((long)layout->howmany * (t+1) / nthreads)};
+    }
+
+    if (nthreads == 1){
+        BENCHMARK(execute_slice)(&slices[0]);
+        return;
+    }
+    if (pool != NULL){
+        work_pool_run(pool, BENCHMARK(execute_slice), slices, sizeof(BENCHMARK(BatchSlice)), nthreads);
+        return;
+    }
+    for (t=0; t<nthreads; t++)
+        pthread_create(&threads[t], NULL, BENCHMARK(execute_slice), &slices[t]);
+    for (t=0; t<nthreads; t++)
+        pthread_join(threads[t], NULL);
+}
+
+static void BENCHMARK(fill_batch)(R *real, const double *cosine, ptrdiff_t n_total, const BatchLayout *layout){
+/* Copies the cosine into every transform of the batch (this MUST be done after the plans are created) */
+    int b;
+    ptrdiff_t i;
+
+    for (b=0; b<layout->howmany; b++){
+        for (i=0; i<n_total; i++)
+            real[batch_index(layout, b, i)] = (R)cosine[i];
+    }
+}
+
+static void BENCHMARK(normalize_batch)(R *back, ptrdiff_t n_total, const BatchLayout *layout){
+/* Divides every transform of a batch by its number of samples, since FFTW's round trip scales it by that */
+    int b;
+    ptrdiff_t k;
+
+    for (b=0; b<layout->howmany; b++){
+        for (k=0; k<n_total; k++)
+            back[batch_index(layout, b, k)] /= n_total;
+    }
+}
+
+static void BENCHMARK(copy_batch)(R *dst, const BatchLayout *dst_layout, const R *src, const BatchLayout *src_layout, ptrdiff_t n_total){
+/* Copies every transform of a batch from one layout to another, a row of the last dimension at a
+ * time, the way a program would copy strided data to contiguous arrays before transforming it */
+    int b, m;
+    int row_length = src_layout->row_length;
+    ptrdiff_t row;
+    ptrdiff_t dst_stride = dst_layout->real_strides[dst_layout->rank-1];
+    ptrdiff_t src_stride = src_layout->real_strides[src_layout->rank-1];
+    R *dst_row;
+    const R *src_row;
+
+    for (b=0; b<src_layout->howmany; b++){
+        for (row=0; row<n_total/row_length; row++){
+            dst_row = dst + batch_index(dst_layout, b, row * row_length);
+            src_row = src + batch_index(src_layout, b, row * row_length);
+            for (m=0; m<row_length; m++)
+                dst_row[m * dst_stride] = src_row[m * src_stride];
+        }
+    }
+}
+
+static void BENCHMARK(run_contiguous)(const double *cosine, int rank, int *n, ptrdiff_t n_total, int nthreads, int niters,
+                                      BenchmarkOptions *options, const BatchLayout *layout, R *strided_real, R *strided_back,
+                                      DFTBenchmarkResults *results){
+/* Runs a strided batch again from contiguous arrays, and times copying the strided input to them
+ * and the output back, to show what the strided layout costs
+ *
+ * Inputs
+ * ======
+ *   const double *cosine
+ *       The cosine data (in double precision)
+ *
+ *   int rank, int *n, ptrdiff_t n_total
+ *       Rank, dimensions and total number of samples of each transform
+ *
+ *   int nthreads, int niters
+ *       Number of threads to use and number of iterations to execute
+ *
+ *   BenchmarkOptions *options
+ *       Planner flags and the wisdom cache settings, and the batch
+ *
+ *   const BatchLayout *layout, R *strided_real, R *strided_back
+ *       The strided layout, and the strided input and output arrays to copy from and to
+ *
+ *   DFTBenchmarkResults *results
+ *       Holds the execution times from the contiguous arrays and the copy times
+ */
+    int j;
+    struct timeval start, stop;
+    double plan_time_us;
+
+    // The same batch, one transform after another
+    BatchLayout contiguous;
+    BenchmarkOptions contiguous_options = *options;
+    contiguous_options.batch_stride = 1;
+    contiguous_options.batch_dist = 0;
+    contiguous_options.num_embed = 0;
+    contiguous_options.transpose = false;
+    batch_layout(rank, n, n_total, &contiguous_options, &contiguous);
+
+    R *real = (R*)X(malloc)(contiguous.real_size * sizeof(R));
+    R *back = (R*)X(malloc)(contiguous.real_size * sizeof(R));
+    X(complex) *complex = (X(complex)*)X(malloc)(contiguous.complex_size * sizeof(X(complex)));
+    X(plan) forward_plan = BENCHMARK(plan_dft)(true, rank, n, contiguous.howmany, real, complex, &contiguous,
+                                               nthreads, options->plan_flags, options, &results->wisdom_cache, &plan_time_us);
+    X(plan) backward_plan = BENCHMARK(plan_dft)(false, rank, n, contiguous.howmany, back, complex, &contiguous,
+                                                nthreads, options->plan_flags, options, &results->wisdom_cache, &plan_time_us);
+
+    for (j=0; j<niters; j++){
+        BENCHMARK(fill_batch)(strided_real, cosine, n_total, layout);
+
+        gettimeofday(&start, NULL);
+        BENCHMARK(copy_batch)(real, &contiguous, strided_real, layout, n_total);
+        gettimeofday(&stop, NULL);
+        results->total_copy_in_time_us += (stop.tv_sec - start.tv_sec) * (1e6) + (stop.tv_usec - start.tv_usec);
+
+        gettimeofday(&start, NULL);
+        X(execute)(forward_plan);
+        gettimeofday(&stop, NULL);
+        results->total_f_contiguous_exec_time_us += (stop.tv_sec - start.tv_sec) * (1e6) + (stop.tv_usec - start.tv_usec);
+
+        gettimeofday(&start, NULL);
+        X(execute)(backward_plan);
+        gettimeofday(&stop, NULL);
+        results->total_b_contiguous_exec_time_us += (stop.tv_sec - start.tv_sec) * (1e6) + (stop.tv_usec - start.tv_usec);
+
+        gettimeofday(&start, NULL);
+        BENCHMARK(copy_batch)(strided_back, layout, back, &contiguous, n_total);
+        gettimeofday(&stop, NULL);
+        results->total_copy_out_time_us += (stop.tv_sec - start.tv_sec) * (1e6) + (stop.tv_usec - start.tv_usec);
+    }
+
+    X(destroy_plan)(forward_plan);
+    X(destroy_plan)(backward_plan);
+    X(free)(real);
+    X(free)(back);
+    X(free)(complex);
+}
+
+static double BENCHMARK(check_spectrum)(X(plan) forward_plan, R *real, X(complex) *complex, ptrdiff_t n_total, const BatchLayout *layout){
+/* Transforms a cosine of k0 = n[rank-1]/4 periods along the last dimension (and constant along the
+ * others), whose spectrum is known: n_total/2 at bin k0 of the first row (n_total if k0 is 0), and
+ * 0 everywhere else. Returns the largest deviation from that spectrum, relative to its peak.
+ *
+ * Inputs
+ * ======
+ *   X(plan) forward_plan
+ *       The r2c plan of the batch, which reads 'real' and writes 'complex'
+ *
+ *   R *real, X(complex) *complex, ptrdiff_t n_total, const BatchLayout *layout
+ *       Arrays of the plan, total number of samples of each transform, and their layout
+ */
+    int b;
+    ptrdiff_t i, k;
+    int row_length = layout->row_length;
+    int k0 = row_length / 4;
+    ptrdiff_t n_complex_total = (n_total / row_length) * (row_length / 2 + 1);
+    R peak = (k0 == 0) ? (R)n_total : (R)n_total / 2;
+    R re, im;
+    long double error, max_error = 0.0L;
+    X(complex) *bin;
+
+    // (k0 x m) mod n keeps the argument of the cosine within one period
+    for (b=0; b<layout->howmany; b++){
+        for (i=0; i<n_total; i++)
+            real[batch_index(layout, b, i)] = (R)R_COS(2 * R_PI * (int)(((long)k0 * (i % row_length)) % row_length) / row_length);
+    }
+    X(execute)(forward_plan);
+
+    for (b=0; b<layout->howmany; b++){
+        for (k=0; k<n_complex_total; k++){
+            bin = &complex[(size_t)b * layout->complex_dist + (size_t)k * layout->complex_stride];
+            re = (*bin)[0] - ((k == k0) ? peak : 0);
+            im = (*bin)[1];
+            error = sqrtl((long double)re * (long double)re + (long double)im * (long double)im);
+            if (error > max_error)
+                max_error = error;
+        }
+    }
+    return (double)(max_error / (long double)peak);
+}
+
+static X(plan) BENCHMARK(plan_r2r)(const char *kind_name, X(r2r_kind) *kinds, int rank, int *n, R *in, R *out, int nthreads,
+                                   BenchmarkOptions *options, WisdomCache *cache, double *plan_time_us){
+/* Creates and times a real-to-real plan, looking it up in the wisdom first like plan_dft
+ *
+ * Inputs
+ * ======
+ *   const char *kind_name, X(r2r_kind) *kinds
+ *       Name of the kind of transform (e.g. "REDFT10") and its kind along each dimension
+ *
+ *   int rank, int *n, R *in, R *out
+ *       Rank and dimensions of the transform, and the arrays to plan with
+ *
+ *   int nthreads
+ *       Number of threads of the plan
+ *
+ *   BenchmarkOptions *options, WisdomCache *cache
+ *       Planner rigor and time limit, for describing the problem to the wisdom cache
+ *
+ *   double *plan_time_us
+ *       Holds how long it took to create the plan
+ */
+    struct timeval plan_start, plan_stop;
+    char kind[MAX_PROBLEM_DESCRIPTION_LEN];
+    char problem[MAX_PROBLEM_DESCRIPTION_LEN];
+    X(plan) plan = NULL;
+    X(iodim64) dims[MAX_RANK];
+    ptrdiff_t stride = 1;
+    bool hit;
+    int i;
+
+    // Contiguous, row-major dimensions, described with ptrdiff_t strides like the r2c plans
+    for (i=rank-1; i>=0; i--){
+        dims[i].n = n[i];
+        dims[i].is = stride;
+        dims[i].os = stride;
+        stride *= n[i];
+    }
+
+    BENCHMARK(threads_backend).plan_with_nthreads(nthreads);
+
+    gettimeofday(&plan_start, NULL);
+    if (cache->enabled)
+        plan = X(plan_guru64_r2r)(rank, dims, 0, NULL, in, out, kinds, options->plan_flags | FFTW_WISDOM_ONLY);
+    hit = (plan != NULL);
+    if (hit == false)
+        plan = X(plan_guru64_r2r)(rank, dims, 0, NULL, in, out, kinds, options->plan_flags);
+    gettimeofday(&plan_stop, NULL);
+    *plan_time_us = (plan_stop.tv_sec - plan_start.tv_sec) * (1e6) + (plan_stop.tv_usec - plan_start.tv_usec);
+
+    snprintf(kind, MAX_PROBLEM_DESCRIPTION_LEN, "r2r %s", kind_name);
+    describe_problem(problem, kind, rank, n, nthreads, options);
+    wisdom_cache_record_plan(cache, problem, hit, *plan_time_us * (1e-6));
+
+    return plan;
+}
+
+static void BENCHMARK(run_r2r)(const double *cosine, int rank, int *n, ptrdiff_t n_total, int nthreads, int niters, BenchmarkOptions *options,
+                               const R2RKind *kind, WisdomCache *cache, R2RBenchmarkResults *results){
+/* Runs a real-to-real transform (e.g. a DCT-II, REDFT10) of a cosine along every dimension, then its
+ * inverse kind (e.g. a DCT-III, REDFT01), and checks the round trip
+ *
+ * Inputs
+ * ======
+ *   const double *cosine
+ *       The cosine data (in double precision)
+ *
+ *   int rank, int *n, ptrdiff_t n_total
+ *       Rank, dimensions and total number of samples of the cosine
+ *
+ *   int nthreads, int niters
+ *       Number of threads to use and number of iterations to execute
+ *
+ *   BenchmarkOptions *options
+ *       Planner rigor and time limit
+ *
+ *   const R2RKind *kind, WisdomCache *cache
+ *       Kind of transform to run, and the wisdom cache to plan with
+ *
+ *   R2RBenchmarkResults *results
+ *       Holds the plan and execution times, the operations of the plans and the round trip error
+ */
+    int i, j;
+    ptrdiff_t k;
+    struct timeval start, stop;
+    X(r2r_kind) forward_kinds[MAX_RANK], backward_kinds[MAX_RANK];
+    long double logical_size = 1.0L;
+
+    // The round trip scales the data by the size of the logical DFT each kind is equivalent to,
+    // e.g. 2n for REDFT10 and 2(n-1) for REDFT00, along every dimension
+    for (i=0; i<rank; i++){
+        forward_kinds[i] = (X(r2r_kind))kind->kind;
+        backward_kinds[i] = (X(r2r_kind))kind->inverse;
+        logical_size *= 2 * (n[i] + kind->logical_offset);
+    }
+
+    results->kind = kind;
+
+    R *in = (R*)X(malloc)((size_t)n_total * sizeof(R));
+    R *out = (R*)X(malloc)((size_t)n_total * sizeof(R));
+    R *back = (R*)X(malloc)((size_t)n_total * sizeof(R));
+
+    X(plan) forward_plan = BENCHMARK(plan_r2r)(kind->name, forward_kinds, rank, n, in, out, nthreads, options, cache, &results->forward_plan_time_us);
+    X(plan) backward_plan = BENCHMARK(plan_r2r)(kind->inverse_name, backward_kinds, rank, n, out, back, nthreads, options, cache, &results->backward_plan_time_us);
+    results->forward_flops = BENCHMARK(plan_flops)(forward_plan);
+    results->backward_flops = BENCHMARK(plan_flops)(backward_plan);
+
+    for (j=0; j<niters; j++){
+        for (k=0; k<n_total; k++)
+            in[k] = (R)cosine[k];
+
+        gettimeofday(&start, NULL);
+        X(execute)(forward_plan);
+        gettimeofday(&stop, NULL);
+        results->total_f_exec_time_us += (stop.tv_sec - start.tv_sec) * (1e6) + (stop.tv_usec - start.tv_usec);
+
+        gettimeofday(&start, NULL);
+        X(execute)(backward_plan);
+        gettimeofday(&stop, NULL);
+        results->total_b_exec_time_us += (stop.tv_sec - start.tv_sec) * (1e6) + (stop.tv_usec - start.tv_usec);
+    }
+
+    X(destroy_plan)(forward_plan);
+    X(destroy_plan)(backward_plan);
+
+    long double squared_error_total = 0.0L, squared_cosine_total = 0.0L, error;
+    for (k=0; k<n_total; k++){
+        error = (long double)back[k] / logical_size - (long double)(R)cosine[k];
+        squared_error_total += error * error;
+        squared_cosine_total += (long double)(R)cosine[k] * (long double)(R)cosine[k];
+    }
+    results->round_trip_error = (squared_cosine_total > 0) ? (double)sqrtl(squared_error_total / squared_cosine_total) : 0.0;
+
+    X(free)(in);
+    X(free)(out);
+    X(free)(back);
+}
+
+void BENCHMARK(run_dft)(const double *cosine, int rank, int *n, ptrdiff_t n_total, int nthreads, int niters, BenchmarkOptions *options, DFTBenchmarkResults *results){
+/* Runs the forward and backward DFTs of a cosine in one precision
+ *
+ * Inputs
+ * ======
+ *   const double *cosine
+ *       The cosine data (in double precision), which is converted to the precision of the DFTs
+ *
+ *   int rank, int *n, ptrdiff_t n_total
+ *       Rank, dimensions and total number of samples of the cosine
+ *
+ *   int nthreads, int niters
+ *       Number of threads to use and number of iterations to execute
+ *
+ *   BenchmarkOptions *options
+ *       Threads backend, planner rigor, time limit, wisdom cache, whether to transform in place, the batch, and
+ *       the real-to-real kinds to run after the r2c DFT
+ *
+ *   DFTBenchmarkResults *results
+ *       Holds the plan and execution times, the operations of the plans, the normalized round trip
+ *       (if 'cosine_back' is not NULL), its error, the size of the DFT buffers, and the results of
+ *       each real-to-real kind
+ */
+    int i, j, b;
+    ptrdiff_t k;
+    struct timeval forward_dft_start, forward_dft_stop;
+    struct timeval backward_dft_start, backward_dft_stop;
+    struct timeval phase_start, phase_stop;
+    double forward_dft_execution_time_us, backward_dft_execution_time_us;
+    double loop_plan_time_us;
+    unsigned flags = options->plan_flags;
+
+    // Lay out the batch. Without --batch, it's a single transform (in FFTW's padded layout if in place).
+    BatchLayout layout;
+    batch_layout(rank, n, n_total, options, &layout);
+
+    // Set threading. Each plan is created with the number of threads it should run on, rather than
+    // passing in the number of threads each time we execute a transform
+    if (threads_backend_open(&BENCHMARK(threads_backend), options->threads_backend, LIBRARY_NAME, FUNCTION_PREFIX,
+                             options->work_pool) != 0)
+        exit(0);
+    if (threads_backend_init(&BENCHMARK(threads_backend)) != 0)
+        exit(0);
+
+    // Set time limit so that FFTW doesn't spend too much time trying to figure out the "best" algorithm.
+    X(set_timelimit)((options->plan_timelimit < 0) ? FFTW_NO_TIMELIMIT : options->plan_timelimit);
+
+    // Import the wisdom saved for this host (if any) so that plans made before can be reused
+    if (wisdom_cache_open(&results->wisdom_cache, options->wisdom_dir, &BENCHMARK(wisdom_precision)) != 0)
+        exit(0);
+
+    // Initialize real-to-complex cosine input and output, and the cosine that will be returned from
+    // the complex DFT. In place, all three are the same (padded) array.
+    R *cosine_original, *cosine_back;
+    X(complex) *cosine_complex = (X(complex)*)X(malloc)(layout.complex_size * sizeof(X(complex)));
+    if (options->in_place){
+        cosine_original = (R*)cosine_complex;
+        cosine_back = (R*)cosine_complex;
+        results->dft_buffer_bytes = layout.complex_size * sizeof(X(complex));
+    }
+    else{
+        cosine_original = (R*)X(malloc)(layout.real_size * sizeof(R));
+        cosine_back = (R*)X(malloc)(layout.real_size * sizeof(R));
+        results->dft_buffer_bytes = layout.complex_size * sizeof(X(complex)) + 2 * layout.real_size * sizeof(R);
+    }
+
+    // We'll need to do work on a dummy array to prevent the compiler from optimizing the loop
+    int dummy[niters];
+    ptrdiff_t rand_idx; //random index
+    ptrdiff_t max_idx = n_total - 1; //max index of the cosine array (matrix)
+
+    // Create FFTW plans once, before iterating, and time the planning separately from the
+    // transforms. Plans other than FFTW_ESTIMATE overwrite the arrays while planning.
+    X(plan) forward_cos_dft_plan = BENCHMARK(plan_dft)(true, rank, n, layout.howmany, cosine_original, cosine_complex, &layout,
+                                                       nthreads, flags, options, &results->wisdom_cache, &results->forward_plan_time_us);
+    X(plan) backward_cos_dft_plan = BENCHMARK(plan_dft)(false, rank, n, layout.howmany, cosine_back, cosine_complex, &layout,
+                                                        nthreads, flags, options, &results->wisdom_cache, &results->backward_plan_time_us);
+    results->forward_flops = BENCHMARK(plan_flops)(forward_cos_dft_plan);
+    results->backward_flops = BENCHMARK(plan_flops)(backward_cos_dft_plan);
+
+    // A batch is also run as a loop of single transforms, first with the same threads as the batch
+    // plan, then with one single-threaded transform per thread. Each transform of the batch starts
+    // at a different offset, so these plans must not assume the arrays are SIMD aligned.
+    X(plan) forward_loop_plan = NULL, backward_loop_plan = NULL;
+    X(plan) forward_parallel_plan = NULL, backward_parallel_plan = NULL;
+    if (layout.howmany > 1){
+        forward_loop_plan = BENCHMARK(plan_dft)(true, rank, n, 1, cosine_original, cosine_complex, &layout,
+                                                nthreads, flags | FFTW_UNALIGNED, options, &results->wisdom_cache, &loop_plan_time_us);
+        backward_loop_plan = BENCHMARK(plan_dft)(false, rank, n, 1, cosine_back, cosine_complex, &layout,
+                                                 nthreads, flags | FFTW_UNALIGNED, options, &results->wisdom_cache, &loop_plan_time_us);
+        forward_parallel_plan = BENCHMARK(plan_dft)(true, rank, n, 1, cosine_original, cosine_complex, &layout,
+                                                    1, flags | FFTW_UNALIGNED, options, &results->wisdom_cache, &loop_plan_time_us);
+        backward_parallel_plan = BENCHMARK(plan_dft)(false, rank, n, 1, cosine_back, cosine_complex, &layout,
+                                                     1, flags | FFTW_UNALIGNED, options, &results->wisdom_cache, &loop_plan_time_us);
+    }
+
+    // Run a strided batch from contiguous arrays first, so that the round trip checked below is
+    // still the one of the strided plans
+    if (layout.strided)
+        BENCHMARK(run_contiguous)(cosine, rank, n, n_total, nthreads, niters, options, &layout, cosine_original, cosine_back, results);
+
+    // Iterate
+    for (j=0; j<niters; j++){
+        // Fill input cosine array
+        gettimeofday(&phase_start, NULL);
+        BENCHMARK(fill_batch)(cosine_original, cosine, n_total, &layout);
+        gettimeofday(&phase_stop, NULL);
+        results->copy_in_times_us[j] = (phase_stop.tv_sec - phase_start.tv_sec) * (1e6) + (phase_stop.tv_usec - phase_start.tv_usec);
+
+        // Execute Forward DFT and capture performance time
+        gettimeofday(&forward_dft_start, NULL); //start clock
+        X(execute)(forward_cos_dft_plan);
+        gettimeofday(&forward_dft_stop, NULL); //stop clock
+        forward_dft_execution_time_us = (forward_dft_stop.tv_sec - forward_dft_start.tv_sec) * (1e6); //sec to us
+        forward_dft_execution_time_us += (forward_dft_stop.tv_usec - forward_dft_start.tv_usec);
+        results->total_f_dft_exec_time_us += forward_dft_execution_time_us;
+        results->fft_performance_times_us[j] = forward_dft_execution_time_us;
+
+        // Execute Backward DFT and capture performance time
+        gettimeofday(&backward_dft_start, NULL); //start clock
+        X(execute)(backward_cos_dft_plan);
+        gettimeofday(&backward_dft_stop, NULL); //stop clock
+        backward_dft_execution_time_us = (backward_dft_stop.tv_sec - backward_dft_start.tv_sec) * (1e6);// sec to us
+        backward_dft_execution_time_us += (backward_dft_stop.tv_usec - backward_dft_start.tv_usec);
+        results->total_b_dft_exec_time_us += backward_dft_execution_time_us;
+        results->ifft_performance_times_us[j] = backward_dft_execution_time_us;
+
+        // Do work on dummy array to prevent the compiler from optimizing on its own
+        rand_idx = rand() % (max_idx + 1);
+        dummy[j] = j + (int)cosine_back[batch_index(&layout, 0, rand_idx)];
+
+        // Fix cosine_back because its height has been adjusted by the FFT
+        gettimeofday(&phase_start, NULL);
+        BENCHMARK(normalize_batch)(cosine_back, n_total, &layout);
+        gettimeofday(&phase_stop, NULL);
+        results->normalize_times_us[j] = (phase_stop.tv_sec - phase_start.tv_sec) * (1e6) + (phase_stop.tv_usec - phase_start.tv_usec);
+
+        if (layout.howmany == 1)
+            continue;
+
+        // Run the same batch as a loop of single transforms. The last round trip is the one checked
+        // below, so the loops are checked along with the batch plan.
+        BENCHMARK(fill_batch)(cosine_original, cosine, n_total, &layout);
+        gettimeofday(&forward_dft_start, NULL);
+        BENCHMARK(execute_loop)(forward_loop_plan, true, cosine_original, cosine_complex, &layout, 1, NULL);
+        gettimeofday(&forward_dft_stop, NULL);
+        gettimeofday(&backward_dft_start, NULL);
+        BENCHMARK(execute_loop)(backward_loop_plan, false, cosine_back, cosine_complex, &layout, 1, NULL);
+        gettimeofday(&backward_dft_stop, NULL);
+        results->total_f_loop_exec_time_us += (forward_dft_stop.tv_sec - forward_dft_start.tv_sec) * (1e6) + (forward_dft_stop.tv_usec - forward_dft_start.tv_usec);
+        results->total_b_loop_exec_time_us += (backward_dft_stop.tv_sec - backward_dft_start.tv_sec) * (1e6) + (backward_dft_stop.tv_usec - backward_dft_start.tv_usec);
+
+        BENCHMARK(fill_batch)(cosine_original, cosine, n_total, &layout);
+        gettimeofday(&forward_dft_start, NULL);
+        BENCHMARK(execute_loop)(forward_parallel_plan, true, cosine_original, cosine_complex, &layout, nthreads, options->work_pool);
+        gettimeofday(&forward_dft_stop, NULL);
+        gettimeofday(&backward_dft_start, NULL);
+        BENCHMARK(execute_loop)(backward_parallel_plan, false, cosine_back, cosine_complex, &layout, nthreads, options->work_pool);
+        gettimeofday(&backward_dft_stop, NULL);
+        results->total_f_parallel_loop_exec_time_us += (forward_dft_stop.tv_sec - forward_dft_start.tv_sec) * (1e6) + (forward_dft_stop.tv_usec - forward_dft_start.tv_usec);
+        results->total_b_parallel_loop_exec_time_us += (backward_dft_stop.tv_sec - backward_dft_start.tv_sec) * (1e6) + (backward_dft_stop.tv_usec - backward_dft_start.tv_usec);
+        BENCHMARK(normalize_batch)(cosine_back, n_total, &layout);
+    }
+
+    // Compare every transform of the (normalized) round trip with the input (as rounded to this
+    // precision). The differences are taken in this precision, so that the error of a quad round
+    // trip isn't lost, and summed in long double.
+    long double squared_error_total = 0.0L, squared_cosine_total = 0.0L, error;
+    long double max_abs_error = 0.0L, max_abs_cosine = 0.0L;
+    R *back;
+    for (b=0; b<layout.howmany; b++){
+        for (k=0; k<n_total; k++){
+            back = &cosine_back[batch_index(&layout, b, k)];
+            error = (long double)(*back - (R)cosine[k]);
+            squared_error_total += error * error;
+            squared_cosine_total += (long double)(R)cosine[k] * (long double)(R)cosine[k];
+            if (fabsl(error) > max_abs_error)
+                max_abs_error = fabsl(error);
+            if (fabsl((long double)(R)cosine[k]) > max_abs_cosine)
+                max_abs_cosine = fabsl((long double)(R)cosine[k]);
+            if (b == 0 && results->cosine_back != NULL)
+                results->cosine_back[k] = (double)*back;
+        }
+    }
+    results->round_trip_error = (squared_cosine_total > 0) ? (double)sqrtl(squared_error_total / squared_cosine_total) : 0.0;
+    results->round_trip_linf_error = (max_abs_cosine > 0) ? (double)(max_abs_error / max_abs_cosine) : 0.0;
+    results->machine_epsilon = (double)R_EPSILON;
+
+    // Check the forward plan against a cosine whose spectrum is known, which catches a broken build
+    // even if its forward and backward errors happen to cancel out in the round trip
+    results->spectrum_error = BENCHMARK(check_spectrum)(forward_cos_dft_plan, cosine_original, cosine_complex, n_total, &layout);
+
+    // Destroy FFTW plans
+    gettimeofday(&phase_start, NULL);
+    X(destroy_plan)(forward_cos_dft_plan);
+    X(destroy_plan)(backward_cos_dft_plan);
+    gettimeofday(&phase_stop, NULL);
+    results->destroy_time_us = (phase_stop.tv_sec - phase_start.tv_sec) * (1e6) + (phase_stop.tv_usec - phase_start.tv_usec);
+    if (layout.howmany > 1){
+        X(destroy_plan)(forward_loop_plan);
+        X(destroy_plan)(backward_loop_plan);
+        X(destroy_plan)(forward_parallel_plan);
+        X(destroy_plan)(backward_parallel_plan);
+    }
+
+    //Now put 'dummy' to use so that the compiler doesn't get rid of it
+    results->dummy = dummy[0];
+
+    // Free memory
+    if (options->in_place == false){
+        X(free)(cosine_original);
+        X(free)(cosine_back);
+    }
+    X(free)(cosine_complex);
+
+    // Run the real-to-real kinds (single, out-of-place transforms) once the r2c arrays are freed
+    for (i=0; i<options->num_r2r_kinds; i++)
+        BENCHMARK(run_r2r)(cosine, rank, n, n_total, nthreads, niters, options, options->r2r_kinds[i], &results->wisdom_cache, &results->r2r[i]);
+
+    // Save the wisdom of any new plans for the next run
+    wisdom_cache_close(&results->wisdom_cache);
+
+    // Handle threading
+    BENCHMARK(threads_backend).cleanup_threads();
+    threads_backend_close(&BENCHMARK(threads_backend));
+}
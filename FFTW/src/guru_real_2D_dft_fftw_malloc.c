@@ -13,6 +13,8 @@
 #include <stdbool.h>
 #include <string.h>
 #include <unistd.h>
+#include "wisdom_cache.h"
+#include "threads_backend.h"
 
 #define BUFFSIZE 4096
 #define ALIGNMENT 16   //for aligned allocation --> set to page size, NOT number of bytes in AVX* instructions
@@ -21,6 +23,7 @@
 #define D0 3             //standard deviation for blurring --> https://en.wikipedia.org/wiki/Gaussian_blur
 #define FILTER_SIZE 16   //gaussian blur filter size
 #define TIMELIMIT 2      //this tells FFTW to spend no more than X seconds on finding an "acceptable" algorithm
+#define DEFAULT_THREADS_BACKEND "pthreads" //FFTW's threads backend, "pthreads", "openmp" or "work-stealing"
 //#define DEBUG            //to print out debug statements
 //#define SAVEIMAGE        //to save the resulting blured image (this is optional)
 #define IMAGE "test_images/cat.jpeg" //image to blur
@@ -63,12 +66,104 @@ int nextPowerOfTwo(int n){
     return 1 << count;
 }
 
+fftw_plan plan_r2c_2d(WisdomCache *cache, const char *threads_backend, int nthreads, int height, int width, double *in, fftw_complex *out){
+    /*
+     * This function creates a forward (real to complex) plan. If a wisdom cache is passed, the plan
+     * is first looked up in the wisdom alone, and the hit or miss is recorded in the cache. Plans
+     * of a threads backend other than the default one are recorded under their own problem.
+     */
+    struct timeval plan_start, plan_stop;
+    char problem[MAX_PROBLEM_LEN];
+    fftw_plan plan = NULL;
+
+    if (cache == NULL)
+        return fftw_plan_dft_r2c_2d(height, width, in, out, FFTW_ESTIMATE);
+
+    gettimeofday(&plan_start, NULL);
+    plan = fftw_plan_dft_r2c_2d(height, width, in, out, FFTW_ESTIMATE | FFTW_WISDOM_ONLY);
+    bool hit = (plan != NULL);
+    if (hit == false)
+        plan = fftw_plan_dft_r2c_2d(height, width, in, out, FFTW_ESTIMATE);
+    gettimeofday(&plan_stop, NULL);
+
+    snprintf(problem, MAX_PROBLEM_LEN, "r2c rank=2 dims=%dx%d threads=%d rigor=estimate%s%s", height, width, nthreads,
+             (strcmp(threads_backend, DEFAULT_THREADS_BACKEND) != 0) ? " backend=" : "",
+             (strcmp(threads_backend, DEFAULT_THREADS_BACKEND) != 0) ? threads_backend : "");
+    wisdom_cache_record_plan(cache, problem, hit, (plan_stop.tv_sec - plan_start.tv_sec) + (plan_stop.tv_usec - plan_start.tv_usec) * (1.0e-6));
+    return plan;
+}
+
+fftw_plan plan_c2r_2d(WisdomCache *cache, const char *threads_backend, int nthreads, int height, int width, fftw_complex *in, double *out){
+    /*
+     * This function creates a backward (complex to real) plan. See plan_r2c_2d.
+     */
+    struct timeval plan_start, plan_stop;
+    char problem[MAX_PROBLEM_LEN];
+    fftw_plan plan = NULL;
+
+    if (cache == NULL)
+        return fftw_plan_dft_c2r_2d(height, width, in, out, FFTW_ESTIMATE);
+
+    gettimeofday(&plan_start, NULL);
+    plan = fftw_plan_dft_c2r_2d(height, width, in, out, FFTW_ESTIMATE | FFTW_WISDOM_ONLY);
+    bool hit = (plan != NULL);
+    if (hit == false)
+        plan = fftw_plan_dft_c2r_2d(height, width, in, out, FFTW_ESTIMATE);
+    gettimeofday(&plan_stop, NULL);
+
+    snprintf(problem, MAX_PROBLEM_LEN, "c2r rank=2 dims=%dx%d threads=%d rigor=estimate%s%s", height, width, nthreads,
+             (strcmp(threads_backend, DEFAULT_THREADS_BACKEND) != 0) ? " backend=" : "",
+             (strcmp(threads_backend, DEFAULT_THREADS_BACKEND) != 0) ? threads_backend : "");
+    wisdom_cache_record_plan(cache, problem, hit, (plan_stop.tv_sec - plan_start.tv_sec) + (plan_stop.tv_usec - plan_start.tv_usec) * (1.0e-6));
+    return plan;
+}
+
+double plan_flops(const fftw_plan plan){
+    /*
+     * This function counts the floating point operations of one execution of a plan, as FFTW does:
+     * a fused multiply-add counts as two
+     */
+    double add, mul, fmas;
+
+    fftw_flops(plan, &add, &mul, &fmas);
+    return add + mul + 2 * fmas;
+}
+
 int main(int argc, char* argv[]){
 
+    // Parse (and remove) the optional "--wisdom-dir <dir>", "--threads-backend <pthreads|openmp>"
+    // and "--busy-openmp <threads>" flags so that only the positional arguments are left
+    char *wisdom_dir = NULL;
+    char *threads_backend_name = DEFAULT_THREADS_BACKEND;
+    int busy_openmp_threads = 0;
+    char *pEnd;
+    int num_args = 1;
+    for (int arg=1; arg<argc; arg++){
+        if ((strcmp(argv[arg], "--wisdom-dir") == 0 || strcmp(argv[arg], "--threads-backend") == 0 || strcmp(argv[arg], "--busy-openmp") == 0) &&
+            arg + 1 >= argc){
+            printf("%s requires a value.\n", argv[arg]);
+            exit(0);
+        }
+
+        if (strcmp(argv[arg], "--wisdom-dir") == 0)
+            wisdom_dir = argv[++arg];
+        else if (strcmp(argv[arg], "--threads-backend") == 0)
+            threads_backend_name = argv[++arg];
+        else if (strcmp(argv[arg], "--busy-openmp") == 0){
+            busy_openmp_threads = (int)strtol(argv[++arg], &pEnd, 10);
+            if (*pEnd != '\0' || strtol(argv[arg], NULL, 10) < 1){
+                printf("Invalid value '%s' for --busy-openmp. Please enter a whole number greater than or equal to 1.\n", argv[arg]);
+                exit(0);
+            }
+        }
+        else
+            argv[num_args++] = argv[arg];
+    }
+    argc = num_args;
+
     // Get num threads and num iterations
     int nthreads, niters;
     char *filename;
-    char *pEnd;
     if (argc == 1){
         printf("Please enter number of threads to use and number of iterations to execute.\n");
         exit(0);
@@ -163,9 +258,9 @@ int main(int argc, char* argv[]){
     size_t output_matrix_size_in_bytes = sizeof(fftw_complex) * output_matrix_size;
 
     // These arrays will store our RGB colors and we use aligned_alloc to ensure AVX2 instructions run optimally
-    double *red   = aligned_alloc(ALIGNMENT, input_matrix_size);
-    double *green = aligned_alloc(ALIGNMENT, input_matrix_size);
-    double *blue  = aligned_alloc(ALIGNMENT, input_matrix_size);
+    double *red   = aligned_alloc(ALIGNMENT, input_matrix_size_in_bytes);
+    double *green = aligned_alloc(ALIGNMENT, input_matrix_size_in_bytes);
+    double *blue  = aligned_alloc(ALIGNMENT, input_matrix_size_in_bytes);
 #ifdef DEBUG
         printf("<< PROCESSING IMAGE PIXELS >>\n");
 #endif
@@ -249,7 +344,7 @@ int main(int argc, char* argv[]){
     }
 
     // Pad filter
-    double *padded_filter = malloc(input_matrix_size);
+    double *padded_filter = malloc(input_matrix_size_in_bytes);
 
     double value = -1;
     int xf_idx = 0, yf_idx = 0;
@@ -308,9 +403,22 @@ int main(int argc, char* argv[]){
 #ifdef DEBUG
         printf("<< PREPARE THREADING >>\n");
 #endif
-    // Set threading
-    fftw_init_threads();
-    fftw_plan_with_nthreads(nthreads);
+    // Set threading, with the threads backend's library loaded at runtime (see threads_backend.h)
+    // The work-stealing backend runs FFTW's parallel loops on a persistent pool (see work_pool.h)
+    WorkPool *work_pool = NULL;
+    if (strcmp(threads_backend_name, "work-stealing") == 0 && (work_pool = work_pool_create(nthreads)) == NULL)
+        exit(0);
+    ThreadsBackend threads_backend;
+    if (threads_backend_open(&threads_backend, threads_backend_name, "fftw3", "fftw", work_pool) != 0)
+        exit(0);
+    if (threads_backend_init(&threads_backend) != 0)
+        exit(0);
+    threads_backend.plan_with_nthreads(nthreads);
+
+    // Import the wisdom saved for this host (if any). This must come after FFTW's threads are set up.
+    WisdomCache wisdom_cache;
+    if (wisdom_cache_open(&wisdom_cache, wisdom_dir, &WISDOM_DOUBLE) != 0)
+        exit(0);
 #ifdef DEBUG
         printf("  FFTW is set to use %d threads.\n\n", nthreads);
         printf("<< CREATING PLANS >>\n");
@@ -446,6 +554,11 @@ int main(int argc, char* argv[]){
     double r_imaginary, g_imaginary, b_imaginary, filter_imaginary;
 
     // Capture wall time
+    // Keep an OpenMP team busy alongside the blurs, like the OpenMP runtime of a co-located workload
+    BusyPool busy_pool;
+    if (busy_pool_start(&busy_pool, busy_openmp_threads) != 0)
+        exit(0);
+
     gettimeofday(&wall_time_start, NULL); //start clock
 
     // This loop executes 'niters' times to represent a total of 'niters' images
@@ -457,11 +570,13 @@ int main(int argc, char* argv[]){
         if (k == 0)
             printf("\n<< BLURRING IMAGES >>\n");
 #endif
-        // Define plans
-        r_plan = fftw_plan_dft_r2c_2d(adjusted_height, adjusted_width, image_r_in, image_r_out, FFTW_ESTIMATE);
-        g_plan = fftw_plan_dft_r2c_2d(adjusted_height, adjusted_width, image_g_in, image_g_out, FFTW_ESTIMATE);
-        b_plan = fftw_plan_dft_r2c_2d(adjusted_height, adjusted_width, image_b_in, image_b_out, FFTW_ESTIMATE);
-        filter_plan = fftw_plan_dft_r2c_2d(adjusted_height, adjusted_width, filter_in, filter_out, FFTW_ESTIMATE);
+        // Define plans. Only the plans for the first image are checked against the wisdom cache,
+        // since FFTW keeps the wisdom of those plans in memory for the remaining images.
+        WisdomCache *cache = (k == 0 && wisdom_cache.enabled) ? &wisdom_cache : NULL;
+        r_plan = plan_r2c_2d(cache, threads_backend.name, nthreads, adjusted_height, adjusted_width, image_r_in, image_r_out);
+        g_plan = plan_r2c_2d(cache, threads_backend.name, nthreads, adjusted_height, adjusted_width, image_g_in, image_g_out);
+        b_plan = plan_r2c_2d(cache, threads_backend.name, nthreads, adjusted_height, adjusted_width, image_b_in, image_b_out);
+        filter_plan = plan_r2c_2d(cache, threads_backend.name, nthreads, adjusted_height, adjusted_width, filter_in, filter_out);
 #ifdef DEBUG
         printf("  Plans set #%d of %d successfully populated.\n", k+1, niters);
 #endif
@@ -495,9 +610,9 @@ int main(int argc, char* argv[]){
 #endif
         
         // Now let's bring the complex values back to the time domain values
-        r_complex_plan = fftw_plan_dft_c2r_2d(adjusted_height, adjusted_width, convolved_r_in, convolved_r_out, FFTW_ESTIMATE);
-        g_complex_plan = fftw_plan_dft_c2r_2d(adjusted_height, adjusted_width, convolved_g_in, convolved_g_out, FFTW_ESTIMATE);
-        b_complex_plan = fftw_plan_dft_c2r_2d(adjusted_height, adjusted_width, convolved_b_in, convolved_b_out, FFTW_ESTIMATE);
+        r_complex_plan = plan_c2r_2d(cache, threads_backend.name, nthreads, adjusted_height, adjusted_width, convolved_r_in, convolved_r_out);
+        g_complex_plan = plan_c2r_2d(cache, threads_backend.name, nthreads, adjusted_height, adjusted_width, convolved_g_in, convolved_g_out);
+        b_complex_plan = plan_c2r_2d(cache, threads_backend.name, nthreads, adjusted_height, adjusted_width, convolved_b_in, convolved_b_out);
 
         // Apply gaussian blur + start blur clock
         gettimeofday(&blur_start, NULL); //start clock
@@ -582,17 +697,21 @@ int main(int argc, char* argv[]){
         }
     // Stop clock
     gettimeofday(&wall_time_stop, NULL); //stop clock
+    busy_pool_stop(&busy_pool);
 
     // Compute execution time
     wall_time = (wall_time_stop.tv_sec - wall_time_start.tv_sec) * 1000.0;// sec to ms
     wall_time += (wall_time_stop.tv_usec - wall_time_start.tv_usec)/ 1000.0;// us to ms
     wall_time *= (1.0e-3);
 
-    // Handle threading
-    fftw_cleanup_threads();
+    // Save the wisdom of any new plans for the next run
+    wisdom_cache_close(&wisdom_cache);
 
+    // Count the operations of the plans of one image (three color channels each way)
+    double fft_flops = plan_flops(r_plan) + plan_flops(g_plan) + plan_flops(b_plan);
+    double ifft_flops = plan_flops(r_complex_plan) + plan_flops(g_complex_plan) + plan_flops(b_complex_plan);
 
-    // Destroy the plan
+    // Destroy the plan (before the threads are cleaned up, since threaded plans run in the backend's library)
     fftw_destroy_plan(r_plan);
     fftw_destroy_plan(g_plan);
     fftw_destroy_plan(b_plan);
@@ -601,9 +720,20 @@ int main(int argc, char* argv[]){
     fftw_destroy_plan(g_complex_plan);
     fftw_destroy_plan(b_complex_plan);
 
-    // Compute gigaflops
-    long double fft_gflops_approx = niters / total_fft_execution_time;
-    long double ifft_gflops_approx = niters / total_ifft_execution_time;
+    // Handle threading
+    threads_backend.cleanup_threads();
+    threads_backend_close(&threads_backend);
+
+    // Compute gigaflops from the operations the plans actually perform (fftw_flops). FFTW's own
+    // convention, 2.5 N log2(N) flops for a real transform of N pixels (http://www.fftw.org/speed/method.html),
+    // is a scaled inverse time rather than a count, and is saved separately as "FFTW mflops".
+    double num_pixels = (double)adjusted_height * adjusted_width;
+    long double fft_gflops = niters * fft_flops / total_fft_execution_time * (1.0e-9);
+    long double ifft_gflops = niters * ifft_flops / total_ifft_execution_time * (1.0e-9);
+    long double fft_fftw_mflops = niters * 3 * 2.5 * num_pixels * log2(num_pixels) / total_fft_execution_time * (1.0e-6);
+    long double ifft_fftw_mflops = niters * 3 * 2.5 * num_pixels * log2(num_pixels) / total_ifft_execution_time * (1.0e-6);
+    double fft_images_per_sec = niters / total_fft_execution_time;
+    double ifft_images_per_sec = niters / total_ifft_execution_time;
 
     // Get average wall times
     double average_wall_time = wall_time / (double)niters;
@@ -687,21 +817,50 @@ int main(int argc, char* argv[]){
     fprintf(tmp_file, "            \"inputs\": {\n");
     fprintf(tmp_file, "                \"num_images\": %d,\n", niters);
     fprintf(tmp_file, "                \"image_dims\": [%d, %d],\n", width, height);
-    fprintf(tmp_file, "                \"threads\": %d\n", nthreads);
+    fprintf(tmp_file, "                \"threads\": %d,\n", nthreads);
+    fprintf(tmp_file, "                \"threads_backend\": \"%s\",\n", threads_backend.name);
+    fprintf(tmp_file, "                \"busy_openmp_threads\": %d\n", busy_openmp_threads);
     fprintf(tmp_file, "            },\n");
     fprintf(tmp_file, "            \"forward_dft_results\": {\n");
     fprintf(tmp_file, "                \"total_execution_time_seconds\": %0.5f,\n", total_fft_execution_time);
-    fprintf(tmp_file, "                \"average_gflops\": %0.5Lf\n", fft_gflops_approx);
+    fprintf(tmp_file, "                \"average_gflops\": %0.5Lf,\n", fft_gflops);
+    fprintf(tmp_file, "                \"flops_per_image\": %0.0f,\n", fft_flops);
+    fprintf(tmp_file, "                \"fftw_mflops\": %0.3Lf,\n", fft_fftw_mflops);
+    fprintf(tmp_file, "                \"images_per_second\": %0.3f\n", fft_images_per_sec);
     fprintf(tmp_file, "            },\n");
     fprintf(tmp_file, "            \"backward_dft_results\": {\n");
     fprintf(tmp_file, "                \"total_execution_time_seconds\": %0.5f,\n", total_ifft_execution_time);
-    fprintf(tmp_file, "                \"average_gflops\": %0.5Lf\n", ifft_gflops_approx);
+    fprintf(tmp_file, "                \"average_gflops\": %0.5Lf,\n", ifft_gflops);
+    fprintf(tmp_file, "                \"flops_per_image\": %0.0f,\n", ifft_flops);
+    fprintf(tmp_file, "                \"fftw_mflops\": %0.3Lf,\n", ifft_fftw_mflops);
+    fprintf(tmp_file, "                \"images_per_second\": %0.3f\n", ifft_images_per_sec);
     fprintf(tmp_file, "            },\n");
     fprintf(tmp_file, "            \"misc\": {\n");
     fprintf(tmp_file, "                \"overall_setup_time_seconds\": %0.5f,\n", overall_setup_time);
     fprintf(tmp_file, "                \"blur_time_seconds\": %0.5f,\n", total_blur_execution_time);
     fprintf(tmp_file, "                \"wall_time_without_blur_seconds\": %0.5f,\n", wall_time - total_blur_execution_time);
     fprintf(tmp_file, "                \"wall_time_seconds\": %0.5f\n", wall_time);
+    if (busy_pool.nthreads > 0){
+        fprintf(tmp_file, "            },\n");
+        fprintf(tmp_file, "            \"busy_openmp\": {\n");
+        fprintf(tmp_file, "                \"threads\": %d,\n", busy_pool.nthreads);
+        fprintf(tmp_file, "                \"gflops\": %0.5f\n", busy_pool.gflops);
+    }
+    if (work_pool != NULL){
+        fprintf(tmp_file, "            },\n");
+        fprintf(tmp_file, "            \"work_pool\": {\n");
+        fprintf(tmp_file, "                \"threads\": %d,\n", work_pool->nthreads);
+        fprintf(tmp_file, "                \"jobs\": %ld,\n", atomic_load(&work_pool->num_jobs));
+        fprintf(tmp_file, "                \"steals\": %ld\n", atomic_load(&work_pool->num_steals));
+    }
+    if (wisdom_cache.enabled){
+        fprintf(tmp_file, "            },\n");
+        fprintf(tmp_file, "            \"wisdom\": {\n");
+        fprintf(tmp_file, "                \"fingerprint\": \"%s\",\n", wisdom_cache.fingerprint);
+        fprintf(tmp_file, "                \"hits\": %d,\n", wisdom_cache.num_hits);
+        fprintf(tmp_file, "                \"misses\": %d,\n", wisdom_cache.num_misses);
+        fprintf(tmp_file, "                \"plan_time_saved_seconds\": %0.6f\n", wisdom_cache.plan_time_saved_sec);
+    }
     fprintf(tmp_file, "            }\n");
     fprintf(tmp_file, "        }\n");
     fprintf(tmp_file, "    }\n");
@@ -718,12 +877,14 @@ int main(int argc, char* argv[]){
     printf("===================\n");
     printf("Operations:\n");
     printf("    %d images of size %dx%d analyzed\n", niters, width, height);
-    printf("    %d threads used\n", nthreads);
+    printf("    %d threads used (%s backend)\n", nthreads, threads_backend.name);
     printf("FFT Performance Results\n");
-    printf("    %0.3Lf FFT performance GFlops\n", fft_gflops_approx);
+    printf("    %0.3Lf FFT performance GFlops (FFTW mflops: %0.1Lf)\n", fft_gflops, fft_fftw_mflops);
+    printf("    %0.3f images/sec\n", fft_images_per_sec);
     printf("    %0.3f sec FFT execution time\n", total_fft_execution_time * (1.0));
     printf("Inverse FFT Performance Results\n");
-    printf("    %0.3Lf IFFT performance GFlops\n", ifft_gflops_approx);
+    printf("    %0.3Lf IFFT performance GFlops (FFTW mflops: %0.1Lf)\n", ifft_gflops, ifft_fftw_mflops);
+    printf("    %0.3f images/sec\n", ifft_images_per_sec);
     printf("    %0.3f sec IFFT execution time\n", total_ifft_execution_time * (1.0));
     printf("FFT + IFFT Setup time\n");
     printf("    Took %0.3f sec to setup %d images\n", overall_setup_time, niters);
@@ -737,6 +898,21 @@ int main(int argc, char* argv[]){
     printf("Wall time (excluding blur time)\n");
     printf("    Took %0.3f sec to blur %d images (only FFTW computations)\n", wall_time - total_blur_execution_time, niters);
     printf("    Took %0.3f sec to blur single image (only FFTW computations)\n\n", average_wall_time_excluding_blur);
+    if (busy_pool.nthreads > 0){
+        printf("Busy OpenMP pool\n");
+        printf("    %d threads, %0.3f GFlops while the images were blurred\n\n", busy_pool.nthreads, busy_pool.gflops);
+    }
+    if (work_pool != NULL){
+        printf("Work-stealing pool\n");
+        printf("    %d threads, %ld jobs, %ld stolen\n\n", work_pool->nthreads, atomic_load(&work_pool->num_jobs),
+               atomic_load(&work_pool->num_steals));
+    }
+    if (wisdom_cache.enabled){
+        printf("Wisdom cache\n");
+        printf("    Fingerprint: %s\n", wisdom_cache.fingerprint);
+        printf("    %d hits, %d misses\n", wisdom_cache.num_hits, wisdom_cache.num_misses);
+        printf("    Saved %0.6f sec of planning\n\n", wisdom_cache.plan_time_saved_sec);
+    }
 
 #ifdef SAVEIMAGE
     // For savingt the image, we will need to create a few 'wands'
@@ -794,5 +970,6 @@ int main(int argc, char* argv[]){
     MagickWandTerminus();
 #endif
 
+    work_pool_destroy(work_pool);
     return 0;
 }
@@ -14,14 +14,41 @@
 #define STDEV_GFLOPS_KEY "stdev_gflops"
 #define BWD_DFT_RESULTS_KEY "backward_dft_results"
 #define AVG_EXEC_TIME_SECONDS_KEY "average_execution_time_seconds"
+#define DEFAULT_RIGOR "estimate"
+#define DEFAULT_PRECISION "double"
+#define DEFAULT_THREADS_BACKEND "pthreads" //FFTW2's threads are always POSIX threads
+#define DEFAULT_ACCURACY_TOLERANCE 64
+#define MAX_PROBLEM_DESCRIPTION_LEN 256
+#define MAX_RANK 100
+#define NUM_R2R_KINDS 8
+#define NUM_TONES 8             //tones of the multitone signal
+#define NUM_SPARSE_TONES 4      //tones of the sparse signal
+#define TONE_TABLE_LEN 1024     //samples of each tone's table (see fill_segment)
+#define IMPULSE_PERIOD 64       //samples between the impulses of the impulses signal
+#define SIGNAL_SEED 0x5eed5eedULL //seed of the random signals, fixed so that every run gets the same data
+#define DEFAULT_SIGNAL "cosine"
+#define INPUT_CACHE_MAGIC "FFTWINPT"
+#define INPUT_CACHE_VERSION 1   //bump whenever generate_signal_data changes what it generates
+#define INPUT_CACHE_BYTE_ORDER 0x01020304
+#define INPUT_CACHE_DATA_OFFSET 4096 //the samples start on a page boundary
+#define MAX_INPUT_CACHE_PATH_LEN 1024
+#define CLIFF_WINDOW 4          //sweep sizes on each side that a size is compared with
+#define CLIFF_FRACTION 0.5      //a size is a cliff if its FFTW mflops are below this fraction of its neighbors' median
+#define INPUT_PATH(key) PERFORMANCE_KEY "." INPUTS_KEY "." key
+#define DFT_RESULT_PATH(results_key, key) PERFORMANCE_KEY "." results_key "." key
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
 #include <sys/time.h>
+#include <sys/resource.h>
 #include <math.h>
+#include <float.h>
 #ifdef FFTW3
 #include <fftw3.h>
+#ifdef FFTW3_QUAD
+#include <quadmath.h>
+#endif
 #else
 #include <fftw.h>
 #include <fftw_threads.h>
@@ -35,16 +62,392 @@
 #include <unistd.h>
 #include <regex.h>
 #include <ctype.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#include "results_json.h"
+#ifdef FFTW3
+#include "wisdom_cache.h"
+#include "threads_backend.h"
+#include "work_pool.h"
+#else
+typedef struct WorkPool WorkPool; //FFTW2 builds have no work pool, so it's always NULL
+#endif
 
-void generate_cosine_data(double *cosine, double fs, int rank, int *n, int matrix_size);
-void fill_row(double *cosine, double fs, int row_length, int start_idx, int n_sum, int matrix_size);
+typedef struct {
+    const char *name;           //FFTW name of the kind, e.g. "REDFT10" (a DCT-II)
+    int kind;                   //e.g. FFTW_REDFT10
+    const char *inverse_name;   //kind whose transform undoes this one (up to scaling), e.g. "REDFT01"
+    int inverse;
+    int logical_offset;         //each dimension is a DFT of logical size 2 x (n + logical_offset)
+} R2RKind;
+
+typedef enum {
+    SIGNAL_COSINE,      //cos(pi x fs x i) over the flat index i
+    SIGNAL_MULTITONE,   //sum of NUM_TONES tones between DFT bins, of decreasing amplitude
+    SIGNAL_SPARSE,      //sum of NUM_SPARSE_TONES tones on DFT bins
+    SIGNAL_CHIRP,       //linear chirp along the last dimension
+    SIGNAL_NOISE,       //uniform white noise
+    SIGNAL_IMPULSES     //impulse train
+} SignalKind;
+
+typedef struct {
+    const char *name;           //e.g. "chirp"
+    SignalKind kind;
+} Signal;
+
+typedef struct {
+    double amplitude;
+    double phase;               //in cycles
+    double freq[MAX_RANK];      //cycles over each dimension (whole numbers fall on a DFT bin)
+    double cos_table[TONE_TABLE_LEN]; //cos and sin of 2 pi x freq[rank-1] x p / n[rank-1]
+    double sin_table[TONE_TABLE_LEN];
+} Tone;
+
+typedef struct {
+    const Signal *signal;
+    int rank;
+    int *n;
+    int row_length;             //n[rank-1]
+    Tone *tones;                //tones of the cosine, multitone and sparse signals
+    int num_tones;
+} SignalGenerator;
+
+typedef struct {
+    const SignalGenerator *generator;
+    double *data;
+    size_t start;               //first sample (flat index) of the thread's slice
+    size_t end;
+} SignalSlice;
+
+typedef struct {
+    char magic[8];              //INPUT_CACHE_MAGIC
+    uint32_t version;           //INPUT_CACHE_VERSION
+    uint32_t byte_order;        //INPUT_CACHE_BYTE_ORDER as written by the host that generated the file
+    int32_t rank;
+    int32_t dims[MAX_RANK];
+    double fs;
+    char signal[32];
+    uint64_t num_samples;
+    uint64_t checksum;          //of the samples (see input_checksum). Must be the last field.
+} InputCacheHeader;
+
+typedef struct {
+    double *data;               //the samples
+    void *mapping;              //the mapped cache file (NULL if the samples were generated)
+    size_t mapping_size;
+    char cache_path[MAX_INPUT_CACHE_PATH_LEN];
+    bool cache_hit;
+    double setup_time_sec;      //time it took to map or generate (and save) the samples
+} InputData;
+
+typedef struct {
+    const R2RKind *kind;
+    double forward_plan_time_us;
+    double backward_plan_time_us;
+    double total_f_exec_time_us;
+    double total_b_exec_time_us;
+    double forward_flops;               //floating point operations of one execution of each plan
+    double backward_flops;
+    double round_trip_error;            //relative L2 error of the forward + inverse kind round trip
+} R2RBenchmarkResults;
+
+typedef struct {
+    char *rigor;            //name of the FFTW planner rigor
+    unsigned plan_flags;
+    double plan_timelimit;  //seconds FFTW may spend on each plan (negative for no limit)
+    char *wisdom_dir;       //directory of the wisdom cache (NULL to plan from scratch)
+    char *threads_backend;  //FFTW's threads backend, "pthreads", "openmp" or "work-stealing" (see threads_backend.h)
+    WorkPool *work_pool;    //pool the work-stealing backend runs every parallel stage on (NULL for the other backends)
+    int busy_openmp_threads; //threads of a busy OpenMP pool running alongside the DFTs (0 for none)
+    char *precision;        //name of the precision to run the DFTs in (see PRECISIONS)
+    char *signal;           //name of the signal to transform (see SIGNALS)
+    char *input_cache_dir;  //directory of the input cache (NULL to generate the input every run)
+    bool in_place;          //transform in place, in FFTW's padded real layout
+    int batch;              //number of transforms per execute (1 for a single transform)
+    int batch_stride;       //distance between consecutive elements of a transform
+    int batch_dist;         //distance between the first elements of consecutive transforms (0 for contiguous)
+    int embed[MAX_RANK];    //dimensions of the array each transform is a window of (see --embed)
+    int num_embed;          //0 if each transform is a whole array
+    bool transpose;         //store the dimensions of each transform in reverse order
+    const R2RKind *r2r_kinds[NUM_R2R_KINDS]; //real-to-real kinds to run after the r2c DFT
+    int num_r2r_kinds;
+    char *sweep;            //sizes of the last dimension to sweep, "<min>-<max>" or "smooth:<max>" (NULL for no sweep)
+    char *production_sizes; //comma separated sizes to recommend padded sizes for in a sweep
+    double accuracy_tolerance; //allowed error, in machine epsilons x log2(n_total)
+} BenchmarkOptions;
+
+typedef struct {
+    int howmany;            //number of transforms
+    ptrdiff_t real_stride;  //distance between consecutive elements of a transform, in reals
+    ptrdiff_t real_dist;    //distance between consecutive transforms, in reals
+    ptrdiff_t complex_stride; //same as above for the complex array, in complex values
+    ptrdiff_t complex_dist;
+    int row_length;         //n[rank-1]
+    int real_row_length;    //n[rank-1], or 2 x (n[rank-1]/2 + 1) reals when padded in place
+    int rank;
+    int *n;                 //dimensions of each transform
+    int real_embed[MAX_RANK]; //dimensions of the real array each transform is a window of
+    bool transposed;        //the real array stores the dimensions in reverse order
+    bool whole;             //each transform is a whole row-major array (without --embed or --transpose)
+    bool strided;           //the samples of a transform are not consecutive in the real array
+    ptrdiff_t real_strides[MAX_RANK];    //stride of each dimension of a transform in the real array
+    ptrdiff_t complex_strides[MAX_RANK]; //same for the complex array, whose last dimension is n[rank-1]/2 + 1
+    size_t real_size;       //number of reals in each real array
+    size_t complex_size;    //number of complex values in the complex array
+} BatchLayout;
+
+typedef struct {
+    double forward_plan_time_us;        //plan creation times in us
+    double backward_plan_time_us;
+    double *fft_performance_times_us;   //forward DFT execution time of each iteration in us
+    double *ifft_performance_times_us;  //backward DFT execution time of each iteration in us
+    double total_f_dft_exec_time_us;    //total forward DFT in us
+    double total_b_dft_exec_time_us;    //total backward DFT in us
+    double forward_flops;               //floating point operations of one execute of each plan, from fftw_flops (0 with FFTW2)
+    double backward_flops;
+    double *copy_in_times_us;           //time of filling the input array in each iteration in us
+    double *normalize_times_us;         //time of normalizing the round trip in each iteration in us
+    double destroy_time_us;             //time of destroying the plans in us
+    double *cosine_back;                //the cosine after the forward and backward DFTs, normalized (NULL to skip)
+    double round_trip_error;            //relative L2 error of 'cosine_back'
+    double round_trip_linf_error;       //largest error of 'cosine_back', relative to the largest sample
+    double spectrum_error;              //largest error of the forward DFT of a pure tone, relative to its peak
+    double machine_epsilon;             //of the precision the DFTs ran in
+    size_t dft_buffer_bytes;            //size of the arrays the DFTs read and write
+    double total_f_loop_exec_time_us;   //total time of the batch as a loop of single forward DFTs in us
+    double total_b_loop_exec_time_us;
+    double total_f_parallel_loop_exec_time_us; //same, with the loop split across threads
+    double total_b_parallel_loop_exec_time_us;
+    double total_f_contiguous_exec_time_us; //total time of a strided batch from contiguous arrays in us
+    double total_b_contiguous_exec_time_us;
+    double total_copy_in_time_us;       //total time of copying a strided batch to contiguous arrays in us
+    double total_copy_out_time_us;      //and of copying the result back
+    R2RBenchmarkResults r2r[NUM_R2R_KINDS];  //results of each of options->r2r_kinds
+    int dummy;
+#ifdef FFTW3
+    WisdomCache wisdom_cache;
+#endif
+} DFTBenchmarkResults;
+
+// Phases of a run, which are timed separately. The plans are created and destroyed once per run,
+// and the other phases run once per iteration.
+typedef enum {
+    PHASE_PLAN,
+    PHASE_COPY_IN,
+    PHASE_FORWARD,
+    PHASE_BACKWARD,
+    PHASE_NORMALIZE,
+    PHASE_DESTROY,
+    NUM_PHASES
+} Phase;
+
+typedef struct {
+    const char *name;       //e.g. "copy_in"
+    int runs;               //1 for the plans and their destruction, the number of iterations otherwise
+    double total_us;
+    double mean_us;
+    double min_us;
+    double max_us;
+    double stdev_us;
+} PhaseStats;
+
+typedef void (*DFTBenchmark)(const double *cosine, int rank, int *n, ptrdiff_t n_total, int nthreads, int niters, BenchmarkOptions *options, DFTBenchmarkResults *results);
+
+typedef struct {
+    char *name;
+    DFTBenchmark run_dft;
+} Precision;
+
+int parse_options(int argc, char *argv[], BenchmarkOptions *options);
+void parse_r2r_kinds(char *kind_list, BenchmarkOptions *options);
+const Precision *find_precision(const char *name);
+void describe_problem(char *problem, const char *kind, int rank, int *n, int nthreads, BenchmarkOptions *options);
+ptrdiff_t complex_size(int rank, int *n, ptrdiff_t n_total);
+void phase_stats(PhaseStats *stats, const char *name, const double *times_us, int runs);
+void batch_layout(int rank, int *n, ptrdiff_t n_total, BenchmarkOptions *options, BatchLayout *layout);
+const Signal *find_signal(const char *name);
+void init_tones(SignalGenerator *generator, double fs);
+void fill_segment(const SignalGenerator *generator, double *data, ptrdiff_t row, int start, int end);
+void *fill_slice(void *args);
+void generate_signal_data(double *data, double fs, int rank, int *n, ptrdiff_t n_total, const Signal *signal, int nthreads, WorkPool *pool);
+void input_cache_path(char *path, size_t size, const char *cache_dir, double fs, int rank, int *n, const char *signal);
+uint64_t input_checksum(const double *data, size_t num_samples);
+void init_input_cache_header(InputCacheHeader *header, double fs, int rank, int *n, ptrdiff_t n_total, const char *signal);
+bool map_input_cache(InputData *input, const InputCacheHeader *expected);
+int save_input_cache(InputData *input, InputCacheHeader *header);
+void load_input_data(InputData *input, double fs, int rank, int *n, ptrdiff_t n_total, BenchmarkOptions *options, int nthreads);
+void free_input_data(InputData *input);
 void plot1D(double *cosine, int dim, int rank, int *n, double fs, char *title);
+int sweep_sizes(BenchmarkOptions *options, int **sizes);
+void run_sweep(char *filename, bool plot, double fs, int nthreads, int niters, int rank, int *n, BenchmarkOptions *options);
 int verifyCosineJSONFile(char *fftw_json_filename);
+int __check_cosine_record(JsonRecord *record, void *validator_args);
+int __compare_ints(const void *a, const void *b);
+int __parse_sizes(char *size_list, int *sizes, int num_sizes);
+
+#ifdef FFTW3
+// Real-to-real kinds (see "Real-to-Real Transform Kinds" in the FFTW manual). REDFT00 and RODFT00
+// correspond to DFTs of size 2(n-1) and 2(n+1), the rest to DFTs of size 2n.
+static const R2RKind R2R_KINDS[NUM_R2R_KINDS] = {
+    {"REDFT00", FFTW_REDFT00, "REDFT00", FFTW_REDFT00, -1},
+    {"REDFT10", FFTW_REDFT10, "REDFT01", FFTW_REDFT01, 0},
+    {"REDFT01", FFTW_REDFT01, "REDFT10", FFTW_REDFT10, 0},
+    {"REDFT11", FFTW_REDFT11, "REDFT11", FFTW_REDFT11, 0},
+    {"RODFT00", FFTW_RODFT00, "RODFT00", FFTW_RODFT00, 1},
+    {"RODFT10", FFTW_RODFT10, "RODFT01", FFTW_RODFT01, 0},
+    {"RODFT01", FFTW_RODFT01, "RODFT10", FFTW_RODFT10, 0},
+    {"RODFT11", FFTW_RODFT11, "RODFT11", FFTW_RODFT11, 0},
+};
+#endif
+
+static const Signal SIGNALS[] = {
+    {"cosine", SIGNAL_COSINE},
+    {"multitone", SIGNAL_MULTITONE},
+    {"sparse", SIGNAL_SPARSE},
+    {"chirp", SIGNAL_CHIRP},
+    {"noise", SIGNAL_NOISE},
+    {"impulses", SIGNAL_IMPULSES},
+};
+static const int NUM_SIGNALS = sizeof(SIGNALS) / sizeof(SIGNALS[0]);
+
+static inline size_t batch_index(const BatchLayout *layout, int b, ptrdiff_t i){
+/* Gets the index of sample 'i' (in row-major order over n) of transform 'b' in a real array */
+    ptrdiff_t element = 0;
+    int d;
+
+    // A whole (possibly padded) row-major array only needs the row and the sample within it
+    if (layout->whole){
+        element = (i / layout->row_length) * layout->real_row_length + i % layout->row_length;
+        return (size_t)b * layout->real_dist + (size_t)element * layout->real_stride;
+    }
+    for (d=layout->rank-1; d>=0; d--){
+        element += (i % layout->n[d]) * layout->real_strides[d];
+        i /= layout->n[d];
+    }
+    return (size_t)b * layout->real_dist + (size_t)element;
+}
+
+#ifdef FFTW3
+// Instantiate the benchmark for each precision built in. Double is always built, and float, long
+// double and quad are built with -DFFTW3_FLOAT, -DFFTW3_LONG_DOUBLE and -DFFTW3_QUAD (which need
+// libfftw3f, libfftw3l, and libfftw3q + libquadmath, respectively).
+#define X(name) FFTW_MANGLE_DOUBLE(name)
+#define R double
+#define PRECISION_NAME "double"
+#define BENCHMARK(name) name##_double
+#define LIBRARY_NAME "fftw3"
+#define FUNCTION_PREFIX "fftw"
+#define R_EPSILON DBL_EPSILON
+#define R_COS(x) cosl(x)
+#define R_PI acosl(-1.0L)
+#include "cosine_dft_precision.h"
+#undef X
+#undef R
+#undef PRECISION_NAME
+#undef BENCHMARK
+#undef R_EPSILON
+#undef R_COS
+#undef R_PI
+#undef LIBRARY_NAME
+#undef FUNCTION_PREFIX
+
+#ifdef FFTW3_FLOAT
+#define X(name) FFTW_MANGLE_FLOAT(name)
+#define R float
+#define PRECISION_NAME "float"
+#define BENCHMARK(name) name##_float
+#define LIBRARY_NAME "fftw3f"
+#define FUNCTION_PREFIX "fftwf"
+#define R_EPSILON FLT_EPSILON
+#define R_COS(x) cosl(x)
+#define R_PI acosl(-1.0L)
+#include "cosine_dft_precision.h"
+#undef X
+#undef R
+#undef PRECISION_NAME
+#undef BENCHMARK
+#undef R_EPSILON
+#undef R_COS
+#undef R_PI
+#undef LIBRARY_NAME
+#undef FUNCTION_PREFIX
+#endif
+
+#ifdef FFTW3_LONG_DOUBLE
+#define X(name) FFTW_MANGLE_LONG_DOUBLE(name)
+#define R long double
+#define PRECISION_NAME "long-double"
+#define BENCHMARK(name) name##_long_double
+#define LIBRARY_NAME "fftw3l"
+#define FUNCTION_PREFIX "fftwl"
+#define R_EPSILON LDBL_EPSILON
+#define R_COS(x) cosl(x)
+#define R_PI acosl(-1.0L)
+#include "cosine_dft_precision.h"
+#undef X
+#undef R
+#undef PRECISION_NAME
+#undef BENCHMARK
+#undef R_EPSILON
+#undef R_COS
+#undef R_PI
+#undef LIBRARY_NAME
+#undef FUNCTION_PREFIX
+#endif
+
+#ifdef FFTW3_QUAD
+#define X(name) FFTW_MANGLE_QUAD(name)
+#define R __float128
+#define PRECISION_NAME "quad"
+#define BENCHMARK(name) name##_quad
+#define LIBRARY_NAME "fftw3q"
+#define FUNCTION_PREFIX "fftwq"
+#define R_EPSILON FLT128_EPSILON
+#define R_COS(x) cosq(x)
+#define R_PI M_PIq
+#include "cosine_dft_precision.h"
+#undef X
+#undef R
+#undef PRECISION_NAME
+#undef BENCHMARK
+#undef R_EPSILON
+#undef R_COS
+#undef R_PI
+#undef LIBRARY_NAME
+#undef FUNCTION_PREFIX
+#endif
+
+static const Precision PRECISIONS[] = {
+    {"double", run_dft_double},
+#ifdef FFTW3_FLOAT
+    {"float", run_dft_float},
+#endif
+#ifdef FFTW3_LONG_DOUBLE
+    {"long-double", run_dft_long_double},
+#endif
+#ifdef FFTW3_QUAD
+    {"quad", run_dft_quad},
+#endif
+};
+#else
+void run_dft_fftw2(const double *cosine, int rank, int *n, ptrdiff_t n_total, int nthreads, int niters, BenchmarkOptions *options, DFTBenchmarkResults *results);
+
+static const Precision PRECISIONS[] = {
+    {"double", run_dft_fftw2},
+};
+#endif
+static const int NUM_PRECISIONS = sizeof(PRECISIONS) / sizeof(PRECISIONS[0]);
 
 int main(int argc, char* argv[]){
 
     // Loop variables
-    int i,j;
+    int i, j;
 
     // Parse inputs
     bool plot; //to plot or not to plot -- that is the question!
@@ -52,8 +455,13 @@ int main(int argc, char* argv[]){
     double fs; //sampling frequency (double values)
     int nthreads, niters, rank;
     char *filename;
-    int n[100]; //will hold all of the rank data... max of 100 dims
+    int n[MAX_RANK]; //will hold all of the rank data... max of 100 dims
     char *pEnd;
+
+    // Parse (and remove) the optional flags so that only the positional arguments are left
+    BenchmarkOptions options;
+    argc = parse_options(argc, argv, &options);
+
     if (argc == 1){
         fprintf(stderr, "No arguments were passed! Please enter: (1.) \"noplot\" or \"plot\" for plotting, (2.) JSON document name to save results to, (3.) number of threads to use, (4.) number of iterations to execute, (5.) the sampling frequency \"fs\" for the cosine, (6.) the rank of the cosine, and (7.) the size of each dimension.\n");
         exit(0);
@@ -106,10 +514,59 @@ int main(int argc, char* argv[]){
             fprintf(stderr, "Sampling frequency must be greater than 0.0. You entered: %0.2e\n", fs);
             exit(0);
         }
-        if (rank < 1){
-            fprintf(stderr, "The rank must be greater than or equal to 1.\n");
+        if (rank < 1 || rank > MAX_RANK){
+            fprintf(stderr, "The rank must be between 1 and %d.\n", MAX_RANK);
+            exit(0);
+        }
+
+        // Each transform must fit in the array it's a window of
+        if (options.num_embed > 0 && options.num_embed != rank){
+            fprintf(stderr, "--embed has %d dimensions, but the rank is %d.\n", options.num_embed, rank);
             exit(0);
         }
+        for (i=0; i<options.num_embed; i++){
+            if (options.embed[i] < n[i]){
+                fprintf(stderr, "Dimension %d of --embed (%d) is smaller than the transform (%d).\n", i, options.embed[i], n[i]);
+                exit(0);
+            }
+        }
+
+        // A REDFT00 of size n is a DFT of size 2(n-1), so it needs n >= 2
+        for (i=0; i<options.num_r2r_kinds; i++){
+            for (j=0; j<rank && options.r2r_kinds[i]->logical_offset < 0; j++){
+                if (n[j] < 2){
+                    fprintf(stderr, "%s needs every dimension to be at least 2.\n", options.r2r_kinds[i]->name);
+                    exit(0);
+                }
+            }
+        }
+    }
+
+    // Keep an OpenMP team busy alongside the DFTs, like the OpenMP runtime of a co-located workload
+#ifdef FFTW3
+    BusyPool busy_pool;
+
+    // The work-stealing backend runs FFTW's parallel loops, the input generation and the batch loop
+    // on one persistent pool, rather than spawning threads for each of them
+    if (strcmp(options.threads_backend, "work-stealing") == 0){
+        options.work_pool = work_pool_create(nthreads);
+        if (options.work_pool == NULL)
+            exit(0);
+    }
+#endif
+
+    // A sweep writes its own document, with one result per size
+    if (options.sweep != NULL){
+#ifdef FFTW3
+        if (busy_pool_start(&busy_pool, options.busy_openmp_threads) != 0)
+            exit(0);
+#endif
+        run_sweep(filename, plot, fs, nthreads, niters, rank, n, &options);
+#ifdef FFTW3
+        busy_pool_stop(&busy_pool);
+        work_pool_destroy(options.work_pool);
+#endif
+        return 0;
     }
 
     // If the file exists, let's check that it's valid
@@ -121,136 +578,144 @@ int main(int argc, char* argv[]){
     }
 
     // Cosine variables
-    int n_total = 1;
+    ptrdiff_t n_total = 1;
 
     // Plot variables
     char *title = "Resulting cosine Curve After Forward and Backward DFTs";
 
-    // FFTW variables
-    unsigned flags = FFTW_ESTIMATE;
-
-    // Performance variables
-    struct timeval forward_dft_start, forward_dft_stop;
-    struct timeval backward_dft_start, backward_dft_stop;
-    double forward_dft_execution_time_us = 0.0; //Forward DFT execution time in microseconds (us)
-    double backward_dft_execution_time_us = 0.0; //Backward DFT in us
-    double total_f_dft_exec_time_us = 0.0; //total forward DFT in us
-    double total_b_dft_exec_time_us = 0.0; //total backward DFT in us
-
     // Get the total number of indices
     for (i=0; i<rank; i++){
         n_total *= n[i];
     }
 
-    // For a complex transform, we have n[0] x n[1] x n[2] x ... x (n[rank-1]/2 + 1). So, our math is
-    // as follows: n_total = n[0] x n[1] x n[2] x ... x n[rank-1]. Since n_total includes n[d-1], we have
-    // to divide n_total by n[rank-1] to get n_toral = n[0] x n[1] x n[2] x ... x n[rank-2]. Then we 
-    // multiply by n[rank-1] / 2 + 1
-    int n_complex_total = (n_total / n[rank-1]) * (n[rank-1] / 2 + 1);
-
-    // Set threading
-    fftw_init_threads();
-#ifdef FFTW3
-    // For FFTW3 only, we can use fftw_plan_with_nthreads(nthreads) rather than passing in the number of
-    // threads each time we execute a transform
-    fftw_plan_with_nthreads(nthreads);
-#endif
-
-    // Allocate memory for cosine data
-    double *cosine = (double*)malloc(n_total * sizeof(double));
-
-    // Fill N-dimensional cosine matrix
-    generate_cosine_data(cosine, fs, rank, n, n_total);
-
-#ifdef FFTW3
-    // Set time limit so that FFTW doesn't spend too much time trying to figure out the "best" algorithm.
-    fftw_set_timelimit(TIMELIMIT);
-#endif
-
-    // Initialize real-to-complex cosine input and output
-    double *cosine_original = (double*)fftw_malloc(n_total * sizeof(double));
-    fftw_complex *cosine_complex = (fftw_complex*)fftw_malloc(n_complex_total * sizeof(fftw_complex));
-
-    // Initialize the cosine that will be returned from the complex DFT
-    double *cosine_back = (double*)fftw_malloc(n_total * sizeof(double));
-
-    // We'll need to do work on a dummy array to prevent the compiler from optimizing the loop
-    int dummy[niters];
+    // Map the N-dimensional input from the input cache, or generate it
+    InputData input;
+    load_input_data(&input, fs, rank, n, n_total, &options, nthreads);
+    const double *cosine = input.data;
+
+    // Lay out the batch (which also checks that its transforms don't overlap)
+    BatchLayout layout;
+    batch_layout(rank, n, n_total, &options, &layout);
+    ptrdiff_t batch_dist = layout.real_dist;
+
+    // Run the DFTs in the chosen precision
+    DFTBenchmarkResults results;
+    memset(&results, 0, sizeof(DFTBenchmarkResults));
+    results.fft_performance_times_us = malloc(niters * sizeof(double));
+    results.ifft_performance_times_us = malloc(niters * sizeof(double));
+    results.copy_in_times_us = malloc(niters * sizeof(double));
+    results.normalize_times_us = malloc(niters * sizeof(double));
+    results.cosine_back = (plot == true) ? malloc(n_total * sizeof(double)) : NULL;
     srand(time(0));
-    int rand_idx; //random index
-    int max_idx = n_total - 1; //max index of the cosine array (matrix)
-    double *fft_performance_times_us = malloc(niters * sizeof(double));
-    double *ifft_performance_times_us = malloc(niters * sizeof(double));
-
-    // Iterate
-    for (j=0; j<niters; j++){
-        // Create FFTW plans
-#ifdef FFTW3
-        fftw_plan forward_cos_dft_plan = fftw_plan_dft_r2c(rank, n, cosine_original, cosine_complex, flags);
-        fftw_plan backward_cos_dft_plan = fftw_plan_dft_c2r(rank, n, cosine_complex, cosine_back, flags);
-#else
-        rfftwnd_plan forward_cos_dft_plan = rfftwnd_create_plan(rank, n, FFTW_REAL_TO_COMPLEX, flags);
-        rfftwnd_plan backward_cos_dft_plan = rfftwnd_create_plan(rank, n, FFTW_COMPLEX_TO_REAL, flags);
-#endif
-
-        // Fill input cosine array (this MUST be done after the fftw plans are created)
-        for (i=0; i<n_total; i++)
-            cosine_original[i] = cosine[i];
-
-        // Execute Forward DFT and capture performance time
-        gettimeofday(&forward_dft_start, NULL); //start clock
 #ifdef FFTW3
-        fftw_execute(forward_cos_dft_plan);
-#else
-        rfftwnd_threads_one_real_to_complex(nthreads, forward_cos_dft_plan, cosine_original, cosine_complex);
+    if (busy_pool_start(&busy_pool, options.busy_openmp_threads) != 0)
+        exit(0);
 #endif
-        gettimeofday(&forward_dft_stop, NULL); //stop clock
-        forward_dft_execution_time_us = (forward_dft_stop.tv_sec - forward_dft_start.tv_sec) * (1e6); //sec to us
-        forward_dft_execution_time_us += (forward_dft_stop.tv_usec - forward_dft_start.tv_usec);
-        total_f_dft_exec_time_us += forward_dft_execution_time_us;
-        fft_performance_times_us[j] = forward_dft_execution_time_us;
-
-        // Execute Backward DFT and capture performance time
-        gettimeofday(&backward_dft_start, NULL); //start clock
+    find_precision(options.precision)->run_dft(cosine, rank, n, n_total, nthreads, niters, &options, &results);
 #ifdef FFTW3
-        fftw_execute(backward_cos_dft_plan);
-#else
-        rfftwnd_threads_one_complex_to_real(nthreads, backward_cos_dft_plan, cosine_complex, cosine_back);
+    busy_pool_stop(&busy_pool);
 #endif
-        gettimeofday(&backward_dft_stop, NULL); //stop clock
-        backward_dft_execution_time_us = (backward_dft_stop.tv_sec - backward_dft_start.tv_sec) * (1e6);// sec to us
-        backward_dft_execution_time_us += (backward_dft_stop.tv_usec - backward_dft_start.tv_usec);
-        total_b_dft_exec_time_us += backward_dft_execution_time_us;
-        ifft_performance_times_us[j] = backward_dft_execution_time_us;
-
-        // Do work on dummy array to prevent the compiler from optimizing on its own
-        rand_idx = rand() % (max_idx + 1);
-        dummy[j] = j + cosine_back[rand_idx];
-
-        // Destroy FFTW plans
-        fftw_destroy_plan(forward_cos_dft_plan);
-        fftw_destroy_plan(backward_cos_dft_plan);
-    }
-
-    // Free memory
-    fftw_free(cosine_original);
-    fftw_free(cosine_complex);
 
-#ifdef FFTW3
-    // Handle threading
-    fftw_cleanup_threads();
-#endif
+    // Get the peak memory use of the run, which includes the (double precision) cosine input. On
+    // Linux, ru_maxrss is in KiB.
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    double peak_rss_mib = usage.ru_maxrss / 1024.0;
+    double dft_buffers_mib = results.dft_buffer_bytes / (1024.0 * 1024.0);
+
+    double forward_plan_time_us = results.forward_plan_time_us;
+    double backward_plan_time_us = results.backward_plan_time_us;
+    double *fft_performance_times_us = results.fft_performance_times_us;
+    double *ifft_performance_times_us = results.ifft_performance_times_us;
+    double total_f_dft_exec_time_us = results.total_f_dft_exec_time_us;
+    double total_b_dft_exec_time_us = results.total_b_dft_exec_time_us;
+    double *cosine_back = results.cosine_back;
 
     // Get average times
     double average_forward_dft_exec_time_us = total_f_dft_exec_time_us / niters;
     double average_backward_dft_exec_time_us = total_b_dft_exec_time_us / niters;
 
-    // Compute teraflops (see here for info on how to calculate mflops: http://www.fftw.org/speed/)
-    long double forward_dft_mflops_approx = 5 * n_total * log2l(n_total) / (average_forward_dft_exec_time_us * 2);
-    long double backward_dft_mflops_approx = 5 * n_total * log2l(n_total) / (average_backward_dft_exec_time_us * 2);
+    // Count GFlops from the operations the plans actually perform (fftw_flops), which accounts for the
+    // real input and for the radices of the size. FFTW's own convention, 2.5 N log2(N) flops for a real
+    // transform of N samples (http://www.fftw.org/speed/method.html), is a scaled inverse time rather
+    // than a count, and is saved separately as "FFTW mflops". FFTW2 can't count the operations of a
+    // plan, so its GFlops follow the convention. Each execute runs a whole batch of transforms.
+    long double convention_flops = 2.5 * (long double)options.batch * n_total * log2l(n_total);
+    long double forward_dft_flops = (results.forward_flops > 0) ? results.forward_flops : convention_flops;
+    long double backward_dft_flops = (results.backward_flops > 0) ? results.backward_flops : convention_flops;
+    long double forward_dft_fftw_mflops = convention_flops / average_forward_dft_exec_time_us;
+    long double backward_dft_fftw_mflops = convention_flops / average_backward_dft_exec_time_us;
+
+    // Get transforms per second of the batch plan, and of the same batch as a loop of single
+    // transforms, in one thread and split across threads
+    double transforms_per_execute = options.batch * (double)niters;
+    double forward_dft_transforms_per_sec = transforms_per_execute / (total_f_dft_exec_time_us * (1e-6));
+    double backward_dft_transforms_per_sec = transforms_per_execute / (total_b_dft_exec_time_us * (1e-6));
+    double forward_loop_transforms_per_sec = transforms_per_execute / (results.total_f_loop_exec_time_us * (1e-6));
+    double backward_loop_transforms_per_sec = transforms_per_execute / (results.total_b_loop_exec_time_us * (1e-6));
+    double forward_parallel_loop_transforms_per_sec = transforms_per_execute / (results.total_f_parallel_loop_exec_time_us * (1e-6));
+    double backward_parallel_loop_transforms_per_sec = transforms_per_execute / (results.total_b_parallel_loop_exec_time_us * (1e-6));
+
+    // A strided batch is also run from contiguous arrays, both as is and after copying the strided
+    // input to them (and the output back), which shows what the strided access costs and whether a
+    // program should copy its data to contiguous arrays first. Speedups above 1 favor copying.
+    double average_forward_contiguous_exec_time_us = results.total_f_contiguous_exec_time_us / niters;
+    double average_backward_contiguous_exec_time_us = results.total_b_contiguous_exec_time_us / niters;
+    double average_copy_in_time_us = results.total_copy_in_time_us / niters;
+    double average_copy_out_time_us = results.total_copy_out_time_us / niters;
+    double forward_strided_slowdown = 0.0, backward_strided_slowdown = 0.0;
+    double forward_copy_first_speedup = 0.0, backward_copy_first_speedup = 0.0;
+    if (layout.strided){
+        forward_strided_slowdown = average_forward_dft_exec_time_us / average_forward_contiguous_exec_time_us;
+        backward_strided_slowdown = average_backward_dft_exec_time_us / average_backward_contiguous_exec_time_us;
+        forward_copy_first_speedup = average_forward_dft_exec_time_us / (average_copy_in_time_us + average_forward_contiguous_exec_time_us);
+        backward_copy_first_speedup = average_backward_dft_exec_time_us / (average_backward_contiguous_exec_time_us + average_copy_out_time_us);
+    }
+
+    // A correct FFT's error grows like log2(N) machine epsilons, so anything far beyond that means
+    // the build (or the hardware) is broken, however fast it is. The real-to-real round trips are
+    // held to the same tolerance.
+    double accuracy_tolerance = options.accuracy_tolerance * results.machine_epsilon * fmax(1.0, log2((double)n_total));
+    bool accuracy_passed = results.round_trip_error <= accuracy_tolerance && results.round_trip_linf_error <= accuracy_tolerance &&
+                           results.spectrum_error <= accuracy_tolerance;
+    for (i=0; i<options.num_r2r_kinds; i++){
+        if (results.r2r[i].round_trip_error > accuracy_tolerance)
+            accuracy_passed = false;
+    }
+
+    long double forward_dft_gflops_approx = forward_dft_flops / average_forward_dft_exec_time_us * (1e-3);
+    long double backward_dft_gflops_approx = backward_dft_flops / average_backward_dft_exec_time_us * (1e-3);
+
+    // Real-to-real GFlops are counted from their plans as well. Their FFTW mflops follow the r2c
+    // convention of 2.5 N log2(N) flops for N real samples, so they can be compared with the r2c
+    // FFTW mflops above at the same dims.
+    R2RBenchmarkResults *r2r = results.r2r;
+    double r2r_average_forward_exec_time_us[NUM_R2R_KINDS], r2r_average_backward_exec_time_us[NUM_R2R_KINDS];
+    long double r2r_forward_gflops[NUM_R2R_KINDS], r2r_backward_gflops[NUM_R2R_KINDS];
+    long double r2r_forward_fftw_mflops[NUM_R2R_KINDS], r2r_backward_fftw_mflops[NUM_R2R_KINDS];
+    for (i=0; i<options.num_r2r_kinds; i++){
+        r2r_average_forward_exec_time_us[i] = r2r[i].total_f_exec_time_us / niters;
+        r2r_average_backward_exec_time_us[i] = r2r[i].total_b_exec_time_us / niters;
+        r2r_forward_gflops[i] = r2r[i].forward_flops / r2r_average_forward_exec_time_us[i] * (1e-3);
+        r2r_backward_gflops[i] = r2r[i].backward_flops / r2r_average_backward_exec_time_us[i] * (1e-3);
+        r2r_forward_fftw_mflops[i] = 2.5 * n_total * log2l(n_total) / r2r_average_forward_exec_time_us[i];
+        r2r_backward_fftw_mflops[i] = 2.5 * n_total * log2l(n_total) / r2r_average_backward_exec_time_us[i];
+    }
 
-    long double forward_dft_gflops_approx = forward_dft_mflops_approx * (1e-3);
-    long double backward_dft_gflops_approx = backward_dft_mflops_approx * (1e-3);
+    // Summarize each phase of the run, to show what share of it the DFTs themselves take. For small
+    // transforms, filling the input and normalizing the output can take as long as the DFTs.
+    double plan_time_us = forward_plan_time_us + backward_plan_time_us;
+    double end_to_end_time_us = 0.0;
+    PhaseStats phases[NUM_PHASES];
+    phase_stats(&phases[PHASE_PLAN], "plan", &plan_time_us, 1);
+    phase_stats(&phases[PHASE_COPY_IN], "copy_in", results.copy_in_times_us, niters);
+    phase_stats(&phases[PHASE_FORWARD], "forward", fft_performance_times_us, niters);
+    phase_stats(&phases[PHASE_BACKWARD], "backward", ifft_performance_times_us, niters);
+    phase_stats(&phases[PHASE_NORMALIZE], "normalize", results.normalize_times_us, niters);
+    phase_stats(&phases[PHASE_DESTROY], "destroy", &results.destroy_time_us, 1);
+    for (i=0; i<NUM_PHASES; i++)
+        end_to_end_time_us += phases[i].total_us;
+    double dft_fraction = (end_to_end_time_us > 0) ? (phases[PHASE_FORWARD].total_us + phases[PHASE_BACKWARD].total_us) / end_to_end_time_us : 0.0;
 
     // Compute standard dev
     double forward_dft_diff_us, backward_dft_diff_us;
@@ -278,24 +743,21 @@ int main(int argc, char* argv[]){
     long double forward_dft_stdev_us = pow((forward_dft_squared_diff_totals / niters), 0.5);
     long double backward_dft_stdev_us = pow((backward_dft_squared_diff_totals / niters), 0.5);
 
-    // Compute standard deviation as a percentage
-    long double forward_dft_stdev_percentage = forward_dft_stdev_us / total_f_dft_exec_time_us;
-    long double backward_dft_stdev_percentage = backward_dft_stdev_us / total_b_dft_exec_time_us;
+    // Compute standard deviation relative to the mean time per iteration
+    long double forward_dft_stdev_percentage = forward_dft_stdev_us / average_forward_dft_exec_time_us;
+    long double backward_dft_stdev_percentage = backward_dft_stdev_us / average_backward_dft_exec_time_us;
 
     // Compute standard deviation in terms of GFlops
     long double forward_dft_stdev_gflops = forward_dft_gflops_approx * forward_dft_stdev_percentage;
     long double backward_dft_stdev_gflops = backward_dft_gflops_approx * backward_dft_stdev_percentage;
 
-    // Fix cosine_back because its height has been adjusted by the FFT
-    for (i=0; i<n_total; i++)
-        cosine_back[i] /= n_total;
-
-    // Plot result to ensure we get back what we put in!
-    if (plot == true)
+    // Plot result to ensure we get back what we put in! (cosine_back has already been normalized)
+    if (plot == true){
         plot1D(cosine_back, 1, rank, n, fs, title);
 
-    //Now put 'dummy' to use so that the compiler doesn't get rid of it
-    cosine_back[0] = dummy[0];
+        //Now put 'dummy' to use so that the compiler doesn't get rid of it
+        cosine_back[0] = results.dummy;
+    }
 
     // Prepare file to save results to
     char *tmp_filename = "tmp.json";
@@ -364,17 +826,133 @@ int main(int argc, char* argv[]){
     fprintf(tmp_file, " %d],\n", n[rank-1]);
     fprintf(tmp_file, "                \"fs_Hz\": %0.2e,\n", fs);
     fprintf(tmp_file, "                \"iterations\": %d,\n", niters);
-    fprintf(tmp_file, "                \"threads\": %d\n", nthreads);
+    fprintf(tmp_file, "                \"threads\": %d,\n", nthreads);
+    fprintf(tmp_file, "                \"threads_backend\": \"%s\",\n", options.threads_backend);
+    fprintf(tmp_file, "                \"busy_openmp_threads\": %d,\n", options.busy_openmp_threads);
+    fprintf(tmp_file, "                \"rigor\": \"%s\",\n", options.rigor);
+    fprintf(tmp_file, "                \"precision\": \"%s\",\n", options.precision);
+    fprintf(tmp_file, "                \"signal\": \"%s\",\n", options.signal);
+    fprintf(tmp_file, "                \"in_place\": %s,\n", options.in_place ? "true" : "false");
+    fprintf(tmp_file, "                \"howmany\": %d,\n", options.batch);
+    fprintf(tmp_file, "                \"stride\": %d,\n", options.batch_stride);
+    fprintf(tmp_file, "                \"dist\": %td,\n", batch_dist);
+    fprintf(tmp_file, "                \"embed\": [");
+    for (i=0; i<rank; i++)
+        fprintf(tmp_file, " %d%s", layout.real_embed[i], (i < rank - 1) ? "," : "");
+    fprintf(tmp_file, "],\n");
+    fprintf(tmp_file, "                \"transposed\": %s\n", layout.transposed ? "true" : "false");
     fprintf(tmp_file, "            },\n");
     fprintf(tmp_file, "            \"forward_dft_results\": {\n");
+    fprintf(tmp_file, "                \"plan_time_seconds\": %0.6f,\n", forward_plan_time_us * (1e-6));
     fprintf(tmp_file, "                \"average_execution_time_seconds\": %0.5f,\n", average_forward_dft_exec_time_us * (1e-6));
     fprintf(tmp_file, "                \"average_gflops\": %0.5Lf,\n", forward_dft_gflops_approx);
+    fprintf(tmp_file, "                \"flops_per_execution\": %0.0Lf,\n", forward_dft_flops);
+    fprintf(tmp_file, "                \"fftw_mflops\": %0.3Lf,\n", forward_dft_fftw_mflops);
+    fprintf(tmp_file, "                \"transforms_per_second\": %0.1f,\n", forward_dft_transforms_per_sec);
     fprintf(tmp_file, "                \"stdev_gflops\": %0.5Lf\n", forward_dft_stdev_gflops);
     fprintf(tmp_file, "            },\n");
     fprintf(tmp_file, "            \"backward_dft_results\": {\n");
+    fprintf(tmp_file, "                \"plan_time_seconds\": %0.6f,\n", backward_plan_time_us * (1e-6));
     fprintf(tmp_file, "                \"average_execution_time_seconds\": %0.5f,\n", average_backward_dft_exec_time_us * (1e-6));
     fprintf(tmp_file, "                \"average_gflops\": %0.5Lf,\n", backward_dft_gflops_approx);
+    fprintf(tmp_file, "                \"flops_per_execution\": %0.0Lf,\n", backward_dft_flops);
+    fprintf(tmp_file, "                \"fftw_mflops\": %0.3Lf,\n", backward_dft_fftw_mflops);
+    fprintf(tmp_file, "                \"transforms_per_second\": %0.1f,\n", backward_dft_transforms_per_sec);
     fprintf(tmp_file, "                \"stdev_gflops\": %0.5Lf\n", backward_dft_stdev_gflops);
+    fprintf(tmp_file, "            },\n");
+    if (options.num_r2r_kinds > 0){
+        fprintf(tmp_file, "            \"r2r_results\": {\n");
+        for (i=0; i<options.num_r2r_kinds; i++){
+            fprintf(tmp_file, "                \"%s\": {\n", r2r[i].kind->name);
+            fprintf(tmp_file, "                    \"inverse\": \"%s\",\n", r2r[i].kind->inverse_name);
+            fprintf(tmp_file, "                    \"forward_plan_time_seconds\": %0.6f,\n", r2r[i].forward_plan_time_us * (1e-6));
+            fprintf(tmp_file, "                    \"forward_average_execution_time_seconds\": %0.5f,\n", r2r_average_forward_exec_time_us[i] * (1e-6));
+            fprintf(tmp_file, "                    \"forward_average_gflops\": %0.5Lf,\n", r2r_forward_gflops[i]);
+            fprintf(tmp_file, "                    \"forward_fftw_mflops\": %0.3Lf,\n", r2r_forward_fftw_mflops[i]);
+            fprintf(tmp_file, "                    \"backward_plan_time_seconds\": %0.6f,\n", r2r[i].backward_plan_time_us * (1e-6));
+            fprintf(tmp_file, "                    \"backward_average_execution_time_seconds\": %0.5f,\n", r2r_average_backward_exec_time_us[i] * (1e-6));
+            fprintf(tmp_file, "                    \"backward_average_gflops\": %0.5Lf,\n", r2r_backward_gflops[i]);
+            fprintf(tmp_file, "                    \"backward_fftw_mflops\": %0.3Lf,\n", r2r_backward_fftw_mflops[i]);
+            fprintf(tmp_file, "                    \"round_trip_relative_l2_error\": %0.3e\n", r2r[i].round_trip_error);
+            fprintf(tmp_file, "                }%s\n", (i < options.num_r2r_kinds - 1) ? "," : "");
+        }
+        fprintf(tmp_file, "            },\n");
+    }
+    fprintf(tmp_file, "            \"accuracy\": {\n");
+    fprintf(tmp_file, "                \"round_trip_relative_l2_error\": %0.3e,\n", results.round_trip_error);
+    fprintf(tmp_file, "                \"round_trip_relative_linf_error\": %0.3e,\n", results.round_trip_linf_error);
+    fprintf(tmp_file, "                \"spectrum_relative_linf_error\": %0.3e,\n", results.spectrum_error);
+    fprintf(tmp_file, "                \"machine_epsilon\": %0.3e,\n", results.machine_epsilon);
+    fprintf(tmp_file, "                \"tolerance\": %0.3e,\n", accuracy_tolerance);
+    fprintf(tmp_file, "                \"passed\": %s\n", accuracy_passed ? "true" : "false");
+    fprintf(tmp_file, "            },\n");
+    fprintf(tmp_file, "            \"phases\": {\n");
+    fprintf(tmp_file, "                \"end_to_end_time_seconds\": %0.6f,\n", end_to_end_time_us * (1e-6));
+    fprintf(tmp_file, "                \"dft_fraction\": %0.4f,\n", dft_fraction);
+    for (i=0; i<NUM_PHASES; i++){
+        fprintf(tmp_file, "                \"%s\": {\n", phases[i].name);
+        fprintf(tmp_file, "                    \"runs\": %d,\n", phases[i].runs);
+        fprintf(tmp_file, "                    \"total_time_seconds\": %0.6f,\n", phases[i].total_us * (1e-6));
+        fprintf(tmp_file, "                    \"average_time_seconds\": %0.6f,\n", phases[i].mean_us * (1e-6));
+        fprintf(tmp_file, "                    \"min_time_seconds\": %0.6f,\n", phases[i].min_us * (1e-6));
+        fprintf(tmp_file, "                    \"max_time_seconds\": %0.6f,\n", phases[i].max_us * (1e-6));
+        fprintf(tmp_file, "                    \"stdev_time_seconds\": %0.6f,\n", phases[i].stdev_us * (1e-6));
+        fprintf(tmp_file, "                    \"fraction\": %0.4f\n", (end_to_end_time_us > 0) ? phases[i].total_us / end_to_end_time_us : 0.0);
+        fprintf(tmp_file, "                }%s\n", (i < NUM_PHASES - 1) ? "," : "");
+    }
+    fprintf(tmp_file, "            },\n");
+    fprintf(tmp_file, "            \"memory\": {\n");
+    fprintf(tmp_file, "                \"dft_buffers_mib\": %0.3f,\n", dft_buffers_mib);
+    fprintf(tmp_file, "                \"peak_rss_mib\": %0.3f\n", peak_rss_mib);
+    if (options.batch > 1){
+        fprintf(tmp_file, "            },\n");
+        fprintf(tmp_file, "            \"batch_results\": {\n");
+        fprintf(tmp_file, "                \"loop_forward_transforms_per_second\": %0.1f,\n", forward_loop_transforms_per_sec);
+        fprintf(tmp_file, "                \"loop_backward_transforms_per_second\": %0.1f,\n", backward_loop_transforms_per_sec);
+        fprintf(tmp_file, "                \"parallel_loop_forward_transforms_per_second\": %0.1f,\n", forward_parallel_loop_transforms_per_sec);
+        fprintf(tmp_file, "                \"parallel_loop_backward_transforms_per_second\": %0.1f\n", backward_parallel_loop_transforms_per_sec);
+    }
+    if (layout.strided){
+        fprintf(tmp_file, "            },\n");
+        fprintf(tmp_file, "            \"strided_results\": {\n");
+        fprintf(tmp_file, "                \"contiguous_forward_average_execution_time_seconds\": %0.6f,\n", average_forward_contiguous_exec_time_us * (1e-6));
+        fprintf(tmp_file, "                \"contiguous_backward_average_execution_time_seconds\": %0.6f,\n", average_backward_contiguous_exec_time_us * (1e-6));
+        fprintf(tmp_file, "                \"copy_in_average_time_seconds\": %0.6f,\n", average_copy_in_time_us * (1e-6));
+        fprintf(tmp_file, "                \"copy_out_average_time_seconds\": %0.6f,\n", average_copy_out_time_us * (1e-6));
+        fprintf(tmp_file, "                \"forward_strided_slowdown\": %0.3f,\n", forward_strided_slowdown);
+        fprintf(tmp_file, "                \"backward_strided_slowdown\": %0.3f,\n", backward_strided_slowdown);
+        fprintf(tmp_file, "                \"forward_copy_first_speedup\": %0.3f,\n", forward_copy_first_speedup);
+        fprintf(tmp_file, "                \"backward_copy_first_speedup\": %0.3f\n", backward_copy_first_speedup);
+    }
+    if (options.input_cache_dir != NULL){
+        fprintf(tmp_file, "            },\n");
+        fprintf(tmp_file, "            \"input_cache\": {\n");
+        fprintf(tmp_file, "                \"hit\": %s,\n", input.cache_hit ? "true" : "false");
+        fprintf(tmp_file, "                \"setup_time_seconds\": %0.6f\n", input.setup_time_sec);
+    }
+#ifdef FFTW3
+    if (busy_pool.nthreads > 0){
+        fprintf(tmp_file, "            },\n");
+        fprintf(tmp_file, "            \"busy_openmp\": {\n");
+        fprintf(tmp_file, "                \"threads\": %d,\n", busy_pool.nthreads);
+        fprintf(tmp_file, "                \"gflops\": %0.5f\n", busy_pool.gflops);
+    }
+    if (options.work_pool != NULL){
+        fprintf(tmp_file, "            },\n");
+        fprintf(tmp_file, "            \"work_pool\": {\n");
+        fprintf(tmp_file, "                \"threads\": %d,\n", options.work_pool->nthreads);
+        fprintf(tmp_file, "                \"jobs\": %ld,\n", atomic_load(&options.work_pool->num_jobs));
+        fprintf(tmp_file, "                \"steals\": %ld\n", atomic_load(&options.work_pool->num_steals));
+    }
+    if (results.wisdom_cache.enabled){
+        fprintf(tmp_file, "            },\n");
+        fprintf(tmp_file, "            \"wisdom\": {\n");
+        fprintf(tmp_file, "                \"fingerprint\": \"%s\",\n", results.wisdom_cache.fingerprint);
+        fprintf(tmp_file, "                \"hits\": %d,\n", results.wisdom_cache.num_hits);
+        fprintf(tmp_file, "                \"misses\": %d,\n", results.wisdom_cache.num_misses);
+        fprintf(tmp_file, "                \"plan_time_saved_seconds\": %0.6f\n", results.wisdom_cache.plan_time_saved_sec);
+    }
+#endif
     fprintf(tmp_file, "            }\n");
     fprintf(tmp_file, "        }\n");
     fprintf(tmp_file, "    }\n");
@@ -389,107 +967,1467 @@ int main(int argc, char* argv[]){
     printf("\nPERFORMANCE RESULTS\n");
     printf("===================\n");
     printf("Input Info:\n");
-    printf("    One %dD cosine: %d", rank, n[0]);
+    printf("    One %dD %s: %d", rank, options.signal, n[0]);
     for (i=1; i<rank; i++)
         printf(" x %d", n[i]);
     printf(" samples\n");
     printf("    fs = %0.2e Hz\n", fs);
     printf("    %d iterations\n", niters);
-    printf("    %d threads used\n", nthreads);
+    printf("    %d threads used (%s backend)\n", nthreads, options.threads_backend);
+    printf("    Planner rigor: %s\n", options.rigor);
+    printf("    Precision: %s\n", options.precision);
+    printf("    Transform: %s\n", options.in_place ? "in place" : "out of place");
+    if (options.batch > 1)
+        printf("    Batch: %d transforms, stride %d, dist %td\n", options.batch, options.batch_stride, batch_dist);
+    if (layout.whole == false){
+        printf("    Layout: window of a %d", layout.real_embed[0]);
+        for (i=1; i<rank; i++)
+            printf(" x %d", layout.real_embed[i]);
+        printf(" array%s\n", layout.transposed ? ", transposed" : "");
+    }
     printf("DFT Results\n");
+    printf("    Forward DFT plan time: %0.6f sec\n", forward_plan_time_us * (1e-6));
+    printf("    Backward DFT plan time: %0.6f sec\n", backward_plan_time_us * (1e-6));
     printf("    Forward DFT execution time: %0.3f sec\n", average_forward_dft_exec_time_us * (1e-6));
-    printf("    Forward DFT GFlops: %0.3Lf\n", forward_dft_gflops_approx);
+    printf("    Forward DFT GFlops: %0.3Lf (FFTW mflops: %0.1Lf)\n", forward_dft_gflops_approx, forward_dft_fftw_mflops);
     printf("    Backward DFT execution time: %0.3f sec\n", average_backward_dft_exec_time_us * (1e-6));
-    printf("    Backward DFT GFlops: %0.3Lf\n", backward_dft_gflops_approx);
+    printf("    Backward DFT GFlops: %0.3Lf (FFTW mflops: %0.1Lf)\n", backward_dft_gflops_approx, backward_dft_fftw_mflops);
+    printf("    Forward DFT transforms/sec: %0.1f\n", forward_dft_transforms_per_sec);
+    printf("    Backward DFT transforms/sec: %0.1f\n", backward_dft_transforms_per_sec);
+    printf("Accuracy\n");
+    printf("    Round trip relative L2 error: %0.3e (machine epsilon: %0.3e)\n", results.round_trip_error, results.machine_epsilon);
+    printf("    Round trip relative Linf error: %0.3e\n", results.round_trip_linf_error);
+    printf("    Pure tone spectrum relative Linf error: %0.3e\n", results.spectrum_error);
+    printf("    Tolerance: %0.3e (%s)\n", accuracy_tolerance, accuracy_passed ? "passed" : "FAILED");
+    printf("Phases (share of end-to-end time)\n");
+    for (i=0; i<NUM_PHASES; i++){
+        if (phases[i].runs == 1)
+            printf("    %-10s %0.6f sec once, %5.1f%%\n", phases[i].name, phases[i].total_us * (1e-6),
+                   (end_to_end_time_us > 0) ? 100 * phases[i].total_us / end_to_end_time_us : 0.0);
+        else
+            printf("    %-10s %0.6f sec mean (min %0.6f, max %0.6f, stdev %0.6f), %5.1f%%\n", phases[i].name, phases[i].mean_us * (1e-6),
+                   phases[i].min_us * (1e-6), phases[i].max_us * (1e-6), phases[i].stdev_us * (1e-6),
+                   (end_to_end_time_us > 0) ? 100 * phases[i].total_us / end_to_end_time_us : 0.0);
+    }
+    printf("    DFTs: %0.1f%% of %0.6f sec end to end\n", 100 * dft_fraction, end_to_end_time_us * (1e-6));
+    if (options.num_r2r_kinds > 0){
+        printf("Real-to-Real Results\n");
+        for (i=0; i<options.num_r2r_kinds; i++){
+            printf("    %s: %0.6f sec (%0.3Lf GFlops), inverse %s: %0.6f sec (%0.3Lf GFlops), round trip error %0.3e\n", r2r[i].kind->name,
+                   r2r_average_forward_exec_time_us[i] * (1e-6), r2r_forward_gflops[i], r2r[i].kind->inverse_name,
+                   r2r_average_backward_exec_time_us[i] * (1e-6), r2r_backward_gflops[i], r2r[i].round_trip_error);
+        }
+    }
+    if (options.batch > 1){
+        printf("Batch Results (transforms/sec)\n");
+        printf("    Batch plan: %0.1f forward, %0.1f backward\n", forward_dft_transforms_per_sec, backward_dft_transforms_per_sec);
+        printf("    Loop of single transforms: %0.1f forward, %0.1f backward\n", forward_loop_transforms_per_sec, backward_loop_transforms_per_sec);
+        printf("    Loop split across %d threads: %0.1f forward, %0.1f backward\n", nthreads, forward_parallel_loop_transforms_per_sec,
+               backward_parallel_loop_transforms_per_sec);
+    }
+    if (layout.strided){
+        printf("Strided Layout (vs contiguous arrays)\n");
+        printf("    Contiguous: %0.6f sec forward, %0.6f sec backward\n", average_forward_contiguous_exec_time_us * (1e-6),
+               average_backward_contiguous_exec_time_us * (1e-6));
+        printf("    Copy to contiguous: %0.6f sec in, %0.6f sec out\n", average_copy_in_time_us * (1e-6), average_copy_out_time_us * (1e-6));
+        printf("    Strided slowdown: %0.3fx forward, %0.3fx backward\n", forward_strided_slowdown, backward_strided_slowdown);
+        printf("    Copying first: %0.3fx forward, %0.3fx backward (%s)\n", forward_copy_first_speedup, backward_copy_first_speedup,
+               (forward_copy_first_speedup > 1 && backward_copy_first_speedup > 1) ? "faster" :
+               (forward_copy_first_speedup > 1 || backward_copy_first_speedup > 1) ? "faster one way" : "slower");
+    }
+    printf("Memory\n");
+    printf("    DFT buffers: %0.3f MiB\n", dft_buffers_mib);
+    printf("    Peak RSS: %0.3f MiB\n", peak_rss_mib);
+    if (options.input_cache_dir != NULL){
+        printf("Input Cache\n");
+        printf("    %s: %s\n", input.cache_hit ? "Mapped" : "Generated", input.cache_path);
+        printf("    Setup time: %0.6f sec\n", input.setup_time_sec);
+    }
+#ifdef FFTW3
+    if (busy_pool.nthreads > 0){
+        printf("Busy OpenMP Pool\n");
+        printf("    %d threads, %0.3f GFlops while the DFTs ran\n", busy_pool.nthreads, busy_pool.gflops);
+    }
+    if (options.work_pool != NULL){
+        printf("Work-Stealing Pool\n");
+        printf("    %d threads, %ld jobs, %ld stolen\n", options.work_pool->nthreads, atomic_load(&options.work_pool->num_jobs),
+               atomic_load(&options.work_pool->num_steals));
+    }
+    if (results.wisdom_cache.enabled){
+        printf("Wisdom Cache\n");
+        printf("    Fingerprint: %s\n", results.wisdom_cache.fingerprint);
+        printf("    Hits: %d, misses: %d\n", results.wisdom_cache.num_hits, results.wisdom_cache.num_misses);
+        printf("    Planning time saved: %0.6f sec\n", results.wisdom_cache.plan_time_saved_sec);
+    }
+#endif
+
+    // Planning pays off once the time it saves per transform adds up to the time it took, so the
+    // cost of a plan in executions shows how many transforms each rigor level needs to amortize it
+    if (average_forward_dft_exec_time_us + average_backward_dft_exec_time_us > 0)
+        printf("    Planning cost: %0.1f forward + backward executions\n", (forward_plan_time_us + backward_plan_time_us) /
+               (average_forward_dft_exec_time_us + average_backward_dft_exec_time_us));
+
+#ifdef FFTW3
+    work_pool_destroy(options.work_pool);
+#endif
+
+    // The results are saved either way, but a failed accuracy check fails the run
+    if (accuracy_passed == false){
+        fprintf(stderr, "Accuracy check failed: errors exceed the tolerance of %0.3e. Check the FFTW build.\n", accuracy_tolerance);
+        return 1;
+    }
 
     return 0;
 }
 
-void fill_row(double *cosine, double fs, int row_length, int start_idx, int n_sum, int matrix_size){
-/* Helper function to fill a row of data in an N-dimensional cosine matrix
+int parse_options(int argc, char *argv[], BenchmarkOptions *options){
+/* Parses the optional "--name value" flags, which may appear anywhere on the command line, and
+ * removes them from argv so that the positional arguments can be parsed as usual
  *
  * Inputs
  * ======
- *   double *cosine
- *       The array to be filled with cosine data
- *
- *   int fs
- *       Sample size for the cosine
- *
- *   int row_length
- *       Length of the dimension (AKA the length of the row to fill)
+ *   int argc, char *argv[]
+ *       Command line arguments
  *
- *   int start_idx
- *       Index of the cosine array to start filling
+ *   BenchmarkOptions *options
+ *       Holds the parsed options (or their defaults)
  *
- *   int n_sum
- *       Sum of all the values in n
- *
- *   int matrix_size
- *       Total number of samples in the "cosine" matrix across all dimensions (i.e., n0*n1*n2*...*nK)
+ * Returns
+ * =======
+ *   int argc
+ *       Number of arguments left in argv
  */
-    if (start_idx < matrix_size){
-        int i; //iterative var
-        for (i=0; i<row_length; i++){
-            cosine[i+start_idx] = cos((i+start_idx)*fs*PI);
+    int i, num_args = 1;
+    char *pEnd;
+#ifdef FFTW3
+    char embed_list[BUFFSIZE];
+#endif
+
+    options->rigor = DEFAULT_RIGOR;
+    options->plan_timelimit = TIMELIMIT;
+    options->wisdom_dir = NULL;
+    options->threads_backend = DEFAULT_THREADS_BACKEND;
+    options->work_pool = NULL;
+    options->busy_openmp_threads = 0;
+    options->precision = DEFAULT_PRECISION;
+    options->signal = DEFAULT_SIGNAL;
+    options->input_cache_dir = NULL;
+    options->in_place = false;
+    options->batch = 1;
+    options->batch_stride = 1;
+    options->batch_dist = 0;
+    options->num_embed = 0;
+    options->transpose = false;
+    options->num_r2r_kinds = 0;
+    options->sweep = NULL;
+    options->production_sizes = NULL;
+    options->accuracy_tolerance = DEFAULT_ACCURACY_TOLERANCE;
+
+    for (i=1; i<argc; i++){
+        if ((strcmp(argv[i], "--rigor") == 0 || strcmp(argv[i], "--plan-timelimit") == 0 || strcmp(argv[i], "--wisdom-dir") == 0 ||
+             strcmp(argv[i], "--precision") == 0 || strcmp(argv[i], "--signal") == 0 || strcmp(argv[i], "--input-cache") == 0 ||
+             strcmp(argv[i], "--batch") == 0 || strcmp(argv[i], "--batch-stride") == 0 ||
+             strcmp(argv[i], "--batch-dist") == 0 || strcmp(argv[i], "--r2r") == 0 || strcmp(argv[i], "--sweep") == 0 ||
+             strcmp(argv[i], "--production-sizes") == 0 || strcmp(argv[i], "--accuracy-tolerance") == 0 || strcmp(argv[i], "--embed") == 0 ||
+             strcmp(argv[i], "--threads-backend") == 0 || strcmp(argv[i], "--busy-openmp") == 0) && i + 1 >= argc){
+            fprintf(stderr, "%s requires a value.\n", argv[i]);
+            exit(0);
+        }
+
+        if (strcmp(argv[i], "--rigor") == 0)
+            options->rigor = argv[++i];
+        else if (strcmp(argv[i], "--plan-timelimit") == 0){
+            options->plan_timelimit = strtod(argv[++i], &pEnd);
+            if (*pEnd != '\0'){
+                fprintf(stderr, "Invalid plan time limit '%s'. Please enter a number of seconds (or -1 for no limit).\n", argv[i]);
+                exit(0);
+            }
+        }
+        else if (strcmp(argv[i], "--accuracy-tolerance") == 0){
+            options->accuracy_tolerance = strtod(argv[++i], &pEnd);
+            if (*pEnd != '\0' || options->accuracy_tolerance <= 0){
+                fprintf(stderr, "Invalid accuracy tolerance '%s'. Please enter a positive number of machine epsilons.\n", argv[i]);
+                exit(0);
+            }
+        }
+        else if (strcmp(argv[i], "--precision") == 0)
+            options->precision = argv[++i];
+        else if (strcmp(argv[i], "--signal") == 0)
+            options->signal = argv[++i];
+        else if (strcmp(argv[i], "--input-cache") == 0)
+            options->input_cache_dir = argv[++i];
+        else if (strcmp(argv[i], "--in-place") == 0)
+            options->in_place = true;
+        else if (strcmp(argv[i], "--sweep") == 0)
+            options->sweep = argv[++i];
+        else if (strcmp(argv[i], "--production-sizes") == 0)
+            options->production_sizes = argv[++i];
+        else if (strcmp(argv[i], "--embed") == 0){
+#ifdef FFTW3
+            snprintf(embed_list, BUFFSIZE, "%s", argv[++i]);
+            options->num_embed = __parse_sizes(embed_list, NULL, 0);
+            if (options->num_embed < 1 || options->num_embed > MAX_RANK){
+                fprintf(stderr, "Invalid value '%s' for --embed. Please enter the dimensions of the array, e.g. \"512,512\".\n", argv[i]);
+                exit(0);
+            }
+            snprintf(embed_list, BUFFSIZE, "%s", argv[i]);
+            __parse_sizes(embed_list, options->embed, 0);
+#else
+            fprintf(stderr, "--embed requires FFTW3.\n");
+            exit(0);
+#endif
+        }
+        else if (strcmp(argv[i], "--transpose") == 0){
+#ifdef FFTW3
+            options->transpose = true;
+#else
+            fprintf(stderr, "--transpose requires FFTW3.\n");
+            exit(0);
+#endif
+        }
+        else if (strcmp(argv[i], "--r2r") == 0){
+#ifdef FFTW3
+            parse_r2r_kinds(argv[++i], options);
+#else
+            fprintf(stderr, "--r2r requires FFTW3.\n");
+            exit(0);
+#endif
+        }
+        else if (strcmp(argv[i], "--batch") == 0 || strcmp(argv[i], "--batch-stride") == 0 || strcmp(argv[i], "--batch-dist") == 0){
+#ifdef FFTW3
+            if (strcmp(argv[i], "--batch") == 0)
+                options->batch = (int)strtol(argv[i+1], &pEnd, 10);
+            else if (strcmp(argv[i], "--batch-stride") == 0)
+                options->batch_stride = (int)strtol(argv[i+1], &pEnd, 10);
+            else
+                options->batch_dist = (int)strtol(argv[i+1], &pEnd, 10);
+            if (*pEnd != '\0' || strtol(argv[i+1], NULL, 10) < 1){
+                fprintf(stderr, "Invalid value '%s' for %s. Please enter a whole number greater than or equal to 1.\n", argv[i+1], argv[i]);
+                exit(0);
+            }
+            i++;
+#else
+            fprintf(stderr, "%s requires FFTW3.\n", argv[i]);
+            exit(0);
+#endif
+        }
+        else if (strcmp(argv[i], "--wisdom-dir") == 0){
+#ifdef FFTW3
+            options->wisdom_dir = argv[++i];
+#else
+            fprintf(stderr, "--wisdom-dir requires FFTW3.\n");
+            exit(0);
+#endif
+        }
+        else if (strcmp(argv[i], "--threads-backend") == 0){
+#ifdef FFTW3
+            options->threads_backend = argv[++i];
+            if (strcmp(options->threads_backend, "pthreads") != 0 && strcmp(options->threads_backend, "openmp") != 0 &&
+                strcmp(options->threads_backend, "work-stealing") != 0){
+                fprintf(stderr, "Invalid threads backend '%s'. Please use \"pthreads\", \"openmp\" or \"work-stealing\".\n",
+                        options->threads_backend);
+                exit(0);
+            }
+#else
+            fprintf(stderr, "--threads-backend requires FFTW3.\n");
+            exit(0);
+#endif
+        }
+        else if (strcmp(argv[i], "--busy-openmp") == 0){
+#ifdef FFTW3
+            options->busy_openmp_threads = (int)strtol(argv[++i], &pEnd, 10);
+            if (*pEnd != '\0' || strtol(argv[i], NULL, 10) < 1){
+                fprintf(stderr, "Invalid value '%s' for --busy-openmp. Please enter a whole number greater than or equal to 1.\n", argv[i]);
+                exit(0);
+            }
+#else
+            fprintf(stderr, "--busy-openmp requires FFTW3.\n");
+            exit(0);
+#endif
         }
+        else
+            argv[num_args++] = argv[i];
+    }
+
+    // Map the planner rigor to FFTW flags. FFTW2 only knows FFTW_ESTIMATE and FFTW_MEASURE.
+    if (strcmp(options->rigor, "estimate") == 0)
+        options->plan_flags = FFTW_ESTIMATE;
+    else if (strcmp(options->rigor, "measure") == 0)
+        options->plan_flags = FFTW_MEASURE;
+#ifdef FFTW3
+    else if (strcmp(options->rigor, "patient") == 0)
+        options->plan_flags = FFTW_PATIENT;
+    else if (strcmp(options->rigor, "exhaustive") == 0)
+        options->plan_flags = FFTW_EXHAUSTIVE;
+    else{
+        fprintf(stderr, "Invalid rigor '%s'. Please use \"estimate\", \"measure\", \"patient\", or \"exhaustive\".\n", options->rigor);
+        exit(0);
+    }
+#else
+    else{
+        fprintf(stderr, "Invalid rigor '%s'. FFTW2 supports \"estimate\" and \"measure\".\n", options->rigor);
+        exit(0);
+    }
+#endif
+
+    if (options->production_sizes != NULL && options->sweep == NULL){
+        fprintf(stderr, "--production-sizes requires --sweep.\n");
+        exit(0);
+    }
+    if (options->sweep != NULL && options->num_r2r_kinds > 0){
+        fprintf(stderr, "--r2r cannot be used with --sweep.\n");
+        exit(0);
+    }
+
+    // In place, the padded layout fixes the stride and distance of each transform
+    if (options->in_place && (options->batch_stride != 1 || options->batch_dist != 0)){
+        fprintf(stderr, "--batch-stride and --batch-dist cannot be used with --in-place.\n");
+        exit(0);
+    }
+    if (options->in_place && (options->num_embed > 0 || options->transpose)){
+        fprintf(stderr, "--embed and --transpose cannot be used with --in-place.\n");
+        exit(0);
+    }
+    if (options->sweep != NULL && options->num_embed > 0){
+        fprintf(stderr, "--embed cannot be used with --sweep.\n");
+        exit(0);
+    }
 
-        fill_row(cosine, fs, row_length, start_idx+n_sum, n_sum, matrix_size);
+    if (find_precision(options->precision) == NULL){
+        fprintf(stderr, "Precision '%s' is not available in this build. Available precisions:", options->precision);
+        for (i=0; i<NUM_PRECISIONS; i++)
+            fprintf(stderr, " \"%s\"", PRECISIONS[i].name);
+        fprintf(stderr, ". Rebuild with -DFFTW3_FLOAT, -DFFTW3_LONG_DOUBLE or -DFFTW3_QUAD for the others.\n");
+        exit(0);
+    }
+    if (find_signal(options->signal) == NULL){
+        fprintf(stderr, "Invalid signal '%s'. Please use", options->signal);
+        for (i=0; i<NUM_SIGNALS; i++)
+            fprintf(stderr, "%s \"%s\"", (i == 0) ? "" : (i < NUM_SIGNALS - 1) ? "," : ", or", SIGNALS[i].name);
+        fprintf(stderr, ".\n");
+        exit(0);
     }
+
+    argv[num_args] = NULL;
+    return num_args;
 }
 
-void generate_cosine_data(double *cosine, double fs, int rank, int *n, int matrix_size){
-/* Generates data for a forward FFT
+#ifdef FFTW3
+void parse_r2r_kinds(char *kind_list, BenchmarkOptions *options){
+/* Parses a comma separated list of real-to-real kinds (e.g. "REDFT10,RODFT10"), or "all"
  *
  * Inputs
  * ======
- *   double *cosine
- *       The array to be filled with cosine data
- *
- *   int fs
- *       Sample size for the cosine
- *
- *   int rank
- *       Number of dimensions in the data array
- *
- *   int *n
- *       An array which contains the dimensions of the data array
+ *   char *kind_list
+ *       The list of kinds, which is modified while parsing
  *
- *   int matrix_size
- *       Total number of samples in the "cosine" matrix across all dimensions (i.e., n0*n1*n2*...*nK)
+ *   BenchmarkOptions *options
+ *       Holds the kinds
  */
+    int i;
+    char *kind_name;
 
-    // Init values
-    int i; //iterative value
-    int start = 0; //start of the next dimension
-    int prev = 0; //start of the previous dimension
-    int dim; //current dimension
-    int n_sum = 0; //sum of all the dimensions
-
-    // Get the sum of all N values. This will help us with indexing the cosine matrix when we go to
-    // fill it with data
-    for (i=0; i<rank; i++){
-        n_sum += n[i];
+    options->num_r2r_kinds = 0;
+    if (strcmp(kind_list, "all") == 0){
+        for (i=0; i<NUM_R2R_KINDS; i++)
+            options->r2r_kinds[options->num_r2r_kinds++] = &R2R_KINDS[i];
+        return;
     }
 
-    // Fill cosine array
-    for (i=0; i<rank; i++){
-
-        // Get current dimension
-        dim = n[i];
-
-        // Get starting point
-        start += prev;
+    for (kind_name = strtok(kind_list, ","); kind_name != NULL; kind_name = strtok(NULL, ",")){
+        for (i=0; i<NUM_R2R_KINDS && strcmp(R2R_KINDS[i].name, kind_name) != 0; i++)
+            ;
+        if (i == NUM_R2R_KINDS){
+            fprintf(stderr, "Invalid real-to-real kind '%s'. Please use \"all\" or a list of \"REDFT00\", \"REDFT10\", \"REDFT01\", \"REDFT11\", "
+                            "\"RODFT00\", \"RODFT10\", \"RODFT01\", or \"RODFT11\".\n", kind_name);
+            exit(0);
+        }
+        if (options->num_r2r_kinds < NUM_R2R_KINDS)
+            options->r2r_kinds[options->num_r2r_kinds++] = &R2R_KINDS[i];
+    }
+}
+#endif
 
-        // Fill array
-        fill_row(cosine, fs, dim, start, n_sum, matrix_size);
+const Precision *find_precision(const char *name){
+/* Finds a precision built into this benchmark by name (NULL if there is none) */
+    int i;
 
-        // Update 'prev'
-        prev = dim;
+    for (i=0; i<NUM_PRECISIONS; i++){
+        if (strcmp(PRECISIONS[i].name, name) == 0)
+            return &PRECISIONS[i];
     }
+    return NULL;
 }
 
-void plot1D(double *cosine, int dim_to_plot, int rank, int *n, double fs, char *title){
+ptrdiff_t complex_size(int rank, int *n, ptrdiff_t n_total){
+/* Gets the number of complex values in the output of a real-to-complex DFT
+ *
+ * Inputs
+ * ======
+ *   int rank, int *n, ptrdiff_t n_total
+ *       Rank, dimensions and total number of samples of the real input
+ */
+
+    // For a complex transform, we have n[0] x n[1] x n[2] x ... x (n[rank-1]/2 + 1). So, our math is
+    // as follows: n_total = n[0] x n[1] x n[2] x ... x n[rank-1]. Since n_total includes n[d-1], we have
+    // to divide n_total by n[rank-1] to get n_toral = n[0] x n[1] x n[2] x ... x n[rank-2]. Then we 
+    // multiply by n[rank-1] / 2 + 1
+    return (n_total / n[rank-1]) * (n[rank-1] / 2 + 1);
+}
+
+void phase_stats(PhaseStats *stats, const char *name, const double *times_us, int runs){
+/* Summarizes the times of one phase of a run
+ *
+ * Inputs
+ * ======
+ *   PhaseStats *stats
+ *       Holds the total, mean, min, max and (population) standard deviation of the times
+ *
+ *   const char *name
+ *       Name of the phase, as saved in the JSON file
+ *
+ *   const double *times_us, int runs
+ *       Time of each run of the phase in us, and number of runs
+ */
+    int i;
+    double diff_us, squared_diff_total = 0.0;
+
+    stats->name = name;
+    stats->runs = runs;
+    stats->total_us = 0.0;
+    stats->min_us = times_us[0];
+    stats->max_us = times_us[0];
+    for (i=0; i<runs; i++){
+        stats->total_us += times_us[i];
+        if (times_us[i] < stats->min_us)
+            stats->min_us = times_us[i];
+        if (times_us[i] > stats->max_us)
+            stats->max_us = times_us[i];
+    }
+    stats->mean_us = stats->total_us / runs;
+
+    for (i=0; i<runs; i++){
+        diff_us = times_us[i] - stats->mean_us;
+        squared_diff_total += diff_us * diff_us;
+    }
+    stats->stdev_us = sqrt(squared_diff_total / runs);
+}
+
+void batch_layout(int rank, int *n, ptrdiff_t n_total, BenchmarkOptions *options, BatchLayout *layout){
+/* Lays out the batch of transforms in the real and complex arrays. Transforms either follow each
+ * other ("blocked": dist >= the size of a transform x stride), or are interleaved ("interleaved":
+ * stride >= howmany x dist), like a matrix whose columns are the transforms. The complex array has
+ * the same stride, and is blocked or interleaved like the real array.
+ *
+ * Inputs
+ * ======
+ *   int rank, int *n, ptrdiff_t n_total
+ *       Rank, dimensions and total number of samples of each transform
+ *
+ *   BenchmarkOptions *options
+ *       Holds the batch size, stride and distance, and whether to transform in place
+ *
+ *   BatchLayout *layout
+ *       Holds the layout
+ */
+    int i;
+    ptrdiff_t n_complex_total = complex_size(rank, n, n_total);
+
+    layout->rank = rank;
+    layout->n = n;
+    layout->row_length = n[rank-1];
+    layout->real_row_length = options->in_place ? 2 * (n[rank-1] / 2 + 1) : n[rank-1];
+
+    // Each transform is a window of an array of dimensions 'real_embed': the transform itself, with
+    // the last dimension padded in place, unless --embed gives a larger array
+    for (i=0; i<rank; i++)
+        layout->real_embed[i] = (options->num_embed > 0) ? options->embed[i] : n[i];
+    if (options->num_embed == 0)
+        layout->real_embed[rank-1] = layout->real_row_length;
+    layout->transposed = options->transpose;
+    layout->whole = (options->num_embed == 0 && options->transpose == false);
+    layout->strided = (layout->whole == false || options->batch_stride != 1);
+
+    // Number of reals in one transform's array, counting the padding
+    ptrdiff_t real_total = 1;
+    for (i=0; i<rank; i++)
+        real_total *= layout->real_embed[i];
+
+    layout->howmany = options->batch;
+    layout->real_stride = options->batch_stride;
+    layout->complex_stride = options->batch_stride;
+    layout->real_dist = (options->batch_dist > 0) ? options->batch_dist : real_total * options->batch_stride;
+
+    if (layout->real_dist >= real_total * layout->real_stride)
+        layout->complex_dist = n_complex_total * layout->complex_stride;
+    else if (layout->real_stride >= layout->howmany * layout->real_dist)
+        layout->complex_dist = layout->real_dist;
+    else{
+        fprintf(stderr, "The transforms of the batch overlap. Use --batch-dist >= %td (one transform after another), or --batch-stride >= %td (interleaved).\n",
+                real_total * layout->real_stride, layout->howmany * layout->real_dist);
+        exit(0);
+    }
+
+    // Strides of each dimension of a transform. The real array is row-major over 'real_embed', or
+    // column-major if transposed. The complex array is always row-major, and its last dimension
+    // holds n[rank-1]/2 + 1 values.
+    if (layout->transposed){
+        layout->real_strides[0] = layout->real_stride;
+        for (i=1; i<rank; i++)
+            layout->real_strides[i] = layout->real_strides[i-1] * layout->real_embed[i-1];
+    }
+    else{
+        layout->real_strides[rank-1] = layout->real_stride;
+        for (i=rank-2; i>=0; i--)
+            layout->real_strides[i] = layout->real_strides[i+1] * layout->real_embed[i+1];
+    }
+    layout->complex_strides[rank-1] = layout->complex_stride;
+    for (i=rank-2; i>=0; i--)
+        layout->complex_strides[i] = layout->complex_strides[i+1] * ((i + 1 == rank - 1) ? n[rank-1] / 2 + 1 : n[i+1]);
+
+    layout->real_size = (size_t)(layout->howmany - 1) * layout->real_dist + (size_t)(real_total - 1) * layout->real_stride + 1;
+    layout->complex_size = (size_t)(layout->howmany - 1) * layout->complex_dist + (size_t)(n_complex_total - 1) * layout->complex_stride + 1;
+}
+
+#ifndef FFTW3
+void run_dft_fftw2(const double *cosine, int rank, int *n, ptrdiff_t n_total, int nthreads, int niters, BenchmarkOptions *options, DFTBenchmarkResults *results){
+/* Runs the forward and backward DFTs of a cosine with FFTW2 (double precision only). See
+ * cosine_dft_precision.h for the FFTW3 version.
+ *
+ * Inputs
+ * ======
+ *   const double *cosine
+ *       The cosine data
+ *
+ *   int rank, int *n, ptrdiff_t n_total
+ *       Rank, dimensions and total number of samples of the cosine
+ *
+ *   int nthreads, int niters
+ *       Number of threads to use and number of iterations to execute
+ *
+ *   BenchmarkOptions *options
+ *       Planner rigor, and whether to transform in place
+ *
+ *   DFTBenchmarkResults *results
+ *       Holds the plan and execution times, the normalized round trip (if 'cosine_back' is not
+ *       NULL), its error, and the size of the DFT buffers
+ */
+    int i, j, row;
+    struct timeval plan_start, plan_stop;
+    struct timeval forward_dft_start, forward_dft_stop;
+    struct timeval backward_dft_start, backward_dft_stop;
+    struct timeval phase_start, phase_stop;
+    double forward_dft_execution_time_us, backward_dft_execution_time_us;
+    int plan_flags = options->plan_flags;
+
+    // In place, each row of the last dimension is padded to 2 x (n[rank-1]/2 + 1) reals, as in FFTW3
+    int row_length = n[rank-1];
+    int real_row_length = options->in_place ? 2 * (row_length / 2 + 1) : row_length;
+
+    // FFTW2 indexes its arrays with ints (FFTW3 plans through the guru64 interface, which doesn't)
+    if ((n_total / row_length) * real_row_length > INT_MAX){
+        fprintf(stderr, "FFTW2 can't transform more than %d samples. Use FFTW3 for larger transforms.\n", INT_MAX);
+        exit(0);
+    }
+    int num_rows = (int)(n_total / row_length);
+    int n_complex_total = (int)complex_size(rank, n, n_total);
+
+    // Set threading
+    fftw_init_threads();
+
+    // Initialize real-to-complex cosine input and output, and the cosine that will be returned from
+    // the complex DFT. In place, all three are the same (padded) array, and FFTW2 takes a NULL output.
+    double *cosine_original, *cosine_back;
+    fftw_complex *cosine_complex = (fftw_complex*)fftw_malloc(n_complex_total * sizeof(fftw_complex));
+    fftw_complex *cosine_complex_out = cosine_complex;
+    double *cosine_back_out;
+    if (options->in_place){
+        plan_flags |= FFTW_IN_PLACE;
+        cosine_original = (double*)cosine_complex;
+        cosine_back = (double*)cosine_complex;
+        cosine_complex_out = NULL;
+        cosine_back_out = NULL;
+        results->dft_buffer_bytes = (size_t)n_complex_total * sizeof(fftw_complex);
+    }
+    else{
+        cosine_original = (double*)fftw_malloc(n_total * sizeof(double));
+        cosine_back = (double*)fftw_malloc(n_total * sizeof(double));
+        cosine_back_out = cosine_back;
+        results->dft_buffer_bytes = (size_t)n_complex_total * sizeof(fftw_complex) + 2 * (size_t)n_total * sizeof(double);
+    }
+
+    // We'll need to do work on a dummy array to prevent the compiler from optimizing the loop
+    int dummy[niters];
+    int rand_idx; //random index
+    int max_idx = (int)n_total - 1; //max index of the cosine array (matrix)
+
+    // Create FFTW plans once, before iterating, and time the planning separately from the transforms
+    gettimeofday(&plan_start, NULL);
+    rfftwnd_plan forward_cos_dft_plan = rfftwnd_create_plan(rank, n, FFTW_REAL_TO_COMPLEX, plan_flags);
+    gettimeofday(&plan_stop, NULL);
+    results->forward_plan_time_us = (plan_stop.tv_sec - plan_start.tv_sec) * (1e6) + (plan_stop.tv_usec - plan_start.tv_usec);
+
+    gettimeofday(&plan_start, NULL);
+    rfftwnd_plan backward_cos_dft_plan = rfftwnd_create_plan(rank, n, FFTW_COMPLEX_TO_REAL, plan_flags);
+    gettimeofday(&plan_stop, NULL);
+    results->backward_plan_time_us = (plan_stop.tv_sec - plan_start.tv_sec) * (1e6) + (plan_stop.tv_usec - plan_start.tv_usec);
+
+    // Iterate
+    for (j=0; j<niters; j++){
+        // Fill input cosine array
+        gettimeofday(&phase_start, NULL);
+        for (row=0; row<num_rows; row++){
+            for (i=0; i<row_length; i++)
+                cosine_original[row * real_row_length + i] = cosine[row * row_length + i];
+        }
+        gettimeofday(&phase_stop, NULL);
+        results->copy_in_times_us[j] = (phase_stop.tv_sec - phase_start.tv_sec) * (1e6) + (phase_stop.tv_usec - phase_start.tv_usec);
+
+        // Execute Forward DFT and capture performance time
+        gettimeofday(&forward_dft_start, NULL); //start clock
+        rfftwnd_threads_one_real_to_complex(nthreads, forward_cos_dft_plan, cosine_original, cosine_complex_out);
+        gettimeofday(&forward_dft_stop, NULL); //stop clock
+        forward_dft_execution_time_us = (forward_dft_stop.tv_sec - forward_dft_start.tv_sec) * (1e6); //sec to us
+        forward_dft_execution_time_us += (forward_dft_stop.tv_usec - forward_dft_start.tv_usec);
+        results->total_f_dft_exec_time_us += forward_dft_execution_time_us;
+        results->fft_performance_times_us[j] = forward_dft_execution_time_us;
+
+        // Execute Backward DFT and capture performance time
+        gettimeofday(&backward_dft_start, NULL); //start clock
+        rfftwnd_threads_one_complex_to_real(nthreads, backward_cos_dft_plan, cosine_complex, cosine_back_out);
+        gettimeofday(&backward_dft_stop, NULL); //stop clock
+        backward_dft_execution_time_us = (backward_dft_stop.tv_sec - backward_dft_start.tv_sec) * (1e6);// sec to us
+        backward_dft_execution_time_us += (backward_dft_stop.tv_usec - backward_dft_start.tv_usec);
+        results->total_b_dft_exec_time_us += backward_dft_execution_time_us;
+        results->ifft_performance_times_us[j] = backward_dft_execution_time_us;
+
+        // Do work on dummy array to prevent the compiler from optimizing on its own
+        rand_idx = rand() % (max_idx + 1);
+        dummy[j] = j + cosine_back[(rand_idx / row_length) * real_row_length + rand_idx % row_length];
+
+        // Fix cosine_back because its height has been adjusted by the FFT
+        gettimeofday(&phase_start, NULL);
+        for (row=0; row<num_rows; row++){
+            for (i=0; i<row_length; i++)
+                cosine_back[row * real_row_length + i] /= n_total;
+        }
+        gettimeofday(&phase_stop, NULL);
+        results->normalize_times_us[j] = (phase_stop.tv_sec - phase_start.tv_sec) * (1e6) + (phase_stop.tv_usec - phase_start.tv_usec);
+    }
+
+    // Compare the (normalized) round trip with the input
+    long double squared_error_total = 0.0L, squared_cosine_total = 0.0L, error;
+    long double max_abs_error = 0.0L, max_abs_cosine = 0.0L;
+    double *back;
+    for (row=0; row<num_rows; row++){
+        back = cosine_back + row * real_row_length;
+        for (i=0; i<row_length; i++){
+            error = (long double)back[i] - (long double)cosine[row * row_length + i];
+            squared_error_total += error * error;
+            squared_cosine_total += (long double)cosine[row * row_length + i] * (long double)cosine[row * row_length + i];
+            if (fabsl(error) > max_abs_error)
+                max_abs_error = fabsl(error);
+            if (fabsl((long double)cosine[row * row_length + i]) > max_abs_cosine)
+                max_abs_cosine = fabsl((long double)cosine[row * row_length + i]);
+            if (results->cosine_back != NULL)
+                results->cosine_back[row * row_length + i] = back[i];
+        }
+    }
+    results->round_trip_error = (squared_cosine_total > 0) ? (double)sqrtl(squared_error_total / squared_cosine_total) : 0.0;
+    results->round_trip_linf_error = (max_abs_cosine > 0) ? (double)(max_abs_error / max_abs_cosine) : 0.0;
+    results->machine_epsilon = DBL_EPSILON;
+
+    // Check the forward plan against a cosine of k0 = n[rank-1]/4 periods along the last dimension,
+    // whose spectrum is n_total/2 at bin k0 (n_total if k0 is 0) and 0 everywhere else
+    int k, k0 = row_length / 4;
+    double peak = (k0 == 0) ? (double)n_total : n_total / 2.0;
+    long double max_spectrum_error = 0.0L;
+    for (row=0; row<num_rows; row++){
+        for (i=0; i<row_length; i++)
+            cosine_original[row * real_row_length + i] = (double)cosl(2 * acosl(-1.0L) * (int)(((long)k0 * i) % row_length) / row_length);
+    }
+    rfftwnd_threads_one_real_to_complex(nthreads, forward_cos_dft_plan, cosine_original, cosine_complex_out);
+    for (k=0; k<n_complex_total; k++){
+        error = hypotl((long double)cosine_complex[k].re - ((k == k0) ? peak : 0.0), (long double)cosine_complex[k].im);
+        if (error > max_spectrum_error)
+            max_spectrum_error = error;
+    }
+    results->spectrum_error = (double)(max_spectrum_error / peak);
+
+    // Destroy FFTW plans
+    gettimeofday(&phase_start, NULL);
+    fftw_destroy_plan(forward_cos_dft_plan);
+    fftw_destroy_plan(backward_cos_dft_plan);
+    gettimeofday(&phase_stop, NULL);
+    results->destroy_time_us = (phase_stop.tv_sec - phase_start.tv_sec) * (1e6) + (phase_stop.tv_usec - phase_start.tv_usec);
+
+    //Now put 'dummy' to use so that the compiler doesn't get rid of it
+    results->dummy = dummy[0];
+
+    // Free memory
+    if (options->in_place == false){
+        fftw_free(cosine_original);
+        fftw_free(cosine_back);
+    }
+    fftw_free(cosine_complex);
+}
+#endif
+
+void describe_problem(char *problem, const char *kind, int rank, int *n, int nthreads, BenchmarkOptions *options){
+/* Describes a planned transform, e.g. "r2c rank=2 dims=300x300 threads=4 rigor=measure timelimit=2"
+ * (with " in-place" appended for in-place transforms, and " backend=openmp" for the OpenMP backend),
+ * so that the wisdom cache can tell how long the same problem took to plan from scratch
+ *
+ * Inputs
+ * ======
+ *   char *problem
+ *       Holds the description (at least MAX_PROBLEM_DESCRIPTION_LEN chars)
+ *
+ *   const char *kind
+ *       Kind of transform ("r2c" or "c2r")
+ *
+ *   int rank, int *n
+ *       Rank and dimensions of the transform
+ *
+ *   int nthreads
+ *       Number of threads the transform was planned with
+ *
+ *   BenchmarkOptions *options
+ *       Holds the planner rigor, time limit, threads backend, and whether the transform is in place
+ */
+    int i;
+    int len = snprintf(problem, MAX_PROBLEM_DESCRIPTION_LEN, "%s rank=%d dims=%d", kind, rank, n[0]);
+
+    for (i=1; i<rank && len < MAX_PROBLEM_DESCRIPTION_LEN; i++)
+        len += snprintf(problem + len, MAX_PROBLEM_DESCRIPTION_LEN - len, "x%d", n[i]);
+    if (len < MAX_PROBLEM_DESCRIPTION_LEN)
+        snprintf(problem + len, MAX_PROBLEM_DESCRIPTION_LEN - len, " threads=%d rigor=%s timelimit=%g%s%s%s", nthreads, options->rigor, options->plan_timelimit,
+                 options->in_place ? " in-place" : "", (strcmp(options->threads_backend, DEFAULT_THREADS_BACKEND) != 0) ? " backend=" : "",
+                 (strcmp(options->threads_backend, DEFAULT_THREADS_BACKEND) != 0) ? options->threads_backend : "");
+}
+
+int __compare_ints(const void *a, const void *b){
+    return (*(const int*)a > *(const int*)b) - (*(const int*)a < *(const int*)b);
+}
+
+int __parse_sizes(char *size_list, int *sizes, int num_sizes){
+/* Appends the comma separated sizes in 'size_list' to 'sizes' (if it is not NULL), and returns the
+ * new number of sizes (or -1 if a size is invalid) */
+    char *size, *pEnd;
+    long value;
+
+    for (size = strtok(size_list, ","); size != NULL; size = strtok(NULL, ",")){
+        value = strtol(size, &pEnd, 10);
+        if (*pEnd != '\0' || value < 1 || value > INT_MAX)
+            return -1;
+        if (sizes != NULL)
+            sizes[num_sizes] = (int)value;
+        num_sizes++;
+    }
+    return num_sizes;
+}
+
+int sweep_sizes(BenchmarkOptions *options, int **sizes){
+/* Lists the sizes of a sweep, in increasing order: every size from <min> to <max> ("<min>-<max>"),
+ * or every 7-smooth size (2^a 3^b 5^c 7^d, which FFTW has codelets for) from 2 to <max>
+ * ("smooth:<max>"), plus the production sizes
+ *
+ * Inputs
+ * ======
+ *   BenchmarkOptions *options
+ *       Holds the sweep and the production sizes
+ *
+ *   int **sizes
+ *       Holds the (allocated) sizes
+ *
+ * Returns
+ * =======
+ *   int num_sizes
+ *       Number of sizes, or -1 if the sweep or the production sizes are invalid
+ */
+    long min, max, size, factor;
+    int i, num_sizes = 0, num_production_sizes = 0;
+    bool smooth = (strncmp(options->sweep, "smooth:", 7) == 0);
+    char *pEnd;
+    char production_sizes[BUFFSIZE] = {'\0'};
+    const int primes[] = {2, 3, 5, 7};
+
+    if (smooth){
+        min = 2;
+        max = strtol(options->sweep + 7, &pEnd, 10);
+    }
+    else{
+        min = strtol(options->sweep, &pEnd, 10);
+        if (*pEnd != '-')
+            return -1;
+        max = strtol(pEnd + 1, &pEnd, 10);
+    }
+    if (*pEnd != '\0' || min < 1 || max < min || max > INT_MAX)
+        return -1;
+
+    // Production sizes are counted first, since strtok modifies the list
+    if (options->production_sizes != NULL){
+        snprintf(production_sizes, BUFFSIZE, "%s", options->production_sizes);
+        num_production_sizes = __parse_sizes(production_sizes, NULL, 0);
+        if (num_production_sizes < 0)
+            return -1;
+    }
+
+    *sizes = (int*)malloc((max - min + 1 + num_production_sizes) * sizeof(int));
+    for (size=min; size<=max; size++){
+        if (smooth){
+            factor = size;
+            for (i=0; i<4; i++){
+                while (factor % primes[i] == 0)
+                    factor /= primes[i];
+            }
+            if (factor != 1)
+                continue;
+        }
+        (*sizes)[num_sizes++] = (int)size;
+    }
+
+    if (options->production_sizes != NULL){
+        snprintf(production_sizes, BUFFSIZE, "%s", options->production_sizes);
+        num_sizes = __parse_sizes(production_sizes, *sizes, num_sizes);
+    }
+    if (num_sizes == 0)
+        return 0;
+
+    // Sort, and drop the production sizes which are already in the sweep
+    qsort(*sizes, num_sizes, sizeof(int), __compare_ints);
+    for (i=1, size=1; i<num_sizes; i++){
+        if ((*sizes)[i] != (*sizes)[size-1])
+            (*sizes)[size++] = (*sizes)[i];
+    }
+    return (int)size;
+}
+
+void run_sweep(char *filename, bool plot, double fs, int nthreads, int niters, int rank, int *n, BenchmarkOptions *options){
+/* Runs the forward and backward DFTs for every size of the last dimension in a sweep, flags the
+ * sizes whose FFTW mflops fall off a cliff compared with their neighbors, and recommends the
+ * nearest faster padded size for each production size. The curve is saved to its own JSON document.
+ *
+ * Inputs
+ * ======
+ *   char *filename
+ *       JSON document to save the sweep to (which must not exist yet)
+ *
+ *   bool plot
+ *       Whether to plot GFlops against size
+ *
+ *   double fs, int nthreads, int niters, int rank, int *n
+ *       Sampling frequency, number of threads and iterations, rank, and dimensions (the last of
+ *       which is swept)
+ *
+ *   BenchmarkOptions *options
+ *       Holds the sweep, the production sizes, and the options of every run
+ */
+    int *sizes;
+    int i, j, k, num_neighbors, num_cliffs = 0;
+    ptrdiff_t n_total;
+    int production_size, num_production_sizes = 0;
+    double neighbor_mflops[2 * CLIFF_WINDOW];
+    double median, speedup;
+    char production_sizes[BUFFSIZE] = {'\0'};
+    char *size;
+
+    if (access(filename, F_OK) != -1){
+        fprintf(stderr, "'%s' already exists. A sweep is saved to a new JSON document.\n", filename);
+        exit(0);
+    }
+
+    int num_sizes = sweep_sizes(options, &sizes);
+    if (num_sizes <= 0){
+        fprintf(stderr, "Invalid sweep '%s' or production sizes. Please use \"<min>-<max>\" or \"smooth:<max>\", and a comma separated list of sizes.\n", options->sweep);
+        exit(0);
+    }
+
+    double *forward_time_us = (double*)malloc(num_sizes * sizeof(double));
+    double *backward_time_us = (double*)malloc(num_sizes * sizeof(double));
+    double *gflops = (double*)malloc(num_sizes * sizeof(double));
+    double *fftw_mflops = (double*)malloc(num_sizes * sizeof(double));
+    bool *cliff = (bool*)calloc(num_sizes, sizeof(bool));
+
+    printf("Sweeping %d sizes of dimension %d\n", num_sizes, rank);
+    printf("%10s %16s %16s %10s %12s\n", "size", "forward (sec)", "backward (sec)", "GFlops", "FFTW Mflops");
+    for (k=0; k<num_sizes; k++){
+        n[rank-1] = sizes[k];
+        n_total = 1;
+        for (i=0; i<rank; i++)
+            n_total *= n[i];
+
+        InputData input;
+        load_input_data(&input, fs, rank, n, n_total, options, nthreads);
+
+        DFTBenchmarkResults results;
+        memset(&results, 0, sizeof(DFTBenchmarkResults));
+        results.fft_performance_times_us = malloc(niters * sizeof(double));
+        results.ifft_performance_times_us = malloc(niters * sizeof(double));
+        results.copy_in_times_us = malloc(niters * sizeof(double));
+        results.normalize_times_us = malloc(niters * sizeof(double));
+        results.cosine_back = NULL;
+        find_precision(options->precision)->run_dft(input.data, rank, n, n_total, nthreads, niters, options, &results);
+
+        // GFlops and FFTW mflops of the forward + backward round trip, counted as for a single run.
+        // Cliffs are found from the FFTW mflops, which scale the time by the nominal work of a size
+        // rather than by the operations of its plans, so that sizes whose plans take more operations
+        // (e.g. primes) are still flagged.
+        forward_time_us[k] = results.total_f_dft_exec_time_us / niters;
+        backward_time_us[k] = results.total_b_dft_exec_time_us / niters;
+        gflops[k] = (results.forward_flops + results.backward_flops) / (forward_time_us[k] + backward_time_us[k]) * (1e-3);
+        fftw_mflops[k] = 2 * 2.5 * (double)options->batch * n_total * log2(n_total) / (forward_time_us[k] + backward_time_us[k]);
+        printf("%10d %16.6f %16.6f %10.3f %12.1f\n", sizes[k], forward_time_us[k] * (1e-6), backward_time_us[k] * (1e-6), gflops[k], fftw_mflops[k]);
+
+        free(results.fft_performance_times_us);
+        free(results.ifft_performance_times_us);
+        free(results.copy_in_times_us);
+        free(results.normalize_times_us);
+        free_input_data(&input);
+    }
+
+    // A size is a cliff if its FFTW mflops are well below the median of the sizes around it
+    for (k=0; k<num_sizes; k++){
+        num_neighbors = 0;
+        for (j=k-CLIFF_WINDOW; j<=k+CLIFF_WINDOW; j++){
+            if (j >= 0 && j < num_sizes && j != k)
+                neighbor_mflops[num_neighbors++] = fftw_mflops[j];
+        }
+        if (num_neighbors == 0)
+            continue;
+
+        // Insertion sort (there are at most 2 x CLIFF_WINDOW neighbors)
+        for (i=1; i<num_neighbors; i++){
+            for (j=i; j>0 && neighbor_mflops[j-1] > neighbor_mflops[j]; j--){
+                median = neighbor_mflops[j];
+                neighbor_mflops[j] = neighbor_mflops[j-1];
+                neighbor_mflops[j-1] = median;
+            }
+        }
+        median = (num_neighbors % 2 == 1) ? neighbor_mflops[num_neighbors/2] : 0.5 * (neighbor_mflops[num_neighbors/2 - 1] + neighbor_mflops[num_neighbors/2]);
+        cliff[k] = fftw_mflops[k] < CLIFF_FRACTION * median;
+    }
+
+    // Save the curve
+    FILE *sweep_file = fopen(filename, "w");
+    fprintf(sweep_file, "{\n");
+    fprintf(sweep_file, "    \"inputs\": {\n");
+    fprintf(sweep_file, "        \"rank\": %d,\n", rank);
+    fprintf(sweep_file, "        \"fixed_dims\": [");
+    for (i=0; i<rank-1; i++)
+        fprintf(sweep_file, "%s %d", (i == 0) ? "" : ",", n[i]);
+    fprintf(sweep_file, "],\n");
+    fprintf(sweep_file, "        \"sweep\": \"%s\",\n", options->sweep);
+    fprintf(sweep_file, "        \"fs_Hz\": %0.2e,\n", fs);
+    fprintf(sweep_file, "        \"iterations\": %d,\n", niters);
+    fprintf(sweep_file, "        \"threads\": %d,\n", nthreads);
+    fprintf(sweep_file, "        \"threads_backend\": \"%s\",\n", options->threads_backend);
+    fprintf(sweep_file, "        \"busy_openmp_threads\": %d,\n", options->busy_openmp_threads);
+    fprintf(sweep_file, "        \"rigor\": \"%s\",\n", options->rigor);
+    fprintf(sweep_file, "        \"precision\": \"%s\",\n", options->precision);
+    fprintf(sweep_file, "        \"signal\": \"%s\",\n", options->signal);
+    fprintf(sweep_file, "        \"in_place\": %s,\n", options->in_place ? "true" : "false");
+    fprintf(sweep_file, "        \"howmany\": %d\n", options->batch);
+    fprintf(sweep_file, "    },\n");
+    fprintf(sweep_file, "    \"sizes\": [\n");
+    for (k=0; k<num_sizes; k++){
+        fprintf(sweep_file, "        {\"size\": %d, \"forward_seconds\": %0.9f, \"backward_seconds\": %0.9f, \"gflops\": %0.5f, \"fftw_mflops\": %0.3f, \"cliff\": %s}%s\n",
+                sizes[k], forward_time_us[k] * (1e-6), backward_time_us[k] * (1e-6), gflops[k], fftw_mflops[k], cliff[k] ? "true" : "false",
+                (k < num_sizes - 1) ? "," : "");
+    }
+    fprintf(sweep_file, "    ],\n");
+
+    printf("\nCliffs:");
+    for (k=0; k<num_sizes; k++){
+        if (cliff[k]){
+            printf(" %d", sizes[k]);
+            num_cliffs++;
+        }
+    }
+    printf("%s\n", (num_cliffs == 0) ? " none" : "");
+
+    // For each production size, the size to pad to is the nearest larger size of the sweep whose
+    // round trip is faster (if there is one)
+    fprintf(sweep_file, "    \"recommendations\": [");
+    if (options->production_sizes != NULL){
+        snprintf(production_sizes, BUFFSIZE, "%s", options->production_sizes);
+        printf("Recommended padded sizes:\n");
+    }
+    for (size = (options->production_sizes != NULL) ? strtok(production_sizes, ",") : NULL; size != NULL; size = strtok(NULL, ",")){
+        production_size = (int)strtol(size, NULL, 10);
+        for (k=0; sizes[k] != production_size; k++)
+            ;
+        for (j=k+1; j<num_sizes && forward_time_us[j] + backward_time_us[j] >= forward_time_us[k] + backward_time_us[k]; j++)
+            ;
+
+        fprintf(sweep_file, "%s\n        {\"size\": %d, ", (num_production_sizes++ == 0) ? "" : ",", production_size);
+        if (j == num_sizes){
+            fprintf(sweep_file, "\"padded_size\": null, \"speedup\": 1.0}");
+            printf("    %d: no faster padded size in the sweep\n", production_size);
+        }
+        else{
+            speedup = (forward_time_us[k] + backward_time_us[k]) / (forward_time_us[j] + backward_time_us[j]);
+            fprintf(sweep_file, "\"padded_size\": %d, \"speedup\": %0.3f}", sizes[j], speedup);
+            printf("    %d -> %d (%0.2fx faster)\n", production_size, sizes[j], speedup);
+        }
+    }
+    fprintf(sweep_file, "%s]\n", (num_production_sizes > 0) ? "\n    " : "");
+    fprintf(sweep_file, "}\n");
+    fclose(sweep_file);
+
+    // Plot GFlops against size
+    if (plot == true){
+        FILE *sweep_data_file = fopen("sweep_data.txt", "w");
+        for (k=0; k<num_sizes; k++)
+            fprintf(sweep_data_file, "%d %lf \n", sizes[k], gflops[k]);
+        fclose(sweep_data_file);
+
+        FILE *gnuplot_pipe = popen("gnuplot -persistent", "w");
+        char *gnuplot_cmds[] = {"set title \"GFlops vs. Size\"", "set xlabel \"Size\"", "set ylabel \"GFlops\"",
+                                "set grid ytics lc rgb \"#bbbbbb\" lw 1 lt 0", "plot 'sweep_data.txt' with linespoints notitle"};
+        for (i=0; i<5; i++)
+            fprintf(gnuplot_pipe, "%s \n", gnuplot_cmds[i]);
+    }
+
+    free(sizes);
+    free(forward_time_us);
+    free(backward_time_us);
+    free(gflops);
+    free(fftw_mflops);
+    free(cliff);
+}
+
+static inline double __uniform(uint64_t key){
+/* Hashes 'key' to a number in [0, 1) (with the splitmix64 finalizer), so that every sample of a
+ * random signal can be generated on its own, in any thread, and comes out the same every run
+ */
+    uint64_t z = SIGNAL_SEED + (key + 1) * 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z ^= z >> 31;
+    return (z >> 11) * 0x1.0p-53;
+}
+
+static inline double __fraction(double x){
+/* Gets the fractional part of a (non-negative) number of cycles, to keep cosine arguments small */
+    return x - floor(x);
+}
+
+const Signal *find_signal(const char *name){
+/* Finds a signal by name (NULL if there is none) */
+    int i;
+
+    for (i=0; i<NUM_SIGNALS; i++){
+        if (strcmp(SIGNALS[i].name, name) == 0)
+            return &SIGNALS[i];
+    }
+    return NULL;
+}
+
+void init_tones(SignalGenerator *generator, double fs){
+/* Picks the tones of a cosine, multitone or sparse signal, and fills the table each tone's samples
+ * along a row are generated from
+ *
+ * Inputs
+ * ======
+ *   SignalGenerator *generator
+ *       The generator, whose signal, rank and dimensions are set
+ *
+ *   double fs
+ *       Sampling frequency of the cosine signal
+ */
+    int t, d, p;
+    int rank = generator->rank;
+    int *n = generator->n;
+    uint64_t key = 0;
+    double stride = 1.0;
+    Tone *tone;
+
+    switch (generator->signal->kind){
+        case SIGNAL_COSINE:
+            generator->num_tones = 1;
+            break;
+        case SIGNAL_MULTITONE:
+            generator->num_tones = NUM_TONES;
+            break;
+        case SIGNAL_SPARSE:
+            generator->num_tones = NUM_SPARSE_TONES;
+            break;
+        default:
+            generator->num_tones = 0;
+            return;
+    }
+    generator->tones = (Tone*)malloc(generator->num_tones * sizeof(Tone));
+
+    for (t=0; t<generator->num_tones; t++){
+        tone = &generator->tones[t];
+        if (generator->signal->kind == SIGNAL_COSINE){
+            // cos(pi x fs x i) over the flat index i = sum of c[d] x stride[d], i.e. fs/2 x stride[d]
+            // cycles per sample along each dimension
+            tone->amplitude = 1.0;
+            tone->phase = 0.0;
+            for (d=rank-1; d>=0; d--){
+                tone->freq[d] = fs / 2 * stride * n[d];
+                stride *= n[d];
+            }
+        }
+        else{
+            // Up to the Nyquist frequency along each dimension. Multitone frequencies fall between the
+            // DFT bins, so they leak into every bin; sparse frequencies are whole numbers, which fall
+            // on a single bin each.
+            tone->amplitude = (generator->signal->kind == SIGNAL_MULTITONE) ? 1.0 / (t + 1) : 1.0;
+            tone->phase = __uniform(key++);
+            for (d=0; d<rank; d++){
+                tone->freq[d] = __uniform(key++) * (n[d] / 2);
+                if (generator->signal->kind == SIGNAL_SPARSE)
+                    tone->freq[d] = floor(tone->freq[d]);
+            }
+        }
+
+        for (p=0; p<TONE_TABLE_LEN && p<generator->row_length; p++){
+            tone->cos_table[p] = cos(2 * PI * __fraction(tone->freq[rank-1] * p / generator->row_length));
+            tone->sin_table[p] = sin(2 * PI * __fraction(tone->freq[rank-1] * p / generator->row_length));
+        }
+    }
+}
+
+void fill_segment(const SignalGenerator *generator, double *data, ptrdiff_t row, int start, int end){
+/* Fills samples 'start' to 'end' (exclusive) of one row of the last dimension
+ *
+ * Inputs
+ * ======
+ *   const SignalGenerator *generator
+ *       The generator
+ *
+ *   double *data
+ *       The first sample of the row
+ *
+ *   ptrdiff_t row, int start, int end
+ *       Row (in row-major order over all dimensions but the last), and the samples to fill
+ */
+    int d, t, m, p, block, block_end;
+    ptrdiff_t remaining_rows;
+    int rank = generator->rank;
+    int row_length = generator->row_length;
+    size_t first_sample = (size_t)row * row_length;
+    uint64_t square;
+    double row_cycles, cycles, c, s;
+    double *block_data;
+    const Tone *tone;
+
+    switch (generator->signal->kind){
+        case SIGNAL_CHIRP:
+            // Linear chirp from 0 to the Nyquist frequency along the last dimension, i.e. m^2/(4 x
+            // row_length) cycles at sample m, kept exact by working out its fraction in integers
+            for (m=start; m<end; m++){
+                square = (uint64_t)m * m % (4 * (uint64_t)row_length);
+                data[m] = cos(2 * PI * (double)square / (4.0 * row_length));
+            }
+            break;
+        case SIGNAL_NOISE:
+            // White noise, uniform in [-1, 1)
+            for (m=start; m<end; m++)
+                data[m] = 2 * __uniform(first_sample + m) - 1;
+            break;
+        case SIGNAL_IMPULSES:
+            // One impulse every IMPULSE_PERIOD samples of the flat index
+            for (m=start; m<end; m++)
+                data[m] = ((first_sample + m) % IMPULSE_PERIOD == 0) ? 1.0 : 0.0;
+            break;
+        default:
+            // Sum of tones. Each tone only needs a cosine and sine per block of TONE_TABLE_LEN samples:
+            // the samples within the block are a rotation of the tone's table, which vectorizes.
+            for (m=start; m<end; m++)
+                data[m] = 0.0;
+            for (t=0; t<generator->num_tones; t++){
+                tone = &generator->tones[t];
+
+                // Cycles at the start of the row, from the row's coordinates in the other dimensions
+                row_cycles = tone->phase;
+                remaining_rows = row;
+                for (d=rank-2; d>=0; d--){
+                    row_cycles += __fraction(tone->freq[d] * (remaining_rows % generator->n[d]) / generator->n[d]);
+                    remaining_rows /= generator->n[d];
+                }
+
+                for (block=start/TONE_TABLE_LEN; (size_t)block*TONE_TABLE_LEN < (size_t)end; block++){
+                    cycles = row_cycles + __fraction(tone->freq[rank-1] * ((double)block * TONE_TABLE_LEN) / row_length);
+                    c = tone->amplitude * cos(2 * PI * __fraction(cycles));
+                    s = tone->amplitude * sin(2 * PI * __fraction(cycles));
+                    block_data = data + (size_t)block * TONE_TABLE_LEN;
+                    p = (block * TONE_TABLE_LEN < start) ? start - block * TONE_TABLE_LEN : 0;
+                    block_end = (end - block * TONE_TABLE_LEN < TONE_TABLE_LEN) ? end - block * TONE_TABLE_LEN : TONE_TABLE_LEN;
+                    for (; p<block_end; p++)
+                        block_data[p] += c * tone->cos_table[p] - s * tone->sin_table[p];
+                }
+            }
+            break;
+    }
+}
+
+void *fill_slice(void *args){
+/* Fills one thread's contiguous slice of the data, row by row (see generate_signal_data) */
+    SignalSlice *slice = (SignalSlice*)args;
+    const SignalGenerator *generator = slice->generator;
+    int row_length = generator->row_length;
+    size_t i = slice->start;
+    ptrdiff_t row;
+    int start, end;
+
+    while (i < slice->end){
+        row = (ptrdiff_t)(i / row_length);
+        start = (int)(i % row_length);
+        end = (slice->end - i < (size_t)(row_length - start)) ? start + (int)(slice->end - i) : row_length;
+        fill_segment(generator, slice->data + (size_t)row * row_length, row, start, end);
+        i += end - start;
+    }
+    return NULL;
+}
+
+void generate_signal_data(double *data, double fs, int rank, int *n, ptrdiff_t n_total, const Signal *signal, int nthreads, WorkPool *pool){
+/* Generates the input of the DFTs, filling every sample of the N-dimensional array. The array is
+ * split into one contiguous slice per thread; every sample is computed on its own (there is no
+ * recursion, and no state carried from one sample to the next), so the result does not depend on
+ * the number of threads, nor on whether the slices run on a work pool or on threads of their own.
+ *
+ * Inputs
+ * ======
+ *   double *data
+ *       The array to fill, in row-major order
+ *
+ *   double fs
+ *       Sampling frequency of the cosine signal (the other signals do not use it)
+ *
+ *   int rank, int *n, ptrdiff_t n_total
+ *       Rank, dimensions and total number of samples of the array
+ *
+ *   const Signal *signal
+ *       The signal to generate (see SIGNALS)
+ *
+ *   int nthreads
+ *       Number of threads to generate it with
+ *
+ *   WorkPool *pool
+ *       Pool to run the slices on (NULL to start a thread per slice)
+ */
+    int t;
+    SignalGenerator generator = {signal, rank, n, n[rank-1], NULL, 0};
+
+    if (nthreads < 1)
+        nthreads = 1;
+    if (nthreads > n_total)
+        nthreads = (int)n_total;
+
+    init_tones(&generator, fs);
+
+    pthread_t *threads = (pthread_t*)malloc(nthreads * sizeof(pthread_t));
+    SignalSlice *slices = (SignalSlice*)malloc(nthreads * sizeof(SignalSlice));
+    for (t=0; t<nthreads; t++){
+        slices[t].generator = &generator;
+        slices[t].data = data;
+        slices[t].start = (size_t)n_total * t / nthreads;
+        slices[t].end = (size_t)n_total * (t + 1) / nthreads;
+    }
+
+    // The calling thread fills the first slice
+#ifdef FFTW3
+    if (pool != NULL)
+        work_pool_run(pool, fill_slice, slices, sizeof(SignalSlice), nthreads);
+    else{
+#else
+    {
+#endif
+        for (t=1; t<nthreads; t++)
+            pthread_create(&threads[t], NULL, fill_slice, &slices[t]);
+        fill_slice(&slices[0]);
+        for (t=1; t<nthreads; t++)
+            pthread_join(threads[t], NULL);
+    }
+
+    free(threads);
+    free(slices);
+    free(generator.tones);
+}
+
+void input_cache_path(char *path, size_t size, const char *cache_dir, double fs, int rank, int *n, const char *signal){
+/* Builds the path of the cached input of a signal, e.g. "<cache_dir>/cosine__300x300__fs0.001.v1.input" */
+    int i;
+    size_t len = (size_t)snprintf(path, size, "%s/%s__%d", cache_dir, signal, n[0]);
+
+    for (i=1; i<rank && len < size; i++)
+        len += (size_t)snprintf(path + len, size - len, "x%d", n[i]);
+    if (len < size)
+        snprintf(path + len, size - len, "__fs%.15g.v%d.input", fs, INPUT_CACHE_VERSION);
+}
+
+uint64_t input_checksum(const double *data, size_t num_samples){
+/* Hashes the samples, a 64-bit word at a time (FNV-1a), to catch truncated or corrupted cache files */
+    size_t i;
+    uint64_t word, hash = 0xcbf29ce484222325ULL;
+
+    for (i=0; i<num_samples; i++){
+        memcpy(&word, &data[i], sizeof(word));
+        hash = (hash ^ word) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+void init_input_cache_header(InputCacheHeader *header, double fs, int rank, int *n, ptrdiff_t n_total, const char *signal){
+/* Fills in the parameters of a cache header (everything but the checksum) */
+    int i;
+
+    memset(header, 0, sizeof(InputCacheHeader));
+    memcpy(header->magic, INPUT_CACHE_MAGIC, sizeof(header->magic));
+    header->version = INPUT_CACHE_VERSION;
+    header->byte_order = INPUT_CACHE_BYTE_ORDER;
+    header->rank = rank;
+    for (i=0; i<rank; i++)
+        header->dims[i] = n[i];
+    header->fs = fs;
+    snprintf(header->signal, sizeof(header->signal), "%s", signal);
+    header->num_samples = (uint64_t)n_total;
+}
+
+bool map_input_cache(InputData *input, const InputCacheHeader *expected){
+/* Maps a cached input read-only, if its header matches 'expected' and its samples match the checksum
+ *
+ * Inputs
+ * ======
+ *   InputData *input
+ *       Holds the path of the cache file, and gets the mapping if there is a hit
+ *
+ *   const InputCacheHeader *expected
+ *       Header the file must have (except for its checksum)
+ *
+ * Returns
+ * =======
+ *   bool hit
+ *       Whether the input was mapped
+ */
+    struct stat file_stat;
+    InputCacheHeader *header;
+    size_t file_size = INPUT_CACHE_DATA_OFFSET + expected->num_samples * sizeof(double);
+    int flags = MAP_PRIVATE;
+    int fd = open(input->cache_path, O_RDONLY);
+
+    if (fd == -1)
+        return false;
+    if (fstat(fd, &file_stat) == -1 || (size_t)file_stat.st_size != file_size){
+        close(fd);
+        return false;
+    }
+
+    // Fault the whole file in now, so that no page faults land in the timed DFTs
+#ifdef MAP_POPULATE
+    flags |= MAP_POPULATE;
+#endif
+    void *mapping = mmap(NULL, file_size, PROT_READ, flags, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+        return false;
+
+    header = (InputCacheHeader*)mapping;
+    input->data = (double*)((char*)mapping + INPUT_CACHE_DATA_OFFSET);
+    if (memcmp(header, expected, offsetof(InputCacheHeader, checksum)) != 0 ||
+        header->checksum != input_checksum(input->data, expected->num_samples)){
+        fprintf(stderr, "Ignoring stale or corrupted input cache '%s'.\n", input->cache_path);
+        munmap(mapping, file_size);
+        input->data = NULL;
+        return false;
+    }
+
+    input->mapping = mapping;
+    input->mapping_size = file_size;
+    return true;
+}
+
+int save_input_cache(InputData *input, InputCacheHeader *header){
+/* Saves a generated input to its cache file. The file is written under a temporary name and renamed
+ * into place, so that runs sharing the cache never map a partly written file.
+ *
+ * Returns
+ * =======
+ *   0 on success, -1 if the file could not be written
+ */
+    char tmp_path[MAX_INPUT_CACHE_PATH_LEN + 32];
+    char padding[INPUT_CACHE_DATA_OFFSET] = {'\0'};
+    size_t num_samples = header->num_samples;
+    FILE *cache_file;
+    bool written;
+
+    header->checksum = input_checksum(input->data, num_samples);
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp%d", input->cache_path, (int)getpid());
+    cache_file = fopen(tmp_path, "wb");
+    if (cache_file == NULL){
+        fprintf(stderr, "Could not save the input to '%s'.\n", input->cache_path);
+        return -1;
+    }
+
+    memcpy(padding, header, sizeof(InputCacheHeader));
+    written = fwrite(padding, 1, INPUT_CACHE_DATA_OFFSET, cache_file) == INPUT_CACHE_DATA_OFFSET &&
+              fwrite(input->data, sizeof(double), num_samples, cache_file) == num_samples;
+    if (fclose(cache_file) != 0 || written == false || rename(tmp_path, input->cache_path) != 0){
+        fprintf(stderr, "Could not save the input to '%s'.\n", input->cache_path);
+        remove(tmp_path);
+        return -1;
+    }
+    return 0;
+}
+
+void load_input_data(InputData *input, double fs, int rank, int *n, ptrdiff_t n_total, BenchmarkOptions *options, int nthreads){
+/* Gets the input of the DFTs: maps it from the input cache if it is there, otherwise generates it
+ * (and saves it to the cache, if there is one)
+ *
+ * Inputs
+ * ======
+ *   InputData *input
+ *       Holds the input, where it came from, and how long it took to get
+ *
+ *   double fs, int rank, int *n, ptrdiff_t n_total
+ *       Sampling frequency, rank, dimensions and total number of samples of the input
+ *
+ *   BenchmarkOptions *options
+ *       Holds the signal and the input cache directory (NULL to always generate the input)
+ *
+ *   int nthreads
+ *       Number of threads to generate the input with
+ */
+    struct timeval start, stop;
+    InputCacheHeader header;
+
+    memset(input, 0, sizeof(InputData));
+    gettimeofday(&start, NULL);
+
+    if (options->input_cache_dir != NULL){
+        if (mkdir(options->input_cache_dir, 0755) == -1 && errno != EEXIST)
+            fprintf(stderr, "Could not create input cache directory '%s'.\n", options->input_cache_dir);
+        input_cache_path(input->cache_path, MAX_INPUT_CACHE_PATH_LEN, options->input_cache_dir, fs, rank, n, options->signal);
+        init_input_cache_header(&header, fs, rank, n, n_total, options->signal);
+        input->cache_hit = map_input_cache(input, &header);
+    }
+
+    if (input->cache_hit == false){
+        input->data = (double*)malloc((size_t)n_total * sizeof(double));
+        generate_signal_data(input->data, fs, rank, n, n_total, find_signal(options->signal), nthreads, options->work_pool);
+        if (options->input_cache_dir != NULL)
+            save_input_cache(input, &header);
+    }
+
+    gettimeofday(&stop, NULL);
+    input->setup_time_sec = (stop.tv_sec - start.tv_sec) + (stop.tv_usec - start.tv_usec) * (1e-6);
+}
+
+void free_input_data(InputData *input){
+/* Unmaps or frees the input */
+    if (input->mapping != NULL)
+        munmap(input->mapping, input->mapping_size);
+    else
+        free(input->data);
+    input->data = NULL;
+    input->mapping = NULL;
+}
+
+void plot1D(double *cosine, int dim_to_plot, int rank, int *n, double fs, char *title){
 /* Plot cosine data for a specific dimension
  *
  * Inputs
@@ -563,9 +2501,123 @@ void plot1D(double *cosine, int dim_to_plot, int rank, int *n, double fs, char *
     }
 }
 
+typedef struct {
+    regex_t timestamp_regex;
+    int status;
+} CosineJSONValidator;
+
+int __check_cosine_record(JsonRecord *record, void *validator_args){
+    /* Checks a single record of an FFTW cosine JSON file. Do not call this function directly!
+     *
+     * Inputs
+     * ------
+     * JsonRecord *record
+     *     The record to check
+     *
+     * void *validator_args
+     *     A CosineJSONValidator, whose 'status' is set to one of the error codes of
+     *     verifyCosineJSONFile if the record is invalid
+     *
+     * Returns
+     * -------
+     *  0 if the record is valid, -1 otherwise (which stops the reader)
+     */
+    CosineJSONValidator *validator = (CosineJSONValidator*)validator_args;
+
+    // Keys which must be present in every record and must hold whole numbers
+    const char *integer_keys[] = {INPUT_PATH(RANK_KEY), INPUT_PATH(ITERATIONS_KEY), INPUT_PATH(THREADS_KEY)};
+    const int num_integer_keys = 3;
+
+    // Keys which must be present in every record and must hold numbers
+    const char *number_keys[] = {DFT_RESULT_PATH(FWD_DFT_RESULTS_KEY, AVG_EXEC_TIME_SECONDS_KEY), DFT_RESULT_PATH(FWD_DFT_RESULTS_KEY, AVG_GFLOPS_KEY),
+                                 DFT_RESULT_PATH(FWD_DFT_RESULTS_KEY, STDEV_GFLOPS_KEY), DFT_RESULT_PATH(BWD_DFT_RESULTS_KEY, AVG_EXEC_TIME_SECONDS_KEY),
+                                 DFT_RESULT_PATH(BWD_DFT_RESULTS_KEY, AVG_GFLOPS_KEY), DFT_RESULT_PATH(BWD_DFT_RESULTS_KEY, STDEV_GFLOPS_KEY)};
+    const int num_number_keys = 6;
+
+    char timestamp[BUFFSIZE];
+    char dim_path[MAX_JSON_PATH_LEN];
+    JsonField *field;
+    int i, rank, num_dims;
+
+    // Each record is keyed by the timestamp of its run
+    json_token_copy((JsonToken){JSON_TOKEN_STRING, record->key, record->key_length, record->line}, timestamp, BUFFSIZE);
+    if (regexec(&validator->timestamp_regex, timestamp, 0, NULL, 0) != 0){
+        fprintf(stderr, "Invalid timestamp '%s' on line %zu. Check that the day, month, year, hour, mins, and secs are valid.\n", timestamp, record->line);
+        validator->status = -4;
+        return -1;
+    }
+
+    for (i=0; i<num_integer_keys; i++){
+        field = json_record_find(record, integer_keys[i]);
+        if (field == NULL){
+            fprintf(stderr, "Missing key '%s' in the entry on line %zu.\n", integer_keys[i], record->line);
+            validator->status = -2;
+            return -1;
+        }
+        if (json_token_is_integer(field->value) == false){
+            fprintf(stderr, "Float/Double values are not allowed for '%s' line %zu. Please use whole numbers.\n", integer_keys[i], field->value.line);
+            validator->status = -5;
+            return -1;
+        }
+    }
+
+    for (i=0; i<num_number_keys; i++){
+        field = json_record_find(record, number_keys[i]);
+        if (field == NULL){
+            fprintf(stderr, "Missing key '%s' in the entry on line %zu.\n", number_keys[i], record->line);
+            validator->status = -2;
+            return -1;
+        }
+        if (field->value.type != JSON_TOKEN_NUMBER){
+            fprintf(stderr, "Invalid value for '%s' on line %zu. Expected a number.\n", number_keys[i], field->value.line);
+            validator->status = -2;
+            return -1;
+        }
+    }
+
+    // fs must be a number (written as w.xe+yz or w.xe-yz)
+    field = json_record_find(record, INPUT_PATH(FS_KEY));
+    if (field == NULL){
+        fprintf(stderr, "Missing key '%s' in the entry on line %zu.\n", INPUT_PATH(FS_KEY), record->line);
+        validator->status = -2;
+        return -1;
+    }
+    if (field->value.type != JSON_TOKEN_NUMBER || json_token_to_double(field->value) <= 0){
+        fprintf(stderr, "Invalid format for fs on line %zu.\n", field->value.line);
+        validator->status = -6;
+        return -1;
+    }
+
+    // There must be one whole number in 'dims' per dimension
+    rank = (int)json_token_to_long(json_record_find(record, INPUT_PATH(RANK_KEY))->value);
+    num_dims = json_record_int_array(record, INPUT_PATH(DIMS_KEY), NULL, 0);
+    if (num_dims != rank){
+        fprintf(stderr, "Rank is %d, but %d dims were found in the entry on line %zu.\n", rank, num_dims, record->line);
+        validator->status = -3;
+        return -1;
+    }
+    for (i=0; i<num_dims; i++){
+        snprintf(dim_path, MAX_JSON_PATH_LEN, "%s[%d]", INPUT_PATH(DIMS_KEY), i);
+        field = json_record_find(record, dim_path);
+        if (field == NULL){
+            fprintf(stderr, "Missing dimension %d in the entry on line %zu.\n", i, record->line);
+            validator->status = -3;
+            return -1;
+        }
+        if (json_token_is_integer(field->value) == false){
+            fprintf(stderr, "Float/Double values are not allowed for '%s' line %zu. Please use whole numbers.\n", DIMS_KEY, field->value.line);
+            validator->status = -5;
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
 int verifyCosineJSONFile(char *fftw_json_filename){
     /* This function verifies that a JSON file is valid and in the proper format for the input to
-     * an FFTW executable.
+     * an FFTW executable. The file is read with the shared results reader, so the layout of the
+     * file (whitespace, line breaks, key order) does not matter, only its structure and values.
      *
      * Inputs
      * ------
@@ -575,10 +2627,10 @@ int verifyCosineJSONFile(char *fftw_json_filename){
      * Error codes
      * -----------
      *  -1 : Invalid filename
-     *  -2 : Invalid key found in JSON file
-     *  -3 : Invalid number of brackets or curly braces
-     *  -4 : Invalid line (e.g., we have extra chars that are not null, ' ', or a bracket
-     *  -5 : Too many commas or periods
+     *  -2 : Missing key, or a key holding the wrong type of value
+     *  -3 : Malformed JSON (unbalanced brackets/braces, missing commas or colons, etc.) or 'dims' does not match 'rank'
+     *  -4 : Invalid timestamp key
+     *  -5 : Float/Double value where a whole number is required
      *  -6 : Invalid format for Fs (should be in the format of w.xe+yz or w.xe-yz)
      */
 
@@ -588,368 +2640,21 @@ int verifyCosineJSONFile(char *fftw_json_filename){
         return -1;
     }
 
-    // Open file
-    FILE *fftw_json_file = fopen(fftw_json_filename, "r");
-
-    // Get key lengths
-    const int performance_key_len = strlen(PERFORMANCE_KEY);
-    const int input_key_len = strlen(INPUTS_KEY);
-    const int rank_key_len = strlen(RANK_KEY);
-    const int dims_key_len = strlen(DIMS_KEY);
-    const int fs_key_len = strlen(FS_KEY);
-    const int iterations_key_len = strlen(ITERATIONS_KEY);
-    const int threads_key_len = strlen(THREADS_KEY);
-    const int fwd_dft_results_key_len = strlen(FWD_DFT_RESULTS_KEY);
-    const int avg_gflops_key_len = strlen(AVG_GFLOPS_KEY);
-    const int stdev_gflops_key_len = strlen(STDEV_GFLOPS_KEY);
-    const int bwd_dft_results_key_len = strlen(BWD_DFT_RESULTS_KEY);
-    const int avg_exec_time_seconds_key_len = strlen(AVG_EXEC_TIME_SECONDS_KEY);
-
-    // Iterate through file
-    int valid_key_count = 0;
-    char buffer[BUFFSIZE] = {'\0'};
-    char *curr_key;
-    int i;
-    char curr_char = '\0';
-    int open_curly_braces_count = 0;
-    int closed_curly_braces_count = 0;
-    int open_bracket_count = 0;
-    int closed_bracket_count = 0;
-    int null_char_count = 0;
-    int space_char_count = 0;
-    int colon_count = 0;
-    int quotes_count = 0;
-    int total_valid_char_count = 0;
-    int n_chars_in_key = 0;
-    int line_count = 1; //yes, we start at 1
-    int same_key_count = 0; //this value should always equal 1 after we've used our logic
-    int index_in_key = 0;
-    int e_count = 0;
-    int sign_count = 0;
-    int comma_count = 0;
-    int dot_count = 0;
-
     // For checking timestamps
-    char *yyyy_mm_dd_pattern = ".*([0-9]{4})\\-(0?[1-9]|1[012])\\-(0?[1-9]|[12][0-9]|3[01]) ([01]?[0-9]|2[0-3]):([0-5]?[0-9]):([0-5][0-9]).*";
-    regex_t regex;
-    int reti;
-    size_t nmatch = 0;
-    regmatch_t pmatch[nmatch];
-
-    while (fgets(buffer, BUFFSIZE, fftw_json_file)){
-
-        // Check if the current key is valid and keep track of how many keys are found in the 
-        // current line. We want to handle the case where there are multiple of the "correct"
-        // keys in the same line, as that is invalid
-        if (strstr(buffer, PERFORMANCE_KEY) != NULL){
-            curr_key = PERFORMANCE_KEY;
-            n_chars_in_key = performance_key_len;
-            valid_key_count++;
-        }
-        if (strstr(buffer, INPUTS_KEY) != NULL){
-            curr_key = INPUTS_KEY;
-            n_chars_in_key = input_key_len;
-            valid_key_count++;
-        }
-        if (strstr(buffer, RANK_KEY) != NULL){
-            curr_key = RANK_KEY;
-            n_chars_in_key = rank_key_len;
-            valid_key_count++;
-        }
-        if (strstr(buffer, DIMS_KEY) != NULL){
-            curr_key = DIMS_KEY;
-            n_chars_in_key = dims_key_len;
-            valid_key_count++;
-        }
-        if (strstr(buffer, FS_KEY) != NULL){
-            curr_key = FS_KEY;
-            n_chars_in_key = fs_key_len;
-            valid_key_count++;
-        }
-        if (strstr(buffer, ITERATIONS_KEY) != NULL){
-            curr_key = ITERATIONS_KEY;
-            n_chars_in_key = iterations_key_len;
-            valid_key_count++;
-        }
-        if (strstr(buffer, FWD_DFT_RESULTS_KEY) != NULL){
-            curr_key = FWD_DFT_RESULTS_KEY;
-            n_chars_in_key = fwd_dft_results_key_len;
-            valid_key_count++;
-        }
-        if (strstr(buffer, AVG_GFLOPS_KEY) != NULL){
-            curr_key = AVG_GFLOPS_KEY;
-            n_chars_in_key = avg_gflops_key_len;
-            valid_key_count++;
-        }
-        if (strstr(buffer, STDEV_GFLOPS_KEY) != NULL){
-            curr_key = STDEV_GFLOPS_KEY;
-            n_chars_in_key = stdev_gflops_key_len;
-            valid_key_count++;
-        }
-        if (strstr(buffer, BWD_DFT_RESULTS_KEY) != NULL){
-            curr_key = BWD_DFT_RESULTS_KEY;
-            n_chars_in_key = bwd_dft_results_key_len;
-            valid_key_count++;
-        }
-        if (strstr(buffer, AVG_EXEC_TIME_SECONDS_KEY) != NULL){
-            curr_key = AVG_EXEC_TIME_SECONDS_KEY;
-            n_chars_in_key = avg_exec_time_seconds_key_len;
-            valid_key_count++;
-        }
-        if (strstr(buffer, THREADS_KEY) != NULL){
-            curr_key = THREADS_KEY;
-            n_chars_in_key = threads_key_len;
-            valid_key_count++;
-        }
-
-        // We've found more than one 'valid' key, which means something is wrong
-        if (valid_key_count > 1){
-            fprintf(stderr, "Invalid key found on line %d.\n", line_count);
-            return -2;
-        }
-
-        // If there is no key found, then we must check if there are balanced brackets or if the line is space
-        if (valid_key_count == 0){
-
-            reti = regcomp(&regex, yyyy_mm_dd_pattern, REG_EXTENDED);
-            if (reti){
-                fprintf(stderr, "Could not compile regex\n");
-            }
-            reti = regexec(&regex, buffer, nmatch, pmatch, 0);
-
-            // If we have a regex match, then continue
-            if (reti == 0){
-                continue;
-            }
-
-            for (i=0; i<BUFFSIZE; i++){
-
-                // Get the current character
-                curr_char = buffer[i];
-
-                // Check for spaces
-                if (curr_char == ' ')
-                    space_char_count++;
-
-                // Check for null chars
-                if (curr_char == '\0')
-                    null_char_count++;
-
-                // Check for open curly braces
-                if (curr_char == '{')
-                    open_curly_braces_count++;
-
-                // Check for closed curly braces
-                if (curr_char == '}')
-                    closed_curly_braces_count++;
-
-                // Check for commas
-                if (curr_char == ',')
-                    comma_count++;
-
-                // Now see if there are multiple closed brackets on the line
-                if ((open_curly_braces_count > 1) || (closed_curly_braces_count > 1)){
-                    fprintf(stderr, "Too many curly braces on line %d\n", line_count);
-                    return -3;
-                }
-
-                // Reset buffer by setting all chars equal to the null char
-                buffer[i] = '\0';
-            }
-            // Count the total number of valid characters. Make sure to add +1 at the end to include the new line character (\n)
-            total_valid_char_count = open_curly_braces_count + closed_curly_braces_count + space_char_count + null_char_count + comma_count + 1;
-            printf("%s",buffer);
-            if (total_valid_char_count != BUFFSIZE){
-                fprintf(stderr, "Invalid line %d in JSON file. If the line contains a timestamp, check that the day, month, year, hour, mins, and secs are valid. Otherwise, there are unrecognized chars.\n", line_count);
-                return -4;
-            }
-        }
-        // We've found a valid key, so let's check for a colon (:) and quotes (""). We also want to make sure
-        // that the colon occurs AFTER the key.
-        else{
-
-            // Now we have to check for the case if there are MULTIPLE of the same key (since we haven't checked that before)
-            const char *key = buffer;
-            while ((key = strstr(key, curr_key))){
-                same_key_count++;
-                key += strlen(curr_key);
-            }
-
-            // Now check how many of the same key we have. If we have a string such as "performance_key performance_key : {", 
-            // then we know we have the same key twice in the same line and we should throw an error.
-            if (same_key_count > 1){
-                fprintf(stderr, "Multiple keys on line %d.\n", line_count);
-                return -2;
-            }
-
-            for (i=0; i<BUFFSIZE; i++){
-
-                // Get the current character
-                curr_char = buffer[i];
-
-                // This condition checks if the colon has been found BEFORE the current key
-                if (curr_key[0] == curr_char && colon_count != 0){
-                    fprintf(stderr, "Missing key on line %d.\n", line_count);
-                    return -2;
-                }
-
-                // Keep track of the index of the key we're on
-                if (index_in_key < n_chars_in_key){
-                    if (curr_key[index_in_key] == curr_char){
-                        index_in_key++;
-                    }
-                }
-
-                // Check number of colons as we iterate
-                if (curr_char == ':' && colon_count > 1){
-                    fprintf(stderr, "Invalid key. Too many colons on line %d.\n", line_count);
-                    return -2;
-                }
-
-                // Check the number of quotes as we iterate
-                if (quotes_count > 2){
-                    fprintf(stderr, "Invalid key. Too many quotes on line %d.\n", line_count);
-                    return -2;
-                }
-
-                // Check the number of open and closed brackets in dims, as well as the comma count
-                if (strcmp(curr_key, DIMS_KEY) == 0){
-                    if (open_bracket_count > 1 || closed_bracket_count > 1){
-                        fprintf(stderr, "Too many brackets on line %d.\n", line_count);
-                        return -3;
-                    }
-                }
-                else if (open_bracket_count != 0 || closed_bracket_count != 0){
-                    fprintf(stderr, "Brackets are not allowed for key '%s' on line %d.\n", curr_key, line_count);
-                    return -3;
-                }
-                else if ((comma_count > 1) ||
-                    (strcmp(curr_key, THREADS_KEY) == 0 && comma_count != 0) ||
-                    (strcmp(curr_key, STDEV_GFLOPS_KEY) == 0 && comma_count != 0)){
-                    fprintf(stderr, "An excess of commas was found on line %d.\n", line_count);
-                    return -5;
-                }
-
-                // If there are multiple periods, then something went wrong
-                if (dot_count > 1){
-                    fprintf(stderr, "An excess of '.' was found on line %d.\n", line_count);
-                    return -5;
-                }
-
-                // Check if 'dims' has a period (or more) in it. By default, dims cannot have periods. The numbers must be whole.
-                if ((curr_char == '.' && strcmp(curr_key, DIMS_KEY) == 0) ||
-                    (curr_char == '.' && strcmp(curr_key, RANK_KEY) == 0) ||
-                    (curr_char == '.' && strcmp(curr_key, THREADS_KEY) == 0) ||
-                    (curr_char == '.' && strcmp(curr_key, ITERATIONS_KEY) == 0)){
-                    fprintf(stderr, "Float/Double values are not allowed for '%s' line %d. Please use whole numbers.\n", curr_key, line_count);
-                    return -5;
-                }
-
-                // Count the number of commas (we should have either 0 or 1 unless we're on the DIMS_KEY)
-                if (curr_char == ','){
-                    comma_count++;
-                }
-                // Count the number of periods
-                else if (curr_char == '.'){
-                    dot_count++;
-                }
-                // Count the number of colons (we only expect 1)
-                else if (curr_char == ':'){
-                    colon_count++;
-                }
-                // Count number of quotes (we only expect 2)
-                else if (curr_char == '\"'){
-                    quotes_count++;
-                }
-                // Count the number of open brackets (we only expect 1)
-                else if (curr_char == '['){
-                    open_bracket_count++;
-                }
-                // Count the number of closed brackets (we only expect 1)
-                else if (curr_char == ']'){
-                    closed_bracket_count++;
-                }
-                // We've (potentially) reached the case where there is an invalid character
-                else if ((curr_char != ' ') &&
-                         (curr_char != '\0') &&
-                         (curr_char != '\n') &&
-                         (curr_char != '{') &&
-                         (curr_char != '}') &&
-                         (curr_char != '.') &&
-                         (curr_char != ',') &&
-                         (isdigit(curr_char) == 0) &&
-                         (index_in_key == n_chars_in_key) &&
-                         (curr_char != curr_key[index_in_key-1])){
-
-                        if (strcmp(curr_key, DIMS_KEY) == 0){
-                            if (curr_char != ']' && curr_char != '['){
-                                fprintf(stderr, "Invalid key on line %d. Unrecognized character '%c'.\n", line_count, curr_char);
-                                return -2;
-                            }
-                        }
-                        else if (strcmp(curr_key, FS_KEY) == 0){
-
-                            // The only valid characters for fs_Hz are: digits, e, -, and +
-                            if (curr_char != 'e' && curr_char != '-' && curr_char != '+'){
-                                fprintf(stderr, "Invalid key on line %d. Unrecognized character '%c'.\n", line_count, curr_char);
-                                return -2;
-                            }
-                            else if (curr_char == 'e'){
-                                e_count++;
-                            }
-                            else if (curr_char == '+' || curr_char == '-'){
-                                sign_count++;
-                            }
-
-                            // If we have too many +'s or -'s, then the format of fs is wrong.
-                            if (e_count > 1 || sign_count > 1){
-                                fprintf(stderr, "%s", "Invalid format for fs.\n");
-                                return -6;
-                            }
-                        }
-                        else{
-                            fprintf(stderr, "Invalid key on line %d. Unrecognized character '%c'.\n", line_count, curr_char);
-                            return -2;
-                        }
-                }
-
-                // Reset buffer by setting all chars equal to the null char
-                buffer[i] = '\0';
-            }
-
-            // Check number of quotes and colons
-            if (colon_count != 1 && quotes_count != 2){
-                fprintf(stderr, "Invalid key found on line %d.\n", line_count);
-                return -2;
-            }
-
-        }
-        // Reset indices
-        index_in_key = 0;
-
-        // Reset counts
-        same_key_count = 0;
-        space_char_count = 0;
-        null_char_count = 0;
-        open_curly_braces_count = 0;
-        closed_curly_braces_count = 0;
-        open_bracket_count = 0;
-        closed_bracket_count = 0;
-        colon_count = 0;
-        quotes_count = 0;
-        comma_count = 0;
-        e_count = 0;
-        sign_count = 0;
-        dot_count = 0;
-
-        // Update line count
-        line_count++;
-
-        // Update valid key count
-        valid_key_count = 0;
-
+    char *yyyy_mm_dd_pattern = "^([0-9]{4})\\-(0?[1-9]|1[012])\\-(0?[1-9]|[12][0-9]|3[01]) ([01]?[0-9]|2[0-3]):([0-5]?[0-9]):([0-5]?[0-9])$";
+    CosineJSONValidator validator;
+    validator.status = 0;
+    if (regcomp(&validator.timestamp_regex, yyyy_mm_dd_pattern, REG_EXTENDED | REG_NOSUB)){
+        fprintf(stderr, "Could not compile regex\n");
+        return -4;
     }
 
-    regfree(&regex);
-    return 0;
+    int num_records = json_read_records(fftw_json_filename, __check_cosine_record, &validator);
+    regfree(&validator.timestamp_regex);
+
+    if (num_records == -2)
+        return -1;
+    if (num_records < 0)
+        return -3;
+    return validator.status;
 }
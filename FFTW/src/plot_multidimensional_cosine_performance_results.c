@@ -2,20 +2,22 @@
  * generated by multidimensional_cosine_dft.c
  */
 #define _DEFAULT_SOURCE
-#define BUFFSIZE 4096
+#define INITIAL_NUM_RESULTS 16
 #define MAX_DIM_STR_LEN 200
+#define MAX_RANK 100
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
 #include <stdbool.h>
 #include <math.h>
+#include "results_json.h"
 
 struct PerformanceData{
 /* Struct which holds performance data for a given run
  */
     int rank;
-    int dims[100];
+    int dims[MAX_RANK];
     double fs;
     int threads;
     double fft_gflops;
@@ -24,6 +26,15 @@ struct PerformanceData{
     double ifft_gflops_stdev;
 };
 
+struct PerformanceDataList{
+/* Growable array of performance data, one element per run in the JSON document
+ */
+    struct PerformanceData *results;
+    int count;
+    int capacity;
+};
+
+int add_performance_data(JsonRecord *record, void *performance_list);
 void plot_fft_and_ifft_results(struct PerformanceData *performance_results, int num_results);
 
 int main(int argc, char* argv[]){
@@ -36,415 +47,27 @@ int main(int argc, char* argv[]){
 
     char *json_filename = argv[1];
 
-    // Check if the file exists. If it does, then open it. If it doesn't, then throw
+    // Check if the file exists. If it does, then read it. If it doesn't, then throw
     // an error letting the user know the file doesn't exist.
     if (access(json_filename, F_OK) != -1){
 
-        // Array to save results to
-        struct PerformanceData *performance_results = malloc(100 * sizeof(struct PerformanceData));
-
-        // Open the JSON document
-        FILE *json_file = fopen(json_filename, "r");
-
-        // Create buffer
-        char buffer[BUFFSIZE] = {'\0'};
-
-        // Create tmp var for holding current character
-        char current_char = '\0';
-
-        // Iterating vars
-        int i,j;
-
-        // Temporary var to tell the algorithm when we should start reading
-        bool start_reading;
-
-        // For keeping track of the previous character
-        char prev_char = '\0';
-
-        // Rank parsing vars
-        int *rank_ints = malloc(10 * sizeof(int));
-        int rank_idx = -1;
-        int rank_val = -1;
-        int total_rank = 0;
-
-        // Dims parsing vars
-        int *dim_ints = malloc(100 * sizeof(int));
-        int dim_idx = -1;
-        int next_dim_idx = -1;
-        int dim_val = -1;
-        int total_dim = 0;
-        int dim_number = 0;
-
-        // Frequency parsing vars
-        int *freq_mantissa_whole_number_ints = malloc(100 * sizeof(int));
-        int *freq_mantissa_fraction_ints = malloc(2 * sizeof(int));
-        int *freq_exponent_ints = malloc(2 * sizeof(int));
-        int freq_mantissa_whole_idx = 0;
-        int freq_mantissa_frac_idx = 0;
-        int freq_exponent_idx = 0;
-        double total_freq;
-        int total_exponent;
-        int exp_val;
-        double freq_val = 0.0;
-        bool start_fraction_parsing = false;
-        bool start_exponent_parsing = false;
-        int sign = -1;
-
-        // Thread parsing vars
-        int *thread_ints = malloc(5 * sizeof(int));
-        int thread_idx = -1;
-        int thread_val = -1;
-        int total_threads = 0;
-
-        // Forward DFT parsing vars
-        int *fft_mantissa_ints = malloc(15 * sizeof(int));
-        int *fft_fraction_ints = malloc(15 * sizeof(int));
-        int fft_mantissa_idx = -1;
-        int fft_fraction_idx = -1;
-        double fft_val = 0.0;
-        double total_fft_gflops = 0;
-        bool start_fft_fraction = false;
-        bool reached_fft = false;
-        bool reached_fft_gflops = false;
-
-        // Backward DFT parsing vars
-        bool reached_ifft = false;
-        bool reached_ifft_gflops = false;
-
-        // Save index for performance results
-        int performance_result_idx = -1;
-        struct PerformanceData data;
-
-        // Temp var for converting char to int
-        int char_as_int;
-
-        // Iterate
-        while (fgets(buffer, BUFFSIZE, json_file)){
-
-            // We don't need or want to process brackets
-            if (buffer[0] == '{')
-                continue;
-            if (strstr(buffer, "}") != NULL)
-                continue;
-
-            // Prepare to create a new struct if we are at the "performance_results" heading
-            if (strstr(buffer, "performance_results") != NULL){
-                performance_result_idx++;
-            }
-            else if (strstr(buffer, "inputs") != NULL){
-                continue;
-            }
-            else if (strstr(buffer, "rank") != NULL){
-                start_reading = false;
-                rank_idx = 0;
-                rank_val = 0;
-                total_rank = 0;
-                for (i=0; i<BUFFSIZE; i++){
-
-                    // Get the current character in the string
-                    current_char = buffer[i];
-
-                    // We want to start reading the numbers following the colon
-                    if (current_char == ':')
-                        start_reading = true;
-
-                    // Once we're ready to start reading,
-                    if (start_reading == true && current_char != '\0' && current_char != ' ' && current_char != ':' && current_char != ','){
-                        char_as_int = (int)(current_char - '0');
-                        rank_ints[rank_idx] = char_as_int;
-                        rank_idx++;
-                    }
-                    else if (current_char == ','){
-                        break;
-                    }
-                }
-
-                // Now that we've filled our 'rank_ints' arr, let's get the rank
-                for (i=0; i<rank_idx; i++){
-                    rank_val = pow(rank_ints[i], rank_idx-i);
-                    total_rank += rank_val;
-                }
-                data.rank = total_rank;
-            }
-            else if (strstr(buffer, "dims") != NULL){
-                start_reading = false;
-                dim_idx = 0;
-                next_dim_idx = 0;
-                total_dim = 0;
-                dim_number = 0;
-                for (i=0; i<BUFFSIZE; i++){
-
-                    // Get the current character in the string
-                    current_char = buffer[i];
-
-                    // We want to start reading the numbers following the colon
-                    if (current_char == ':')
-                        start_reading = true;
-
-                    // Once we're ready to start reading,
-                    if (start_reading == true && current_char != ' ' && current_char != ':' && current_char != '[' && current_char != ']' && current_char != ',' ){
-                        char_as_int = (int)(current_char - '0');
-                        dim_ints[dim_idx] = char_as_int;
-                        dim_idx++;
-                    }
-                    else if (start_reading == true && (current_char == ' ' || current_char == ',') && (prev_char == ',' || prev_char == ']')){
-                        for (j=next_dim_idx; j<dim_idx; j++){
-                            dim_val = dim_ints[j] * pow(10,dim_idx-j-1);
-                            next_dim_idx++;
-                            total_dim += dim_val;
-                        }
-
-                        data.dims[dim_number] = total_dim;
-                        dim_number++;
-                        total_dim = 0;
-                    }
-
-                    // If we've reached the ] character, then it means we've reached the end of the 'dims' array, so there's no
-                    // need to continue iterating
-                    if (prev_char == ']'){
-                        break;
-                    }
-
-                    // Update prev character
-                    prev_char = current_char;
-
-                }
-            }
-            else if (strstr(buffer, "fs_Hz") != NULL){
-                start_reading = false;
-                start_fraction_parsing = false;
-                start_exponent_parsing = false;
-                freq_mantissa_whole_idx = 0;
-                freq_mantissa_frac_idx = 0;
-                freq_exponent_idx = 0;
-                sign = 0;
-                total_freq = 0;
-                for (i=0; i<BUFFSIZE; i++){
-
-                    // Get the current character in the string
-                    current_char = buffer[i];
-
-                    // We want to start reading the numbers following the colon
-                    if (current_char == ':')
-                        start_reading = true;
-                    else if(current_char == '.')
-                        start_fraction_parsing = true;
-                    else if (current_char == 'e')
-                        start_exponent_parsing = true;
-
-                    char_as_int = (int)(current_char - '0');
-
-                    // Once we're ready to start reading,
-                    if (start_reading == true && current_char != ' ' && current_char != ':' && current_char != '.' && start_fraction_parsing == false && start_exponent_parsing == false){
-                        freq_mantissa_whole_number_ints[freq_mantissa_whole_idx] = char_as_int;
-                        freq_mantissa_whole_idx++;
-                    }
-                    else if (start_fraction_parsing == true && start_exponent_parsing == false && current_char != '.'){
-                        freq_mantissa_fraction_ints[freq_mantissa_frac_idx] = char_as_int;
-                        freq_mantissa_frac_idx++;
-                    }
-                    else if (start_exponent_parsing == true && current_char != 'e' && current_char != ','){
-
-                        // Determine the sign of the exponent
-                        if (current_char == '+'){
-                            sign = 1;
-                            continue;
-                        }
-                        else if (current_char == '-'){
-                            sign = -1;
-                            continue;
-                        }
-
-                        if (prev_char == '+' || prev_char == '-')
-                            freq_exponent_ints[freq_exponent_idx] = sign * char_as_int;
-                        else
-                            freq_exponent_ints[freq_exponent_idx] = char_as_int;
-
-
-                        // Keep track of the previous character. If the character is + or -, then we need to multiply 
-                        // the current number by + or -
-                        prev_char = current_char;
-
-                        // Update idx
-                        freq_exponent_idx++;
-
-                    }
-                    else if (current_char == ','){
-                        break;
-                    }
-                }
-
-                // prepare to capture the total frequency
-                total_freq = 0.0;
-
-                // Iterate through all of the integers in the mantissa whole number
-                for (i=0; i<freq_mantissa_whole_idx; i++){
-                    freq_val = freq_mantissa_whole_number_ints[i] * pow(10, freq_mantissa_whole_idx-i-1);
-                    total_freq += freq_val;
-                }
-
-                // Iterate through all of the integers in the mantissa fraction
-                for (i=0; i<freq_mantissa_frac_idx; i++){
-                    freq_val = freq_mantissa_fraction_ints[i] * pow(10, -i-1);
-                    total_freq += freq_val;
-                }
-
-                total_exponent = 0;
-                for (i=0; i<freq_exponent_idx; i++){
-                    exp_val = freq_exponent_ints[i] * pow(10, freq_exponent_idx-i-1);
-
-                    if (freq_exponent_ints[0] > 0)
-                        total_exponent += exp_val;
-                    else
-                        total_exponent -= exp_val;
-                }
-
-                // Update total frequency, for a final time
-                total_freq = total_freq * pow(10, total_exponent);
-
-                // Save
-                data.fs = total_freq;
-                
-            }
-            else if (strstr(buffer, "iterations") != NULL){
-                continue;
-            }
-            else if (strstr(buffer, "threads") != NULL){
-                start_reading = false;
-                thread_idx = 0;
-                total_threads = 0;
-                total_fft_gflops = 0.0;
-                for (i=0; i<BUFFSIZE; i++){
-
-                    // Get the current character in the string
-                    current_char = buffer[i];
-
-                    // We want to start reading the numbers following the colon
-                    if (current_char == ':')
-                        start_reading = true;
-
-                    if (start_reading == true && current_char == '\n')
-                        break;
-
-                    if (start_reading == true && current_char != ':' && current_char != ' '){
-                        char_as_int = (int)(current_char - '0');
-                        thread_ints[thread_idx] = char_as_int;
-                        thread_idx++;
-                    }
-                }
-
-                // Now that we've filled our 'thread_ints' arr, let's get the number of threads
-                for (i=0; i<thread_idx; i++){
-                    thread_val = thread_ints[i] * pow(10, thread_idx-i-1);
-                    total_threads += thread_val;
-                }
-
-                // Save
-                data.threads = total_threads;
-            }
-            else if (((reached_fft == true && reached_ifft == false) || (reached_fft == false && reached_ifft == true) || (reached_fft == true && reached_ifft == true)) && ((strstr(buffer, "average_gflops") != NULL) || strstr(buffer, "stdev_gflops") != NULL)){
-                start_reading = false;
-                fft_mantissa_idx = 0;
-                fft_fraction_idx = 0;
-                total_fft_gflops = 0;
-                start_fft_fraction = false;                
-                for (i=0; i<BUFFSIZE; i++){
-
-                    // Get the current character in the string
-                    current_char = buffer[i];
-
-                    // We want to start reading the numbers following the colon
-                    if (current_char == ':')
-                        start_reading = true;
-
-                    // The last character is either a comma (,) or a new line (\n)
-                    if ((reached_fft_gflops == false || reached_ifft_gflops == false) && current_char == ',')
-                        break;
-                    else if (current_char == '\n')
-                        break;
-
-                    // If we've reached the . char, then it means we're ready to parse the fraction part
-                    if (current_char == '.'){
-                        start_fft_fraction = true;
-                        continue;
-                    }
-
-                    if (start_reading == true && current_char != ':' && current_char != ' ' && start_fft_fraction == false){
-                        char_as_int = (int)(current_char - '0');
-                        fft_mantissa_ints[fft_mantissa_idx] = char_as_int;
-                        fft_mantissa_idx++;
-                    }
-                    else if (start_reading == true && current_char != ':' && current_char != ' ' && start_fft_fraction == true){
-                        char_as_int = (int)(current_char - '0');
-                        fft_fraction_ints[fft_fraction_idx] = char_as_int;
-                        fft_fraction_idx++;
-                    }
-
-                }
-
-                // Now that we've filled our 'fft_mantissa_ints' and 'fft_fraction_ints' arrs, let's get the fft
-                for (i=0; i<fft_mantissa_idx; i++){
-                    fft_val = fft_mantissa_ints[i] * pow(10, fft_mantissa_idx-i-1);
-                    total_fft_gflops += fft_val;
-                }
-                for (i=0; i<fft_fraction_idx; i++){
-                    fft_val = fft_fraction_ints[i] * pow(10, -i-1);
-                    total_fft_gflops += fft_val;
-                }
-
-                // Save results and set flags
-                if (reached_fft == true && reached_ifft == false){
-
-                    // Store FFT gflops
-                    if (reached_fft_gflops == false){
-                        data.fft_gflops = total_fft_gflops;
-                        reached_fft_gflops = true;
-                    }
-                    else{
-                        data.fft_gflops_stdev = total_fft_gflops;
-                    }
-                }
-                else{
-
-                    // Store IFFT gflops
-                    if (reached_ifft_gflops == false){
-                        data.ifft_gflops = total_fft_gflops;
-                        reached_ifft_gflops = true;
-                    }
-                    else{
-                        data.ifft_gflops_stdev = total_fft_gflops;
-                        reached_ifft = false;
-                        reached_fft = false;
-                        reached_ifft_gflops = false;
-                        reached_fft_gflops = false;
-                    }
-                }
-
-            }
-            else if (strstr(buffer, "forward_dft_results") != NULL){
-                reached_fft = true;
-                printf("REACHED_FFT, ");
-            }
-            else if (strstr(buffer, "backward_dft_results") != NULL){
-                reached_ifft = true;
-                printf("REACHED_IFFT\n");
-            }
-
-            // Store results to array
-            if (performance_result_idx != -1)
-                performance_results[performance_result_idx] = data;
+        // Array to save results to. It grows as records are read, so there is no limit on the
+        // number of runs in the JSON document
+        struct PerformanceDataList performance_list = {NULL, 0, 0};
 
-            // Clear buffer
-            for (i=0; i<BUFFSIZE; i++){
-                buffer[i] = '\0';
-            }
+        // Read every record in the JSON document in a single pass
+        if (json_read_records(json_filename, add_performance_data, &performance_list) < 0){
+            fprintf(stderr, "Could not parse JSON document \"%s\"\n", json_filename);
+            free(performance_list.results);
+            exit(0);
         }
 
         // Print parsed JSON
+        int i,j;
         struct PerformanceData tmp;
         printf("Parsed JSON data:\n\n");
-        for (i=0; i<performance_result_idx+1; i++){
-            tmp = performance_results[i];
+        for (i=0; i<performance_list.count; i++){
+            tmp = performance_list.results[i];
 
             printf("%d Threads\n", tmp.threads);
             printf("    fs: %0.2e\n", tmp.fs);
@@ -458,7 +81,8 @@ int main(int argc, char* argv[]){
             printf("    ifft_gflops: %0.3f +/- %0.3f\n", tmp.ifft_gflops, tmp.ifft_gflops_stdev);
         }
 
-        plot_fft_and_ifft_results(performance_results, performance_result_idx+1);
+        plot_fft_and_ifft_results(performance_list.results, performance_list.count);
+        free(performance_list.results);
     }
     else{
         printf("JSON document \"%s\" does not exist!", json_filename);
@@ -468,6 +92,70 @@ int main(int argc, char* argv[]){
     return 0;
 }
 
+int add_performance_data(JsonRecord *record, void *performance_list){
+/* Converts one record of the JSON document into a PerformanceData struct and appends it
+ *
+ *  Inputs
+ *  ======
+ *     JsonRecord *record
+ *         Flattened record for one run
+ *
+ *     void *performance_list
+ *         The PerformanceDataList to append to
+ *
+ *  Returns
+ *  =======
+ *     0 on success, -1 if memory could not be allocated (which stops the reader)
+ */
+    struct PerformanceDataList *list = (struct PerformanceDataList*)performance_list;
+    struct PerformanceData *results;
+    struct PerformanceData data;
+    JsonField *field;
+    int i, new_capacity;
+
+    memset(&data, 0, sizeof(struct PerformanceData));
+
+    for (i=0; i<record->num_fields; i++){
+        field = &record->fields[i];
+
+        if (json_field_is(field, "performance_results.inputs.rank"))
+            data.rank = (int)json_token_to_long(field->value);
+        else if (json_field_is(field, "performance_results.inputs.fs_Hz"))
+            data.fs = json_token_to_double(field->value);
+        else if (json_field_is(field, "performance_results.inputs.threads"))
+            data.threads = (int)json_token_to_long(field->value);
+        else if (json_field_is(field, "performance_results.forward_dft_results.average_gflops"))
+            data.fft_gflops = json_token_to_double(field->value);
+        else if (json_field_is(field, "performance_results.forward_dft_results.stdev_gflops"))
+            data.fft_gflops_stdev = json_token_to_double(field->value);
+        else if (json_field_is(field, "performance_results.backward_dft_results.average_gflops"))
+            data.ifft_gflops = json_token_to_double(field->value);
+        else if (json_field_is(field, "performance_results.backward_dft_results.stdev_gflops"))
+            data.ifft_gflops_stdev = json_token_to_double(field->value);
+    }
+    json_record_int_array(record, "performance_results.inputs.dims", data.dims, MAX_RANK);
+
+    // Make sure the rank can be used to index 'dims'
+    if (data.rank > MAX_RANK)
+        data.rank = MAX_RANK;
+
+    // Grow the array geometrically
+    if (list->count == list->capacity){
+        new_capacity = (list->capacity == 0) ? INITIAL_NUM_RESULTS : 2 * list->capacity;
+        results = realloc(list->results, new_capacity * sizeof(struct PerformanceData));
+        if (results == NULL){
+            fprintf(stderr, "Could not allocate memory for %d results\n", new_capacity);
+            return -1;
+        }
+        list->results = results;
+        list->capacity = new_capacity;
+    }
+
+    list->results[list->count] = data;
+    list->count++;
+    return 0;
+}
+
 void plot_fft_and_ifft_results(struct PerformanceData *performance_results, int num_results){
 /* Plot the FFT or IFFT results
  *
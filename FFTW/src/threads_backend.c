@@ -0,0 +1,231 @@
+/* Runtime choice of FFTW's threads backend, and a busy OpenMP pool. See threads_backend.h */
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dlfcn.h>
+#include <sys/time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "threads_backend.h"
+
+#define MAX_SYMBOL_LEN 64
+#define BUSY_WORK_LEN 4096      //multiply-adds per unit of busy work
+
+typedef struct {
+    const char *name;           //name of the backend, e.g. "openmp"
+    const char *library_suffix; //suffix of FFTW's library for the backend, e.g. "_omp"
+} BackendLibrary;
+
+static const BackendLibrary BACKEND_LIBRARIES[] = {
+    {"pthreads", "_threads"},
+    {"openmp", "_omp"},
+    {"work-stealing", "_threads"},
+};
+static const int NUM_BACKEND_LIBRARIES = sizeof(BACKEND_LIBRARIES) / sizeof(BACKEND_LIBRARIES[0]);
+
+static void *__load_symbol(ThreadsBackend *backend, const char *function_prefix, const char *function){
+/* Gets '<function_prefix>_<function>' from the backend's library (NULL if it has none) */
+    char symbol[MAX_SYMBOL_LEN];
+
+    snprintf(symbol, MAX_SYMBOL_LEN, "%s_%s", function_prefix, function);
+    return dlsym(backend->handle, symbol);
+}
+
+int threads_backend_open(ThreadsBackend *backend, const char *name, const char *library_name, const char *function_prefix,
+                         WorkPool *work_pool){
+/* Loads FFTW's library for a threads backend. Call this before creating any plans, and call
+ * threads_backend_init before planning with backend->plan_with_nthreads().
+ *
+ * Inputs
+ * ------
+ *     ThreadsBackend *backend
+ *         Holds the backend's library and functions
+ *
+ *     const char *name
+ *         Name of the backend, "pthreads", "openmp" or "work-stealing"
+ *
+ *     const char *library_name
+ *         Name of the core FFTW library of the precision, e.g. "fftw3f", which must already be
+ *         linked in
+ *
+ *     const char *function_prefix
+ *         Prefix of the FFTW functions of the precision, e.g. "fftwf"
+ *
+ *     WorkPool *work_pool
+ *         Pool to run FFTW's parallel loops on, for the work-stealing backend (ignored otherwise)
+ *
+ * Returns
+ * -------
+ *     0 on success, -1 if the backend is unknown or its library could not be loaded
+ */
+    int i;
+    const BackendLibrary *backend_library = NULL;
+
+    memset(backend, 0, sizeof(ThreadsBackend));
+    for (i=0; i<NUM_BACKEND_LIBRARIES; i++){
+        if (strcmp(BACKEND_LIBRARIES[i].name, name) == 0)
+            backend_library = &BACKEND_LIBRARIES[i];
+    }
+    if (backend_library == NULL){
+        fprintf(stderr, "Invalid threads backend '%s'. Please use \"pthreads\", \"openmp\" or \"work-stealing\".\n", name);
+        return -1;
+    }
+    backend->name = backend_library->name;
+
+    // Installed libraries have the versioned name, while FFTW's build tree may only have the
+    // development symlink
+    snprintf(backend->library, MAX_THREADS_LIBRARY_LEN, "lib%s%s.so.3", library_name, backend_library->library_suffix);
+    backend->handle = dlopen(backend->library, RTLD_NOW | RTLD_LOCAL);
+    if (backend->handle == NULL){
+        snprintf(backend->library, MAX_THREADS_LIBRARY_LEN, "lib%s%s.so", library_name, backend_library->library_suffix);
+        backend->handle = dlopen(backend->library, RTLD_NOW | RTLD_LOCAL);
+    }
+    if (backend->handle == NULL){
+        fprintf(stderr, "Could not load the %s threads backend: %s. Was FFTW configured with %s?\n", name, dlerror(),
+                (strcmp(name, "openmp") == 0) ? "--enable-openmp" : "--enable-threads");
+        return -1;
+    }
+
+    backend->init_threads = (int (*)(void))__load_symbol(backend, function_prefix, "init_threads");
+    backend->plan_with_nthreads = (void (*)(int))__load_symbol(backend, function_prefix, "plan_with_nthreads");
+    backend->cleanup_threads = (void (*)(void))__load_symbol(backend, function_prefix, "cleanup_threads");
+    if (backend->init_threads == NULL || backend->plan_with_nthreads == NULL || backend->cleanup_threads == NULL){
+        fprintf(stderr, "'%s' is missing the %s threads functions.\n", backend->library, function_prefix);
+        threads_backend_close(backend);
+        return -1;
+    }
+
+    if (strcmp(name, "work-stealing") == 0){
+        backend->threads_set_callback = __load_symbol(backend, function_prefix, "threads_set_callback");
+        if (backend->threads_set_callback == NULL){
+            fprintf(stderr, "The work-stealing threads backend needs %s_threads_set_callback, which is new in FFTW 3.3.9.\n",
+                    function_prefix);
+            threads_backend_close(backend);
+            return -1;
+        }
+        if (work_pool == NULL){
+            fprintf(stderr, "The work-stealing threads backend needs a work pool.\n");
+            threads_backend_close(backend);
+            return -1;
+        }
+        backend->work_pool = work_pool;
+    }
+
+    return 0;
+}
+
+static void __run_parallel_loop(void *(*work)(char *), char *jobdata, size_t elsize, int njobs, void *data){
+/* Runs one of FFTW's parallel loops on the work pool. FFTW's jobs take a char* to their data,
+ * which is passed the same way as the pool's void*. */
+    work_pool_run((WorkPool*)data, (WorkFunction)work, jobdata, elsize, njobs);
+}
+
+int threads_backend_init(ThreadsBackend *backend){
+/* Initializes FFTW's threads, and hands its parallel loops to the work pool for the
+ * work-stealing backend
+ *
+ * Inputs
+ * ------
+ *     ThreadsBackend *backend
+ *         A backend loaded by threads_backend_open
+ *
+ * Returns
+ * -------
+ *     0 on success, -1 if FFTW's threads could not be initialized
+ */
+    if (backend->init_threads() == 0){
+        fprintf(stderr, "Could not initialize the %s threads backend.\n", backend->name);
+        return -1;
+    }
+    if (backend->work_pool != NULL)
+        backend->threads_set_callback(__run_parallel_loop, backend->work_pool);
+    return 0;
+}
+
+void threads_backend_close(ThreadsBackend *backend){
+/* Unloads the backend's library. Call backend->cleanup_threads() and destroy every plan first. */
+    if (backend->handle != NULL)
+        dlclose(backend->handle);
+    backend->handle = NULL;
+    backend->init_threads = NULL;
+    backend->plan_with_nthreads = NULL;
+    backend->cleanup_threads = NULL;
+    backend->threads_set_callback = NULL;
+    backend->work_pool = NULL;
+}
+
+static void *__run_busy_pool(void *pool_args){
+/* Keeps an OpenMP team of pool->nthreads busy with multiply-adds until pool->stop is set */
+    BusyPool *pool = (BusyPool*)pool_args;
+    double work_units = 0;
+    struct timeval start, stop;
+
+    gettimeofday(&start, NULL);
+#ifdef _OPENMP
+    #pragma omp parallel num_threads(pool->nthreads) reduction(+:work_units)
+    {
+        int i;
+        double x = 1.0 + omp_get_thread_num();
+        volatile double result;
+
+        while (pool->stop == false){
+            for (i=0; i<BUSY_WORK_LEN; i++)
+                x = x * 0.999999 + 1e-6;
+            result = x;
+            work_units += 1;
+        }
+        (void)result;
+    }
+#endif
+    gettimeofday(&stop, NULL);
+
+    // Each unit of work is BUSY_WORK_LEN multiply-adds, i.e. 2 x BUSY_WORK_LEN flops
+    pool->run_time_sec = (stop.tv_sec - start.tv_sec) + (stop.tv_usec - start.tv_usec) * (1e-6);
+    pool->gflops = (pool->run_time_sec > 0) ? 2 * BUSY_WORK_LEN * work_units / pool->run_time_sec * (1e-9) : 0.0;
+    return NULL;
+}
+
+int busy_pool_start(BusyPool *pool, int nthreads){
+/* Starts a busy OpenMP pool, which runs until busy_pool_stop is called
+ *
+ * Inputs
+ * ------
+ *     BusyPool *pool
+ *         The pool to start. If 'nthreads' is 0, there is no pool and busy_pool_stop does nothing.
+ *
+ *     int nthreads
+ *         Number of threads in the OpenMP team
+ *
+ * Returns
+ * -------
+ *     0 on success, -1 if the pool could not be started
+ */
+    memset(pool, 0, sizeof(BusyPool));
+    if (nthreads == 0)
+        return 0;
+
+#ifdef _OPENMP
+    pool->nthreads = nthreads;
+    pool->stop = false;
+    if (pthread_create(&pool->thread, NULL, __run_busy_pool, pool) != 0){
+        fprintf(stderr, "Could not start the busy OpenMP pool.\n");
+        pool->nthreads = 0;
+        return -1;
+    }
+    return 0;
+#else
+    fprintf(stderr, "A busy OpenMP pool needs the benchmark to be built with -fopenmp.\n");
+    return -1;
+#endif
+}
+
+void busy_pool_stop(BusyPool *pool){
+/* Stops a busy OpenMP pool, and sets how long it ran and how many GFlops it got through */
+    if (pool->nthreads == 0)
+        return;
+
+    pool->stop = true;
+    pthread_join(pool->thread, NULL);
+}
@@ -0,0 +1,53 @@
+/* Runtime choice of FFTW's threads backend, shared by the FFTW benchmarks (FFTW3 only).
+ *
+ * FFTW builds its multi-threading into a separate library per backend: libfftw3_threads (POSIX
+ * threads) and libfftw3_omp (OpenMP). Both export the same functions, so only one of them can be
+ * linked in. Instead, the benchmarks link the core library alone and load the backend's library
+ * at runtime, e.g. "libfftw3f_omp.so.3" for --threads-backend openmp in single precision. The
+ * backend's library resolves its FFTW symbols to the core library already loaded in the process.
+ *
+ * The "work-stealing" backend loads the POSIX threads library, but hands FFTW's parallel loops to
+ * a persistent work-stealing pool (see work_pool.h) through fftw_threads_set_callback, instead of
+ * letting FFTW spawn threads for each of them. The callback needs FFTW 3.3.9 or later.
+ *
+ * Processes like TensorFlow already run an OpenMP thread pool next to FFTW. A busy pool simulates
+ * that: an OpenMP team which keeps its threads busy with floating point work, from a thread of its
+ * own, for as long as the benchmark runs (built with -fopenmp only).
+ */
+#ifndef THREADS_BACKEND_H
+#define THREADS_BACKEND_H
+
+#include <stdbool.h>
+#include <pthread.h>
+#include "work_pool.h"
+
+#define MAX_THREADS_LIBRARY_LEN 64
+
+typedef struct {
+    const char *name;                   //"pthreads", "openmp" or "work-stealing"
+    char library[MAX_THREADS_LIBRARY_LEN]; //e.g. "libfftw3_omp.so.3"
+    void *handle;
+    int (*init_threads)(void);
+    void (*plan_with_nthreads)(int nthreads);
+    void (*cleanup_threads)(void);
+    void (*threads_set_callback)(void (*parallel_loop)(void *(*work)(char *), char *jobdata, size_t elsize, int njobs, void *data),
+                                 void *data);
+    WorkPool *work_pool;                //pool the work-stealing backend runs FFTW's loops on (NULL otherwise)
+} ThreadsBackend;
+
+typedef struct {
+    int nthreads;                       //threads in the OpenMP team (0 if there is no busy pool)
+    pthread_t thread;                   //thread the team is started from
+    volatile bool stop;
+    double run_time_sec;
+    double gflops;                      //throughput of the whole team while it ran
+} BusyPool;
+
+int threads_backend_open(ThreadsBackend *backend, const char *name, const char *library_name, const char *function_prefix,
+                         WorkPool *work_pool);
+int threads_backend_init(ThreadsBackend *backend);
+void threads_backend_close(ThreadsBackend *backend);
+int busy_pool_start(BusyPool *pool, int nthreads);
+void busy_pool_stop(BusyPool *pool);
+
+#endif
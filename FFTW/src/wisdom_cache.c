@@ -0,0 +1,289 @@
+/* On-disk cache of FFTW wisdom keyed by host fingerprint. See wisdom_cache.h */
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <fftw3.h>
+#include "wisdom_cache.h"
+
+#define INITIAL_NUM_PLAN_TIMES 8
+#define MAX_CPUINFO_LINE_LEN 1024
+
+const WisdomPrecision WISDOM_DOUBLE = {"double", fftw_import_wisdom_from_filename, fftw_export_wisdom_to_filename};
+
+static void __sanitize(const char *src, char *dest, size_t dest_size){
+/* Copies 'src' into 'dest', replacing anything that is not safe in a filename with '_' and
+ * collapsing repeated replacements, e.g. "Intel(R) Xeon(R) CPU" -> "Intel_R_Xeon_R_CPU"
+ */
+    size_t len = 0;
+    bool replaced = false;
+
+    for (; *src != '\0' && len + 1 < dest_size; src++){
+        if (isalnum((unsigned char)*src) || *src == '.' || *src == '-'){
+            dest[len++] = *src;
+            replaced = false;
+        }
+        else if (replaced == false && len > 0){
+            dest[len++] = '_';
+            replaced = true;
+        }
+    }
+
+    // Drop a trailing replacement
+    if (len > 0 && dest[len-1] == '_')
+        len--;
+    dest[len] = '\0';
+}
+
+static void __cpu_model(char *model, size_t size){
+/* Gets the CPU model name from /proc/cpuinfo (or "unknown_cpu" if there is none) */
+    char line[MAX_CPUINFO_LINE_LEN];
+    char *value;
+    FILE *cpuinfo = fopen("/proc/cpuinfo", "r");
+
+    snprintf(model, size, "unknown_cpu");
+    if (cpuinfo == NULL)
+        return;
+
+    while (fgets(line, MAX_CPUINFO_LINE_LEN, cpuinfo)){
+        // x86 reports "model name", POWER reports "cpu", and ARM reports "CPU part"
+        if (strncmp(line, "model name", 10) != 0 && strncmp(line, "cpu\t", 4) != 0 && strncmp(line, "CPU part", 8) != 0)
+            continue;
+
+        value = strchr(line, ':');
+        if (value == NULL)
+            continue;
+
+        value++;
+        while (isspace((unsigned char)*value))
+            value++;
+        __sanitize(value, model, size);
+        break;
+    }
+
+    fclose(cpuinfo);
+}
+
+static const char *__cpu_isa(void){
+/* Gets the widest SIMD instruction set supported by the CPU, which FFTW picks its codelets from */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return "avx512";
+    if (__builtin_cpu_supports("avx2"))
+        return "avx2";
+    if (__builtin_cpu_supports("avx"))
+        return "avx";
+    if (__builtin_cpu_supports("sse2"))
+        return "sse2";
+    return "x86";
+#elif defined(__aarch64__)
+    return "neon";
+#elif defined(__powerpc64__)
+    return "vsx";
+#else
+    return "generic";
+#endif
+}
+
+void wisdom_cache_fingerprint(char *fingerprint, size_t size){
+/* Builds the host fingerprint that wisdom files are keyed by
+ *
+ * Inputs
+ * ------
+ *     char *fingerprint
+ *         Holds the fingerprint, "<cpu model>__<isa>__<fftw version>"
+ *
+ *     size_t size
+ *         Size of 'fingerprint'
+ */
+    char model[MAX_FINGERPRINT_LEN];
+    char version[MAX_FINGERPRINT_LEN];
+
+    __cpu_model(model, MAX_FINGERPRINT_LEN);
+    __sanitize(fftw_version, version, MAX_FINGERPRINT_LEN);
+    snprintf(fingerprint, size, "%s__%s__%s", model, __cpu_isa(), version);
+}
+
+static PlanTime *__find_plan_time(WisdomCache *cache, const char *problem){
+/* Finds the time it took to plan 'problem' without wisdom (NULL if it was never planned) */
+    int i;
+
+    for (i=0; i<cache->num_plan_times; i++){
+        if (strcmp(cache->plan_times[i].problem, problem) == 0)
+            return &cache->plan_times[i];
+    }
+    return NULL;
+}
+
+static void __set_plan_time(WisdomCache *cache, const char *problem, double plan_time_sec){
+/* Sets the time it took to plan 'problem' without wisdom. A plan which timed out (see
+ * fftw_set_timelimit) leaves only partial wisdom behind, so a later miss on the same problem may
+ * be quicker than planning from scratch; the longest time is kept.
+ */
+    PlanTime *plan_time = __find_plan_time(cache, problem);
+
+    if (plan_time == NULL){
+        if (cache->num_plan_times == cache->plan_times_capacity){
+            cache->plan_times_capacity = (cache->plan_times_capacity == 0) ? INITIAL_NUM_PLAN_TIMES : 2 * cache->plan_times_capacity;
+            cache->plan_times = (PlanTime*)realloc(cache->plan_times, cache->plan_times_capacity * sizeof(PlanTime));
+        }
+        plan_time = &cache->plan_times[cache->num_plan_times++];
+        snprintf(plan_time->problem, MAX_PROBLEM_LEN, "%s", problem);
+    }
+    else if (plan_time->plan_time_sec >= plan_time_sec)
+        return;
+    plan_time->plan_time_sec = plan_time_sec;
+}
+
+static void __read_plan_times(WisdomCache *cache){
+/* Reads the "<seconds> <problem>" lines of the plan times file, if there is one */
+    char line[MAX_PROBLEM_LEN + 64];
+    char *problem;
+    double plan_time_sec;
+    FILE *plan_times_file = fopen(cache->plan_times_path, "r");
+
+    if (plan_times_file == NULL)
+        return;
+
+    while (fgets(line, sizeof(line), plan_times_file)){
+        line[strcspn(line, "\n")] = '\0';
+        plan_time_sec = strtod(line, &problem);
+        if (problem == line || *problem != ' ')
+            continue;
+
+        problem++;
+        if (*problem != '\0')
+            __set_plan_time(cache, problem, plan_time_sec);
+    }
+
+    fclose(plan_times_file);
+}
+
+int wisdom_cache_open(WisdomCache *cache, const char *cache_dir, const WisdomPrecision *precision){
+/* Opens the wisdom cache for this host in 'cache_dir' (creating the directory if needed) and
+ * imports its wisdom. Call this before creating any plans.
+ *
+ * Inputs
+ * ------
+ *     WisdomCache *cache
+ *         The cache to open. If 'cache_dir' is NULL, the cache is disabled and every other
+ *         wisdom_cache_* function does nothing.
+ *
+ *     const char *cache_dir
+ *         Directory holding the wisdom files
+ *
+ *     const WisdomPrecision *precision
+ *         Precision of the plans (e.g. &WISDOM_DOUBLE), whose FFTW library the wisdom is
+ *         imported into and exported from
+ *
+ * Returns
+ * -------
+ *     0 on success, -1 if the directory could not be created
+ */
+    memset(cache, 0, sizeof(WisdomCache));
+    if (cache_dir == NULL)
+        return 0;
+
+    if (mkdir(cache_dir, 0755) == -1 && errno != EEXIST){
+        fprintf(stderr, "Could not create wisdom cache directory '%s'.\n", cache_dir);
+        return -1;
+    }
+
+    wisdom_cache_fingerprint(cache->fingerprint, MAX_FINGERPRINT_LEN);
+    if (precision == &WISDOM_DOUBLE){
+        snprintf(cache->wisdom_path, MAX_WISDOM_PATH_LEN, "%s/%s.wisdom", cache_dir, cache->fingerprint);
+        snprintf(cache->plan_times_path, MAX_WISDOM_PATH_LEN, "%s/%s.plan_times", cache_dir, cache->fingerprint);
+    }
+    else{
+        snprintf(cache->wisdom_path, MAX_WISDOM_PATH_LEN, "%s/%s__%s.wisdom", cache_dir, cache->fingerprint, precision->name);
+        snprintf(cache->plan_times_path, MAX_WISDOM_PATH_LEN, "%s/%s__%s.plan_times", cache_dir, cache->fingerprint, precision->name);
+    }
+
+    cache->enabled = true;
+    cache->precision = precision;
+    cache->imported = precision->import_wisdom(cache->wisdom_path) != 0;
+
+    // Plan times are only meaningful alongside the wisdom they were measured without
+    if (cache->imported)
+        __read_plan_times(cache);
+
+#ifdef DEBUG
+    printf("Wisdom cache: %s (%s)\n", cache->wisdom_path, cache->imported ? "imported" : "not found");
+#endif
+
+    return 0;
+}
+
+void wisdom_cache_record_plan(WisdomCache *cache, const char *problem, bool hit, double plan_time_sec){
+/* Records how long it took to create a plan. Try creating the plan with FFTW_WISDOM_ONLY first:
+ * if that succeeds, the plan is a hit, otherwise plan as usual and record a miss.
+ *
+ * Inputs
+ * ------
+ *     WisdomCache *cache
+ *         The cache the plan was created with
+ *
+ *     const char *problem
+ *         Describes the planned problem (transform kind, dims, threads, rigor). Used to look up
+ *         how long the same problem took to plan without wisdom.
+ *
+ *     bool hit
+ *         Whether the plan was created from wisdom
+ *
+ *     double plan_time_sec
+ *         How long it took to create the plan
+ */
+    PlanTime *plan_time;
+
+    if (cache->enabled == false)
+        return;
+
+    if (hit){
+        cache->num_hits++;
+        plan_time = __find_plan_time(cache, problem);
+        if (plan_time != NULL && plan_time->plan_time_sec > plan_time_sec)
+            cache->plan_time_saved_sec += plan_time->plan_time_sec - plan_time_sec;
+    }
+    else{
+        cache->num_misses++;
+        __set_plan_time(cache, problem, plan_time_sec);
+    }
+}
+
+int wisdom_cache_close(WisdomCache *cache){
+/* Exports the wisdom (if any new plans were created) and frees the cache
+ *
+ * Inputs
+ * ------
+ *     WisdomCache *cache
+ *         The cache to close
+ *
+ * Returns
+ * -------
+ *     0 on success, -1 if the wisdom could not be saved
+ */
+    int i, status = 0;
+    FILE *plan_times_file;
+
+    if (cache->enabled && cache->num_misses > 0){
+        if (cache->precision->export_wisdom(cache->wisdom_path) == 0){
+            fprintf(stderr, "Could not save wisdom to '%s'.\n", cache->wisdom_path);
+            status = -1;
+        }
+        else if ((plan_times_file = fopen(cache->plan_times_path, "w")) != NULL){
+            for (i=0; i<cache->num_plan_times; i++)
+                fprintf(plan_times_file, "%0.6f %s\n", cache->plan_times[i].plan_time_sec, cache->plan_times[i].problem);
+            fclose(plan_times_file);
+        }
+    }
+
+    free(cache->plan_times);
+    cache->plan_times = NULL;
+    cache->num_plan_times = 0;
+    cache->plan_times_capacity = 0;
+    return status;
+}
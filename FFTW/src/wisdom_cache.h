@@ -0,0 +1,58 @@
+/* On-disk cache of FFTW wisdom, shared by the FFTW benchmarks (FFTW3 only).
+ *
+ * Wisdom is only valid on the machine (and FFTW build) it was created on, so every cache file is
+ * keyed by a host fingerprint made of the CPU model, the widest SIMD instruction set the CPU
+ * supports, and the FFTW version, e.g.
+ *
+ *     <cache_dir>/Intel_R_Xeon_R_Platinum_8175M_CPU_2.50GHz__avx512__fftw-3.3.8-sse2-avx.wisdom
+ *
+ * Wisdom of the other precisions goes to "<fingerprint>__<precision>.wisdom". Next to each wisdom
+ * file, the time it took to plan each problem from scratch is kept in a ".plan_times" file, so that
+ * the planning time saved by a cache hit can be reported.
+ */
+#ifndef WISDOM_CACHE_H
+#define WISDOM_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define MAX_WISDOM_PATH_LEN 1024
+#define MAX_FINGERPRINT_LEN 512
+#define MAX_PROBLEM_LEN 256
+
+typedef int (*WisdomFileFunction)(const char *filename);
+
+typedef struct {
+    const char *name;                   //"double", "float", "long-double" or "quad"
+    WisdomFileFunction import_wisdom;   //e.g. fftwf_import_wisdom_from_filename
+    WisdomFileFunction export_wisdom;   //e.g. fftwf_export_wisdom_to_filename
+} WisdomPrecision;
+
+typedef struct {
+    char problem[MAX_PROBLEM_LEN];  //e.g. "r2c rank=2 dims=300x300 threads=4 rigor=measure"
+    double plan_time_sec;           //time it took to plan without wisdom
+} PlanTime;
+
+typedef struct {
+    bool enabled;
+    const WisdomPrecision *precision;
+    char fingerprint[MAX_FINGERPRINT_LEN];
+    char wisdom_path[MAX_WISDOM_PATH_LEN];
+    char plan_times_path[MAX_WISDOM_PATH_LEN];
+    bool imported;                  //whether a wisdom file was found and imported
+    int num_hits;
+    int num_misses;
+    double plan_time_saved_sec;     //sum over hits of (planning time without wisdom - with wisdom)
+    PlanTime *plan_times;
+    int num_plan_times;
+    int plan_times_capacity;
+} WisdomCache;
+
+extern const WisdomPrecision WISDOM_DOUBLE;
+
+void wisdom_cache_fingerprint(char *fingerprint, size_t size);
+int wisdom_cache_open(WisdomCache *cache, const char *cache_dir, const WisdomPrecision *precision);
+void wisdom_cache_record_plan(WisdomCache *cache, const char *problem, bool hit, double plan_time_sec);
+int wisdom_cache_close(WisdomCache *cache);
+
+#endif
@@ -0,0 +1,250 @@
+/* Persistent work-stealing thread pool. See work_pool.h */
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include "work_pool.h"
+
+#define INITIAL_DEQUE_CAPACITY 64
+
+typedef struct {
+    WorkPool *pool;
+    int index;
+} WorkerArgs;
+
+// Pool and deque of the calling thread, if it is a worker (a loop run from inside a job queues its
+// jobs on the worker's own deque)
+static _Thread_local WorkPool *current_pool = NULL;
+static _Thread_local int current_worker = -1;
+
+static void __push(WorkDeque *deque, WorkTask task){
+/* Queues a task at the bottom of a deque, growing it if it is full */
+    int i;
+    WorkTask *tasks;
+
+    pthread_mutex_lock(&deque->lock);
+    if (deque->count == deque->capacity){
+        tasks = (WorkTask*)malloc(2 * deque->capacity * sizeof(WorkTask));
+        for (i=0; i<deque->count; i++)
+            tasks[i] = deque->tasks[(deque->top + i) % deque->capacity];
+        free(deque->tasks);
+        deque->tasks = tasks;
+        deque->capacity *= 2;
+        deque->top = 0;
+    }
+    deque->tasks[(deque->top + deque->count) % deque->capacity] = task;
+    deque->count++;
+    pthread_mutex_unlock(&deque->lock);
+}
+
+static bool __take(WorkDeque *deque, bool bottom, WorkTask *task){
+/* Takes the newest task of a deque (bottom) or its oldest (top). Returns false if it is empty. */
+    bool found = false;
+
+    pthread_mutex_lock(&deque->lock);
+    if (deque->count > 0){
+        if (bottom)
+            *task = deque->tasks[(deque->top + deque->count - 1) % deque->capacity];
+        else{
+            *task = deque->tasks[deque->top];
+            deque->top = (deque->top + 1) % deque->capacity;
+        }
+        deque->count--;
+        found = true;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+static bool __find_task(WorkPool *pool, int self, WorkTask *task){
+/* Finds a task for worker 'self' (-1 for a thread outside the pool): the newest task of its own
+ * deque, or else the oldest task of the first other deque which has one */
+    int i, victim;
+    int start = (self >= 0) ? self : (int)(atomic_load(&pool->next_deque) % pool->num_workers);
+
+    if (self >= 0 && __take(&pool->deques[self], true, task)){
+        atomic_fetch_sub(&pool->pending, 1);
+        return true;
+    }
+    for (i=0; i<pool->num_workers; i++){
+        victim = (start + i) % pool->num_workers;
+        if (victim != self && __take(&pool->deques[victim], false, task)){
+            atomic_fetch_sub(&pool->pending, 1);
+            atomic_fetch_add(&pool->num_steals, 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void __run_task(WorkTask task){
+    WorkBatch *batch = task.batch;
+
+    batch->work(batch->jobs + (size_t)task.job * batch->job_size);
+    atomic_fetch_sub(&batch->remaining, 1);
+}
+
+static void *__run_worker(void *worker_args){
+/* Runs tasks until the pool shuts down, sleeping while there are none */
+    WorkerArgs *args = (WorkerArgs*)worker_args;
+    WorkPool *pool = args->pool;
+    WorkTask task;
+
+    current_pool = pool;
+    current_worker = args->index;
+    free(args);
+
+    while (true){
+        if (__find_task(pool, current_worker, &task)){
+            __run_task(task);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        while (atomic_load(&pool->pending) <= 0 && pool->shutdown == false)
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        if (pool->shutdown){
+            pthread_mutex_unlock(&pool->lock);
+            break;
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+    return NULL;
+}
+
+WorkPool *work_pool_create(int nthreads){
+/* Creates a pool for parallel loops on 'nthreads' threads: the thread which runs a loop, and
+ * nthreads - 1 workers, which are started now and sleep between loops
+ *
+ * Inputs
+ * ------
+ *     int nthreads
+ *         Number of threads to run each loop on
+ *
+ * Returns
+ * -------
+ *     The pool, or NULL if its threads could not be started
+ */
+    int i;
+    WorkerArgs *args;
+    WorkPool *pool = (WorkPool*)calloc(1, sizeof(WorkPool));
+
+    pool->nthreads = (nthreads < 1) ? 1 : nthreads;
+    pool->num_workers = pool->nthreads - 1;
+    pool->threads = (pthread_t*)calloc(pool->num_workers + 1, sizeof(pthread_t));
+    pool->deques = (WorkDeque*)calloc(pool->num_workers + 1, sizeof(WorkDeque));
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    atomic_init(&pool->pending, 0);
+    atomic_init(&pool->next_deque, 0);
+    atomic_init(&pool->num_jobs, 0);
+    atomic_init(&pool->num_steals, 0);
+
+    for (i=0; i<pool->num_workers; i++){
+        pthread_mutex_init(&pool->deques[i].lock, NULL);
+        pool->deques[i].capacity = INITIAL_DEQUE_CAPACITY;
+        pool->deques[i].tasks = (WorkTask*)malloc(INITIAL_DEQUE_CAPACITY * sizeof(WorkTask));
+    }
+
+    for (i=0; i<pool->num_workers; i++){
+        args = (WorkerArgs*)malloc(sizeof(WorkerArgs));
+        args->pool = pool;
+        args->index = i;
+        if (pthread_create(&pool->threads[i], NULL, __run_worker, args) != 0){
+            fprintf(stderr, "Could not start the threads of the work-stealing pool.\n");
+            free(args);
+            pool->num_workers = i;
+            work_pool_destroy(pool);
+            return NULL;
+        }
+    }
+
+    return pool;
+}
+
+void work_pool_run(WorkPool *pool, WorkFunction work, void *jobs, size_t job_size, int njobs){
+/* Runs a parallel loop: calls work(&jobs[j]) for every job j, and returns once they have all
+ * finished. May be called from inside a job.
+ *
+ * Inputs
+ * ------
+ *     WorkPool *pool
+ *         The pool to run the jobs on
+ *
+ *     WorkFunction work
+ *         Function which runs one job
+ *
+ *     void *jobs, size_t job_size, int njobs
+ *         Array of the jobs' arguments, size of each, and number of jobs
+ */
+    int j;
+    int self = (current_pool == pool) ? current_worker : -1;
+    WorkBatch batch;
+    WorkTask task;
+
+    if (njobs <= 0)
+        return;
+    atomic_fetch_add(&pool->num_jobs, njobs);
+
+    // Without workers, or with a single job, there is nothing to share
+    if (pool->num_workers == 0 || njobs == 1){
+        for (j=0; j<njobs; j++)
+            work((char*)jobs + (size_t)j * job_size);
+        return;
+    }
+
+    batch.work = work;
+    batch.jobs = (char*)jobs;
+    batch.job_size = job_size;
+    atomic_init(&batch.remaining, njobs);
+
+    // Queue every job but the first, which this thread runs right away. A worker queues them on its
+    // own deque for the others to steal; a thread outside the pool spreads them over the workers.
+    for (j=1; j<njobs; j++){
+        task.batch = &batch;
+        task.job = j;
+        __push(&pool->deques[(self >= 0) ? self : (int)(atomic_fetch_add(&pool->next_deque, 1) % pool->num_workers)], task);
+    }
+    pthread_mutex_lock(&pool->lock);
+    atomic_fetch_add(&pool->pending, njobs - 1);
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    task.batch = &batch;
+    task.job = 0;
+    __run_task(task);
+
+    // Help with any queued job (of this loop or another) until this loop's jobs are done
+    while (atomic_load(&batch.remaining) > 0){
+        if (__find_task(pool, self, &task))
+            __run_task(task);
+        else
+            sched_yield();
+    }
+}
+
+void work_pool_destroy(WorkPool *pool){
+/* Stops the workers and frees the pool. No loop may be running. */
+    int i;
+
+    if (pool == NULL)
+        return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = true;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    for (i=0; i<pool->num_workers; i++)
+        pthread_join(pool->threads[i], NULL);
+
+    for (i=0; i<pool->nthreads - 1; i++){
+        pthread_mutex_destroy(&pool->deques[i].lock);
+        free(pool->deques[i].tasks);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->wake);
+    free(pool->deques);
+    free(pool->threads);
+    free(pool);
+}
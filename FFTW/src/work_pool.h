@@ -0,0 +1,61 @@
+/* Persistent work-stealing thread pool, shared by the parallel stages of the FFTW benchmarks.
+ *
+ * Each worker owns a deque of jobs. A parallel loop queues its jobs on the deque of the thread
+ * that runs it (or spreads them over the workers if that thread is not one of them), then helps
+ * run jobs until its own are done. Idle workers take the newest job of their own deque first, and
+ * steal the oldest job of another worker's deque otherwise, so nested loops (e.g. FFTW's threaded
+ * plans inside a batch loop) keep every thread busy without spawning threads.
+ *
+ * With --threads-backend work-stealing, FFTW runs its parallel loops on the pool through
+ * fftw_threads_set_callback (FFTW 3.3.9 or later), and so do the input generation and the batch
+ * loop of the N-D cosine benchmark.
+ */
+#ifndef WORK_POOL_H
+#define WORK_POOL_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+typedef void *(*WorkFunction)(void *job);
+
+typedef struct {
+    WorkFunction work;
+    char *jobs;                 //array of 'njobs' jobs of 'job_size' bytes each
+    size_t job_size;
+    atomic_int remaining;       //jobs which have not finished yet
+} WorkBatch;
+
+typedef struct {
+    WorkBatch *batch;
+    int job;                    //index of the job in the batch
+} WorkTask;
+
+typedef struct {
+    pthread_mutex_t lock;
+    WorkTask *tasks;            //ring buffer. The owner pushes and pops at the bottom, thieves steal from the top.
+    int capacity;
+    int top;
+    int count;
+} WorkDeque;
+
+typedef struct WorkPool {
+    int nthreads;               //threads running jobs, including the thread which runs a loop
+    int num_workers;            //nthreads - 1 threads of the pool
+    pthread_t *threads;
+    WorkDeque *deques;          //one per worker
+    pthread_mutex_t lock;       //guards sleeping and 'shutdown'
+    pthread_cond_t wake;
+    atomic_int pending;         //jobs queued on the deques
+    atomic_uint next_deque;     //deque the next job of a thread outside the pool is queued on
+    bool shutdown;
+    atomic_long num_jobs;       //jobs run since the pool was created
+    atomic_long num_steals;     //jobs taken from a deque other than the runner's own
+} WorkPool;
+
+WorkPool *work_pool_create(int nthreads);
+void work_pool_run(WorkPool *pool, WorkFunction work, void *jobs, size_t job_size, int njobs);
+void work_pool_destroy(WorkPool *pool);
+
+#endif
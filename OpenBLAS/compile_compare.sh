@@ -1,2 +1,10 @@
 #!/bin/bash
-gcc src/compare.c -o compare_gemm_results -lm -Wall
+
+# The shared results reader lives in common/src in the repository, but is copied next to the
+# sources in the containers
+COMMON_SRC=../common/src
+if [ ! -d ${COMMON_SRC} ]; then
+    COMMON_SRC=src
+fi
+
+gcc src/compare.c ${COMMON_SRC}/results_json.c ${COMMON_SRC}/results_stats.c ${COMMON_SRC}/results_compare.c -I${COMMON_SRC} -o compare_gemm_results -lm -lpthread -Wall
@@ -4,18 +4,22 @@
 #include <unistd.h>
 #include <string.h>
 #include <math.h>
-#include <regex.h>
 #include <time.h>
-#include <sys/time.h>
+#include "results_json.h"
+#include "results_stats.h"
+#include "results_compare.h"
 
-#define BUFFSIZE 4096
-#define MAX_ENTRIES 50
-#define MAX_FILENAME_LEN 100
+#define INITIAL_CAPACITY 16
 #define MAX_DATETIME_LEN 24
-#define PRECISION 1e-5
+#define MAX_LIBRARY_LEN 128
+#define DEFAULT_EFFICIENCY_THRESHOLD 70.0  //percent parallel efficiency
+#define DEFAULT_MIN_SHIFT 2.0              //percent change in execution time
+#define DEFAULT_MIN_SEGMENT_LEN 2          //runs
+#define EXECUTION_TIMES_PATH "performance_results.execution_times_seconds["
 
 typedef struct {
     char datetime[MAX_DATETIME_LEN];
+    char library[MAX_LIBRARY_LEN];    //BLAS library fingerprint (empty for older result files)
     int gemm_type;
     int num_threads;
     int num_iters;
@@ -27,33 +31,157 @@ typedef struct {
     double gflops_approx;
     double avg_execution_time_sec;
     double execution_time_stdev;
+    int num_execution_times;          //per-iteration times (only saved by newer versions of gemm_test.c)
+    double execution_time_sum;
+    double execution_time_sum_sq;
 } PerformanceEntry;
 
 typedef struct {
-    double gflops_approx[MAX_ENTRIES];
-    double avg_execution_time_sec[MAX_ENTRIES];
-    double execution_time_stdev[MAX_ENTRIES];
-    char datetimes[MAX_ENTRIES][MAX_DATETIME_LEN];
+    int gemm_type;
     int M;
     int N;
     int K;
     double alpha;
     double beta;
+    int num_threads;
+    char library[MAX_LIBRARY_LEN];
+} ProfileKey;
+
+typedef struct {
+    double gflops_approx;
+    double avg_execution_time_sec;
+    double execution_time_stdev;
+    char datetime[MAX_DATETIME_LEN];
+    ProfileKey key;
     int num_profiles;
 } CommonProfile; 
 
+typedef struct {
+    CommonProfile *profiles;
+    int count;
+    int capacity;
+} ProfileList;
+
+typedef struct {
+    char *filename;
+    ProfileList *sgemm_profiles;
+    ProfileList *dgemm_profiles;
+    KeyIndex *index;              //maps a profile key to its position in the sgemm/dgemm list
+    int num_entries;
+    int sgemm_count;
+    int dgemm_count;
+} ProfileBuilder;
+
+typedef struct {
+    ProfileKey key;
+    SampleStats samples;
+} ScalingGroup;
+
+typedef struct {
+    char *filename;
+    ScalingGroup *groups;
+    int count;
+    int capacity;
+    KeyIndex index;       //maps a profile key to its position in 'groups'
+    int num_entries;
+    int num_invalid;      //entries which failed validate_entry()
+} ScalingBuilder;
+
+typedef struct {
+    int num_threads;
+    int num_samples;
+    double avg_execution_time_sec;
+    double gflops_approx;
+    double speedup;             //relative to the smallest thread count measured
+    double efficiency;          //speedup per thread, in percent
+} ScalingPoint;
+
+typedef struct {
+    double amdahl_serial_fraction;
+    double amdahl_max_speedup;      //1 / serial fraction (infinite for a serial fraction of 0)
+    double amdahl_r_squared;        //goodness of fit of the execution times
+    double gustafson_serial_fraction;
+} ScalingFit;
+
+typedef struct {
+    char datetime[MAX_DATETIME_LEN];
+    long long timestamp;        //sortable form of 'datetime'
+    int order;                  //file and position the run was read from, used to break ties
+    double avg_execution_time_sec;
+} HistoryPoint;
+
+typedef struct {
+    ProfileKey key;
+    HistoryPoint *points;
+    int count;
+    int capacity;
+} HistorySeries;
+
+typedef struct {
+    char *filename;
+    HistorySeries *series;
+    int count;
+    int capacity;
+    KeyIndex index;       //maps a profile key to its position in 'series'
+    int num_entries;
+    int num_invalid;      //entries which failed validate_entry()
+} HistoryBuilder;
+
+typedef void (*EntryHandler)(PerformanceEntry *entry, void *handler_args);
+
+typedef struct {
+    EntryHandler handle_entry;
+    void *handler_args;
+} EntryReader;
+
 bool input_is_positive_number(char number[]);
-void read_json(char *json_filename, PerformanceEntry *entries, int *num_entries);
-int __parse_int(char *buffer);
-void __parse_int_array(char *buffer, int *dim1, int *dim2);
-double __parse_double(char *buffer);
+int read_json(char *json_filename, EntryHandler handle_entry, void *handler_args);
+int __record_to_entry(JsonRecord *record, void *reader_args);
 void check_dims(PerformanceEntry entry, bool *valid_M, bool *valid_N, bool *valid_K);
-int get_max_performance_index(CommonProfile cprofile);
-void print_common_profile_max_performance(CommonProfile cprofile, char *profile_type, int profile_id, int max_idx);
-void save_results_to_json_file(char *gemm_type, int num_files, int entry_counts[], CommonProfile **cprofiles);
+bool validate_entry(PerformanceEntry *entry);
+void read_profiles_task(int file_id, void *task_args);
+void read_scaling_groups_task(int file_id, void *task_args);
+ScalingGroup *scaling_group_find_or_create(ScalingBuilder *builder, ProfileKey *key);
+void entry_to_profile_key(PerformanceEntry *entry, ProfileKey *key);
+int profile_index_find(KeyIndex *index, ProfileKey *key);
+void profile_index_insert(KeyIndex *index, ProfileKey *key, int value);
+void add_entry_to_profiles(PerformanceEntry *entry, void *handler_args);
+void add_entry_to_scaling_groups(PerformanceEntry *entry, void *handler_args);
+void entry_to_sample_stats(PerformanceEntry *entry, SampleStats *stats);
+bool read_scaling_groups(char **files, int num_files, ScalingBuilder *builder);
+int compare_scaling_groups(const void *group1, const void *group2);
+bool profile_key_same_shape(ProfileKey *key1, ProfileKey *key2);
+void fit_scaling_models(ScalingPoint *points, int num_points, ScalingFit *fit);
+int run_scaling_analysis(int argc, char *argv[]);
+long long datetime_to_timestamp(char *datetime);
+HistorySeries *history_series_find_or_create(HistoryBuilder *builder, ProfileKey *key);
+void history_series_append(HistorySeries *series, HistoryPoint *point);
+void add_entry_to_history(PerformanceEntry *entry, void *handler_args);
+void read_history_task(int file_id, void *task_args);
+int compare_history_points(const void *point1, const void *point2);
+double estimate_noise_stdev(double *values, int num_values);
+int detect_changepoints(double *values, int num_values, double penalty, int min_segment_len, int *changepoints);
+int run_history_analysis(int argc, char *argv[]);
+CommonProfile *profile_list_append(ProfileList *profile_list);
+void profile_list_free(ProfileList *profile_list);
+void print_common_profile_max_performance(CommonProfile cprofile, char *profile_type, int profile_id);
+void save_results_to_json_file(char *gemm_type, int num_files, ProfileList *profile_lists);
 
 int main(int argc, char *argv[]){
 
+    // Statistical comparison of a baseline and a candidate result set, through the shared
+    // schema-driven gate of common/src/results_compare.c
+    if (argc > 1 && strcmp(argv[1], "regress") == 0)
+        return run_regression_gate(argc - 2, argv + 2, "compare_gemm_results", &RESULT_SCHEMAS[GEMM_SCHEMA], 1);
+
+    // Thread-scaling analysis of a result set
+    if (argc > 1 && strcmp(argv[1], "scaling") == 0)
+        return run_scaling_analysis(argc - 2, argv + 2);
+
+    // Changepoint detection over the history of each profile
+    if (argc > 1 && strcmp(argv[1], "history") == 0)
+        return run_history_analysis(argc - 2, argv + 2);
+
     char *input_err_str = "Required args: Number of files, followed by the files themselves. e.g., \"2 file1.json file2.json\"";
     if (argc == 1){
         fprintf(stderr, "No args were passed. %s.\n", input_err_str);
@@ -86,7 +214,7 @@ int main(int argc, char *argv[]){
     }
 
     // Parse file names
-    char **files = malloc(sizeof(char*) * num_files * MAX_FILENAME_LEN);
+    char **files = malloc(sizeof(char*) * num_files);
     char *filename;
     int i;
     for (i=0; i<num_files; i++){
@@ -101,354 +229,73 @@ int main(int argc, char *argv[]){
         }
     }
 
-    // For a given JSON document, all the entries will be stored in an 'entries' array
-    PerformanceEntry entries[MAX_ENTRIES];
+    // For all JSON documents, sgemm and dgemm entries are folded into per-file lists of common
+    // profiles as they are read. Entries are never stored themselves, so memory grows with the
+    // number of unique profiles rather than with the number of runs in the history.
+    ProfileList *sgemm_profiles = calloc(num_files, sizeof(ProfileList));
+    ProfileList *dgemm_profiles = calloc(num_files, sizeof(ProfileList));
+    KeyIndex *profile_indices = calloc(num_files, sizeof(KeyIndex));
 
-    // For all JSON documents, sgemm and dgemm entries will be stored in their own matrix
-    PerformanceEntry **sgemm_entries = (PerformanceEntry**)malloc(sizeof(PerformanceEntry*) * num_files);
-    PerformanceEntry **dgemm_entries = (PerformanceEntry**)malloc(sizeof(PerformanceEntry*) * num_files);
-    for (i=0; i<MAX_ENTRIES; i++){
-        sgemm_entries[i] = (PerformanceEntry*)malloc(sizeof(PerformanceEntry) * MAX_ENTRIES);
-        dgemm_entries[i] = (PerformanceEntry*)malloc(sizeof(PerformanceEntry) * MAX_ENTRIES);
+    // Every file gets its own builder, so files can be read in parallel without sharing any state
+    ProfileBuilder *builders = calloc(num_files, sizeof(ProfileBuilder));
+    for (i=0; i<num_files; i++){
+        builders[i].filename = files[i];
+        builders[i].sgemm_profiles = &sgemm_profiles[i];
+        builders[i].dgemm_profiles = &dgemm_profiles[i];
+        builders[i].index = &profile_indices[i];
     }
 
-    // Set up variables
-    int num_entries;              //keeps track of the number of entries found in the JSON file
-    int j;                        //iterative variable
-    int sgemm_count, dgemm_count; //keeps track of how many sgemm and dgemm results we have
-    PerformanceEntry entry;       //temporary variable
-    int *sgemm_entry_counts = malloc(sizeof(int) * num_files);
-    int *dgemm_entry_counts = malloc(sizeof(int) * num_files);
-
 #ifdef DEBUG
     printf("Reading JSON Files\n");
     printf("=======================\n");
 #endif
 
-    // Process JSON file(s)
-    for (i=0; i<num_files; i++){
-#ifdef DEBUG
-        printf("Reading file %d of %d\n", i+1, num_files);
-#endif
-
-        // Set counts to zero
-        sgemm_count = 0;
-        dgemm_count = 0;
-
-        // Read the JSON file and capture the entries
-        read_json(files[i], entries, &num_entries);
-
-        // For each entry, break it down into sgemm or dgemm
-        for (j=0; j<num_entries; j++){
-            entry = entries[j];
-
-            if (entry.gemm_type == 1){
-                sgemm_entries[i][sgemm_count] = entry;
-                sgemm_count++;
-            }
-            else{
-                dgemm_entries[i][dgemm_count] = entry;
-                dgemm_count++;
-            }
-        }
-
-        // Update the number of entry counts for sgemm and dgemm for the current file
-        sgemm_entry_counts[i] = sgemm_count;
-        dgemm_entry_counts[i] = dgemm_count;
+    // Process JSON file(s), one file per task on a pool of threads
+    run_file_tasks(num_files, read_profiles_task, builders);
 
+    for (i=0; i<num_files; i++){
+        if (builders[i].num_entries < 0)
+            exit(0);
 #ifdef DEBUG
-        printf("   - # of sgemm entries: %d\n", sgemm_count);
-        printf("   - # of dgemm entries: %d\n", dgemm_count);
+        printf("File %d of %d: %s\n", i+1, num_files, files[i]);
+        printf("   - # of entries: %d\n", builders[i].num_entries);
+        printf("   - # of sgemm entries: %d\n", builders[i].sgemm_count);
+        printf("   - # of dgemm entries: %d\n", builders[i].dgemm_count);
 #endif
     }
+    free(builders);
 
-
-    // Prepare to process sgemm and dgemm entries to see if we're looking at the same parameters
-    CommonProfile **sgemm_cprofiles = (CommonProfile**)malloc(sizeof(CommonProfile*) * num_files);
-    CommonProfile **dgemm_cprofiles = (CommonProfile**)malloc(sizeof(CommonProfile*) * num_files);
-
-    for (i=0; i<MAX_ENTRIES; i++){
-        sgemm_cprofiles[i] = (CommonProfile*)malloc(sizeof(CommonProfile) * MAX_ENTRIES);
-        dgemm_cprofiles[i] = (CommonProfile*)malloc(sizeof(CommonProfile) * MAX_ENTRIES);
-    }
-
+#ifdef DEBUG
     // Initialize temporary/intermediate variables
-    int h, g, profile_idx, M, N, K, existing_M, existing_N, existing_K, existing_idx;
-    double alpha, beta, existing_alpha, existing_beta;
+    int h;
     CommonProfile cprofile;
-    bool unique_profile, valid_M, valid_N, valid_K;
-    char *invalid_dimension_error = "<< ERROR >> Dimension %s is invalid. %s must be a positive integer, and must align across matrices.\n";
-#ifdef DEBUG
-        printf("\nFinding common profiles\n");
-        printf("=======================\n");
-#endif
-    for (i=0; i<num_files; i++){
 
-        profile_idx = 0;
-        unique_profile = true;
-
-        // DGEMM
-        for (j=0; j<dgemm_entry_counts[i]; j++){
-            
-            // Get current entry in the current file
-            entry = dgemm_entries[i][j];
-
-            // Check number of iterations and threads (to make sure the run was valid, even though we're
-            // not actually processing this data)
-            if (entry.num_threads <= 0)
-                fprintf(stderr, "<< ERROR >> Number of threads is invalid: %d\n", entry.num_threads);
-
-            if (entry.num_iters <= 0)
-                fprintf(stderr, "<< ERROR >> Number of iterations is invalid: %d\n", entry.num_iters);
-
-            // Check validity of dimensions
-            check_dims(entry, &valid_M, &valid_N, &valid_K);
-            if (valid_M == false)
-                fprintf(stderr, invalid_dimension_error, "M", "M");
-            if (valid_N == false)
-                fprintf(stderr, invalid_dimension_error, "N", "N");
-            if (valid_K == false)
-                fprintf(stderr, invalid_dimension_error, "K", "K");
-            if (valid_M == false || valid_N == false || valid_K == false || entry.num_threads <= 0 || entry.num_iters <= 0)
-                exit(0);
-
-            // Get alpha and beta
-            alpha = entry.alpha;
-            beta = entry.beta;
-
-            // Get M, N, and K
-            M = entry.matrix_A_dims[0];
-            N = entry.matrix_B_dims[1];
-            K = entry.matrix_B_dims[1];
-
-            // Make sure alpha and beta are greater than or equal to zeroi. But since alpha
-            // and beta are doubles, we have to check for +0 and -0
-            if (alpha >= 0 && beta >= 0){
-
-                // Check if the current dimension is unique
-                for (h=0; h<profile_idx; h++){
-                    
-                    // Get existing unique M, N, and K values
-                    existing_M = dgemm_cprofiles[i][h].M;
-                    existing_N = dgemm_cprofiles[i][h].N;
-                    existing_K = dgemm_cprofiles[i][h].K;
-
-                    // Get existing alpha and beta values
-                    existing_alpha = dgemm_cprofiles[i][h].alpha;
-                    existing_beta = dgemm_cprofiles[i][h].beta;
-
-                    // We (possibly) have a unique profile if we have a unique combination of M, N, K, alpha, and beta
-                    if (M != existing_M || N != existing_N || K != existing_K || alpha != existing_alpha || beta != existing_beta){
-                        unique_profile = true;
-                    }
-                    else{
-                        unique_profile = false;
-                        break;
-                    }
-                }
-            }
-            else{
-                fprintf(stderr, "alpha and beta must be greater than or equal to 0\n");
-                exit(0);
-            }
-
-            // If we have a unique profile, let's create one
-            if (unique_profile == true){
-
-#ifdef DEBUG
-                printf("Creating unique DGEMM profile #%d under %s\n", profile_idx+1, files[i]);
-                printf("    <> Dims:\n");
-                printf("        - M: %d\n", M);
-                printf("        - N: %d\n", N);
-                printf("        - K: %d\n", K);
-                printf("    <> Scalar values:\n");
-                printf("        - alpha: %0.2f\n", alpha);
-                printf("        - beta:  %0.2f\n", beta);
-#endif
-
-                // Add data to 'cprofile' temp var
-                cprofile.M = M;
-                cprofile.N = N;
-                cprofile.K = K;
-                cprofile.alpha = alpha;
-                cprofile.beta = beta;
-                cprofile.gflops_approx[0] = entry.gflops_approx;
-                cprofile.avg_execution_time_sec[0] = entry.avg_execution_time_sec;
-                cprofile.execution_time_stdev[0] = entry.execution_time_stdev;
-                cprofile.num_profiles = 1;
-                for (g=0; g<MAX_DATETIME_LEN; g++)
-                    cprofile.datetimes[0][g] = entry.datetime[g];
-
-                // Add the profile to the unique profiles
-                dgemm_cprofiles[i][profile_idx] = cprofile;
-                profile_idx++;
-            }
-            else{
-#ifdef DEBUG
-                printf("Appending DGEMM profile #%d with new data\n", h+1);
-                printf("   New entry: ");
-                for (g=0; g<MAX_DATETIME_LEN; g++)
-                    printf("%c", entry.datetime[g]);
-                printf("\n");
-#endif
-
-                // Update existing cprofile
-                existing_idx = dgemm_cprofiles[i][h].num_profiles;
-                dgemm_cprofiles[i][h].gflops_approx[existing_idx]          = entry.gflops_approx;
-                dgemm_cprofiles[i][h].avg_execution_time_sec[existing_idx] = entry.avg_execution_time_sec;
-                dgemm_cprofiles[i][h].execution_time_stdev[existing_idx]   = entry.execution_time_stdev;
-                dgemm_cprofiles[i][h].num_profiles += 1;
-                for (g=0; g<MAX_DATETIME_LEN; g++)
-                    dgemm_cprofiles[i][h].datetimes[existing_idx][g] = entry.datetime[g];
-            }
-        }
-
-        profile_idx = 0;
-        unique_profile = true;
-
-        // SGEMM
-        for (j=0; j<sgemm_entry_counts[i]; j++){
-            
-            // Get current entry in the current file
-            entry = sgemm_entries[i][j];
-
-            // Check number of iterations and threads (to make sure the run was valid, even though we're
-            // not actually processing this data)
-            if (entry.num_threads <= 0)
-                fprintf(stderr, "Number of threads is invalid: %d\n", entry.num_threads);
-
-            if (entry.num_iters <= 0)
-                fprintf(stderr, "Number of iterations is invalid: %d\n", entry.num_iters);
-
-            // Check validity of dimensions
-            check_dims(entry, &valid_M, &valid_N, &valid_K);
-            if (valid_M == false)
-                fprintf(stderr, invalid_dimension_error, "M", "M");
-            if (valid_N == false)
-                fprintf(stderr, invalid_dimension_error, "N", "N");
-            if (valid_K == false)
-                fprintf(stderr, invalid_dimension_error, "K", "K");
-            if (valid_M == false || valid_N == false || valid_K == false || entry.num_threads <= 0 || entry.num_iters <= 0)
-                exit(0);
-
-            // Get alpha and beta
-            alpha = entry.alpha;
-            beta = entry.beta;
-
-            // Get M, N, and K
-            M = entry.matrix_A_dims[0];
-            N = entry.matrix_B_dims[1];
-            K = entry.matrix_B_dims[1];
-
-            // Check if the current dimension is unique
-            if (alpha >= 0 && beta >= 0){
-                for (h=0; h<profile_idx; h++){
-                    
-                    // Get existing unique M, N, and K values
-                    existing_M = sgemm_cprofiles[i][h].M;
-                    existing_N = sgemm_cprofiles[i][h].N;
-                    existing_K = sgemm_cprofiles[i][h].K;
-
-                    // Get existing alpha and beta values
-                    existing_alpha = sgemm_cprofiles[i][h].alpha;
-                    existing_beta = sgemm_cprofiles[i][h].beta;
-
-                    // We (possibly) have a unique profile if we have a unique combination of M, N, K, alpha, and beta
-                    if (M != existing_M || N != existing_N || K != existing_K || alpha != existing_alpha || beta != existing_beta){
-                        unique_profile = true;
-                    }
-                    else{
-                        unique_profile = false;
-                        break;
-                    }
-                }
-            }
-            else{
-                fprintf(stderr, "alpha and beta must be greater than or equal to 0\n");
-                exit(0);
-            }
-
-            // If we have a unique profile, let's create one
-            if (unique_profile == true){
-
-#ifdef DEBUG
-                printf("Creating unique SGEMM profile #%d under %s\n", profile_idx+1, files[i]);
-                printf("    <> Dims:\n");
-                printf("        - M: %d\n", M);
-                printf("        - N: %d\n", N);
-                printf("        - K: %d\n", K);
-                printf("    <> Scalar values:\n");
-                printf("        - alpha: %0.2f\n", alpha);
-                printf("        - beta:  %0.2f\n", beta);
-#endif
-
-                // Add data to 'cprofile' temp var
-                cprofile.M = M;
-                cprofile.N = N;
-                cprofile.K = K;
-                cprofile.alpha = alpha;
-                cprofile.beta = beta;
-                cprofile.gflops_approx[0] = entry.gflops_approx;
-                cprofile.avg_execution_time_sec[0] = entry.avg_execution_time_sec;
-                cprofile.execution_time_stdev[0] = entry.execution_time_stdev;
-                cprofile.num_profiles = 1;
-                for (g=0; g<MAX_DATETIME_LEN; g++)
-                    cprofile.datetimes[0][g] = entry.datetime[g];
-
-                // Add the profile to the unique profiles
-                sgemm_cprofiles[i][profile_idx] = cprofile;
-                profile_idx++;
-            }
-            else{
-#ifdef DEBUG
-                printf("Appending SGEMM profile #%d with new data\n", h+1);
-                printf("   New entry: ");
-                for (g=0; g<MAX_DATETIME_LEN; g++)
-                    printf("%c", entry.datetime[g]);
-                printf("\n");
-#endif
-
-                // Update existing cprofile
-                existing_idx = sgemm_cprofiles[i][h].num_profiles;
-                sgemm_cprofiles[i][h].gflops_approx[existing_idx]          = entry.gflops_approx;
-                sgemm_cprofiles[i][h].avg_execution_time_sec[existing_idx] = entry.avg_execution_time_sec;
-                sgemm_cprofiles[i][h].execution_time_stdev[existing_idx]   = entry.execution_time_stdev;
-                sgemm_cprofiles[i][h].num_profiles += 1;
-                for (g=0; g<MAX_DATETIME_LEN; g++)
-                    sgemm_cprofiles[i][h].datetimes[existing_idx][g] = entry.datetime[g];
-            }
-        }
-    }
-
-#ifdef DEBUG
     printf("\n");
     printf("List of profiles found\n");
     printf("=======================\n");
     for (i=0; i<num_files; i++){
-        if (dgemm_entry_counts[i] == 0 && sgemm_entry_counts[i] == 0)
+        if (dgemm_profiles[i].count == 0 && sgemm_profiles[i].count == 0)
             continue;
         printf("%s\n", files[i]);
-        h = 0;
-        if (dgemm_entry_counts[i] != 0){
-            while (dgemm_cprofiles[i][h].M != 0){
+        if (dgemm_profiles[i].count != 0){
+            for (h=0; h<dgemm_profiles[i].count; h++){
                 printf("    <> DGEMM profile #%d:\n", h+1);
-                cprofile = dgemm_cprofiles[i][h];
-                printf("        - (M, N, K): (%d,%d,%d)\n", cprofile.M, cprofile.N, cprofile.K);
-                printf("        - (alpha, beta): (%0.2f,%0.2f)\n", cprofile.alpha, cprofile.beta);
+                cprofile = dgemm_profiles[i].profiles[h];
+                printf("        - (M, N, K): (%d,%d,%d)\n", cprofile.key.M, cprofile.key.N, cprofile.key.K);
+                printf("        - (alpha, beta): (%0.2f,%0.2f)\n", cprofile.key.alpha, cprofile.key.beta);
+                printf("        - threads: %d\n", cprofile.key.num_threads);
                 printf("        - %d data point(s)\n", cprofile.num_profiles);
-                h++;
             }
             printf("\n");
         }
-        if (sgemm_entry_counts[i] != 0){
-            h = 0;
-            while (sgemm_cprofiles[i][h].M != 0){
+        if (sgemm_profiles[i].count != 0){
+            for (h=0; h<sgemm_profiles[i].count; h++){
                 printf("    <> SGEMM profile #%d:\n", h+1);
-                cprofile = sgemm_cprofiles[i][h];
-                printf("        - (M, N, K): (%d,%d,%d)\n", cprofile.M, cprofile.N, cprofile.K);
-                printf("        - (alpha, beta): (%0.2f,%0.2f)\n", cprofile.alpha, cprofile.beta);
+                cprofile = sgemm_profiles[i].profiles[h];
+                printf("        - (M, N, K): (%d,%d,%d)\n", cprofile.key.M, cprofile.key.N, cprofile.key.K);
+                printf("        - (alpha, beta): (%0.2f,%0.2f)\n", cprofile.key.alpha, cprofile.key.beta);
+                printf("        - threads: %d\n", cprofile.key.num_threads);
                 printf("        - %d data point(s)\n", cprofile.num_profiles);
-                h++;
             }
             printf("\n");
         }
@@ -456,71 +303,33 @@ int main(int argc, char *argv[]){
     printf("Performance Results\n");
     printf("=======================\n");
 
-    // Find max performance for each common profile
-    int max_sgemm_idx, max_dgemm_idx;
+    // Print the max performance for each common profile
     for (i=0; i<num_files; i++){
 
         printf("%s\n", files[i]);
 
         // For each file, we want to iterate through each common profile
-        if (sgemm_entry_counts[i] != 0){
-            h = 0;
-            while (sgemm_cprofiles[i][h].M != 0){
-
-                // Extract the current profile
-                cprofile = sgemm_cprofiles[i][h];
-
-                // Get M, N, and K (for printing results)
-                M = cprofile.M;
-                N = cprofile.N;
-                K = cprofile.K;
-
-                // Do the same for alpha and beta
-                alpha = cprofile.alpha;
-                beta = cprofile.beta;
-
-                // Get the index that points to the max sgemm gflops value
-                max_sgemm_idx = get_max_performance_index(cprofile);
-
-                // Print performance
-                print_common_profile_max_performance(cprofile, "SGEMM", h+1, max_sgemm_idx);
-
-                // Update h
-                h++;
-            }
-        }
-        if (dgemm_entry_counts[i] != 0){
-            h = 0;
-            while (dgemm_cprofiles[i][h].M != 0){
-
-                // Extract the current profile
-                cprofile = dgemm_cprofiles[i][h];
-
-                // Get M, N, and K (for printing results)
-                M = cprofile.M;
-                N = cprofile.N;
-                K = cprofile.K;
-
-                // Do the same for alpha and beta
-                alpha = cprofile.alpha;
-                beta = cprofile.beta;
-
-                // Get the index that points to the max sgemm gflops value
-                max_dgemm_idx = get_max_performance_index(cprofile);
-
-                // Print performance
-                print_common_profile_max_performance(cprofile, "DGEMM", h+1, max_dgemm_idx);
-
-                // Update h
-                h++;
-            }
-        }
+        for (h=0; h<sgemm_profiles[i].count; h++)
+            print_common_profile_max_performance(sgemm_profiles[i].profiles[h], "SGEMM", h+1);
+        for (h=0; h<dgemm_profiles[i].count; h++)
+            print_common_profile_max_performance(dgemm_profiles[i].profiles[h], "DGEMM", h+1);
     }
 #endif
 
     // Save results
-    save_results_to_json_file("sgemm", num_files, sgemm_entry_counts, sgemm_cprofiles);
-    save_results_to_json_file("dgemm", num_files, dgemm_entry_counts, dgemm_cprofiles);
+    save_results_to_json_file("sgemm", num_files, sgemm_profiles);
+    save_results_to_json_file("dgemm", num_files, dgemm_profiles);
+
+    // Free memory
+    for (i=0; i<num_files; i++){
+        profile_list_free(&sgemm_profiles[i]);
+        profile_list_free(&dgemm_profiles[i]);
+        key_index_free(&profile_indices[i]);
+    }
+    free(sgemm_profiles);
+    free(dgemm_profiles);
+    free(profile_indices);
+    free(files);
 
     return 0;
 }
@@ -549,329 +358,107 @@ bool input_is_positive_number(char number[]){
     return true;
 };
 
-void read_json(char *json_filename, PerformanceEntry *entries, int *num_entries){
-/* Reads a JSON file and parses it, outputting everything to a PerformanceEntry struct
+int read_json(char *json_filename, EntryHandler handle_entry, void *handler_args){
+/* Reads a JSON file in a single pass and parses it one entry at a time. Each entry is handed to
+ * 'handle_entry' as soon as it is complete, so only a single entry is ever held in memory
+ * regardless of how many runs have accumulated in the file.
  *
  * Inputs
  * ------
  *     char *json_filename
  *         Name of the JSON file to parse
  *
- *     PerformanceEntry *entries
- *         List of entries for performance results
- *
- *     int num_entries
- *         Number of entries found
- */
-
-    // Define performance entry struct
-    PerformanceEntry entry;
-
-    // Keep track of the number of entries
-    int performance_entry_count = 0;
-    
-    // Create buffer
-    char buffer[BUFFSIZE] = {'\0'};
-
-    // Open JSON file
-    FILE *json_file = fopen(json_filename, "r");
-
-    // Define YYYY MM DD HH:MM:SS regex pattern
-    char *yyyy_mm_dd_pattern = "([0-9]{4})\\-(0?[1-9]|1[012])\\-(0?[1-9]|[12][0-9]|3[01]) ([01]?[0-9]|2[0-3]):([0-5]?[0-9]):([0-5][0-9])";
-
-    // Initialize variables for regex.h regex function
-    regex_t regex;
-    int reti;
-    size_t nmatch = 1;
-    regmatch_t pmatch[nmatch];
-
-    int len;
-    char datetime_result[MAX_DATETIME_LEN];
-
-    int i,j;
-    bool parse_inputs, parse_performance_results;
-    int dim1, dim2;
-    while (fgets(buffer, BUFFSIZE, json_file)){
-
-        // We don't need or want to process brackets
-        if (buffer[0] == '{')
-            continue;
-        if (strstr(buffer, "}") != NULL)
-            continue;
-
-        // Compile regex
-        reti = regcomp(&regex, yyyy_mm_dd_pattern, REG_EXTENDED);
-        if (reti){
-            fprintf(stderr, "Could not compile regex\n");
-            exit(0);
-        }
-
-        // Search for match
-        reti = regexec(&regex, buffer, nmatch, pmatch, REG_NOTBOL);
-
-        // If there's no match, then it means we haven't found a datetime string yet
-        if (reti == 0){
-            for (j=0; j<nmatch; j++){
-                len = pmatch[j].rm_eo - pmatch[j].rm_so;
-                memcpy(datetime_result, buffer + pmatch[j].rm_so, len);
-                datetime_result[len] = 0;
-
-                for (i=0; i<MAX_DATETIME_LEN; i++){
-                    entry.datetime[i] = datetime_result[i];
-                }
-            }
-            continue;
-        }
-
-        // Check if we're ready to parse inputs or performance results
-        if (strstr(buffer, "inputs") != NULL){
-            parse_inputs = true;
-            parse_performance_results = false;
-            performance_entry_count++;
-            continue;
-        }
-        else if (strstr(buffer, "performance_results") != NULL){
-            parse_performance_results = true;
-            parse_inputs = false;
-            continue;
-        }
-        
-        // We're at the stage where we need to parse the inputs
-        if (parse_inputs == true){
-
-            if (strstr(buffer, "sgemm") != NULL){
-                entry.gemm_type = 1;
-            }
-            else if (strstr(buffer, "dgemm") != NULL){
-                entry.gemm_type = 2;
-            }
-            else if (strstr(buffer, "iterations") != NULL){
-                entry.num_iters = __parse_int(buffer);
-            }
-            else if (strstr(buffer, "threads") != NULL){
-                entry.num_threads = __parse_int(buffer);
-            }
-            else if (strstr(buffer, "matrix_A") != NULL){
-                __parse_int_array(buffer, &dim1, &dim2);
-                entry.matrix_A_dims[0] = dim1;
-                entry.matrix_A_dims[1] = dim2;
-            }
-            else if (strstr(buffer, "matrix_B") != NULL){
-                __parse_int_array(buffer, &dim1, &dim2);
-                entry.matrix_B_dims[0] = dim1;
-                entry.matrix_B_dims[1] = dim2;
-            }
-            else if (strstr(buffer, "matrix_C") != NULL){
-                __parse_int_array(buffer, &dim1, &dim2);
-                entry.matrix_C_dims[0] = dim1;
-                entry.matrix_C_dims[1] = dim2;
-            }
-            else if (strstr(buffer, "alpha") != NULL){
-               entry.alpha = __parse_double(buffer);
-            }
-            else if (strstr(buffer, "beta") != NULL){
-               entry.beta = __parse_double(buffer);
-            }
-        }
-        else if (parse_performance_results == true){
-            if (strstr(buffer, "average_execution_time_seconds") != NULL){
-                entry.avg_execution_time_sec = __parse_double(buffer);
-            }
-            else if (strstr(buffer, "standard_deviation_seconds") != NULL){
-                entry.execution_time_stdev = __parse_double(buffer);
-            }
-            else if (strstr(buffer, "average_gflops") != NULL){
-                entry.gflops_approx = __parse_double(buffer);
-            }
-        }
-
-        if (performance_entry_count > 0)
-            entries[performance_entry_count - 1] = entry;
-
-        for (j=0; j<BUFFSIZE; j++)
-            buffer[j] = '\0';
-
-
-    }
-
-    // Close JSON file
-    fclose(json_file);
-
-    // Save
-    *num_entries = performance_entry_count;
-}
-
-int __parse_int(char buffer[]){
-/* Parses an integer from a JSON file. Do not call this function directly!
+ *     EntryHandler handle_entry
+ *         Function called once for every parsed entry
  *
- * Inputs
- * ------
- *     char *buffer
- *         String buffer to parse
+ *     void *handler_args
+ *         Arguments passed through to 'handle_entry'
  *
  * Returns
  * -------
- *     int parsed_integer
- *         Integer that has been parsed
+ *     int performance_entry_count
+ *         Number of entries found, or a negative value if the file could not be parsed
  */
-    bool start_parse = false;
-    char current_char = '\0';
-    int char_as_int;
-    int parsed_integer = 0;
-    int sign = 1;
-    int i;
-    for (i=0; i<BUFFSIZE; i++){
-
-        // Get current character in the buffer
-        current_char = buffer[i];    
-
-        // We want to start parsing once we reach the ':' char
-        if (current_char != ':' && start_parse == false){
-            continue;
-        }
-        else if (current_char == ':'){
-            start_parse = true;
-            continue;
-        }
+    EntryReader reader;
+    reader.handle_entry = handle_entry;
+    reader.handler_args = handler_args;
 
-        if (current_char == '-')
-            sign = -1;
+    int performance_entry_count = json_read_records(json_filename, __record_to_entry, &reader);
+    if (performance_entry_count < 0)
+        fprintf(stderr, "Could not parse %s\n", json_filename);
 
-        if (current_char >= '0' && current_char <= '9'){
-            char_as_int = current_char - '0';
-            parsed_integer *= 10;
-            parsed_integer += char_as_int;
-        }
-    }
-    parsed_integer *= sign;
-    return parsed_integer;
+    return performance_entry_count;
 }
 
-void __parse_int_array(char buffer[], int *dim1, int *dim2){
-/* Parses an integer array from a JSON file. Do not call this function directly!
+int __record_to_entry(JsonRecord *record, void *reader_args){
+/* Converts a flattened JSON record into a performance entry and hands it off. Do not call this
+ * function directly!
  *
  * Inputs
  * ------
- *     char *buffer
- *         String buffer to parse
- *
- *     int *dims_arr
- *         Array which will hold the dimensions
- */
-    bool start_parse = false;
-    bool start_dim1 = false;
-    bool start_dim2 = false;
-    char current_char = '\0';
-    int char_as_int;
-    int parsed_integer1 = 0;
-    int parsed_integer2 = 0;
-    int i;
-    for (i=0; i<BUFFSIZE; i++){
-
-        // Get current character in the buffer
-        current_char = buffer[i];    
-
-        // We want to start parsing once we reach the ':' char
-        if (current_char != ':' && start_parse == false)
-            continue;
-        else if (current_char == ':'){
-            start_parse = true;
-            continue;
-        }
-
-        // If we've reached the bracket char, that means we're at the start of the list
-        if (current_char == '['){
-            start_dim1 = true;
-            continue;
-        }
-
-        // If we've reached the comma char, that means we're ready to parse the second dimension
-        if (current_char == ','){
-            start_dim2 = true;
-            start_dim1 = false;
-            continue;
-        }
-
-        if (current_char == ']')
-            break;
-
-        // If we've reached a digit, we're ready to start parsing
-        if (current_char != ' ' && current_char != '\0' && current_char != '\n' && current_char != ']'){
-            char_as_int = current_char - '0';
-
-            if (start_dim1 == true){
-                parsed_integer1 = parsed_integer1 * 10;
-                parsed_integer1 += char_as_int;
-            }
-            else if (start_dim2 == true){
-                parsed_integer2 = parsed_integer2 * 10;
-                parsed_integer2 += char_as_int;
-            }
-            else{
-                fprintf(stderr, "Unknown error occurred. Exiting now.\n");
-                exit(0);
-            }
-        }
-    }
-
-    // Save results
-    *dim1 = parsed_integer1;
-    *dim2 = parsed_integer2;
-}
-
-double __parse_double(char buffer[]){
-/* Parses a double
+ *     JsonRecord *record
+ *         The record to convert
  *
- * Inputs
- * ------
- *     char *buffer
- *         String buffer to parse
+ *     void *reader_args
+ *         An EntryReader holding the entry handler and its arguments
  *
  * Returns
  * -------
- *     double parsed_double
- *         Parsed double value
+ *     0, so that reading continues
  */
-    bool start_parse = false;
-    bool start_decimal = false;
-    char current_char = '\0';
-    int char_as_int;
-    double parsed_double = 0;
-    double parsed_decimal_part = 0;
-    int decimal_count = 0;
+    EntryReader *reader = (EntryReader*)reader_args;
+    PerformanceEntry entry;
+    JsonField *field;
+    double time_sec;
+    size_t len;
     int i;
-    for (i=0; i<BUFFSIZE; i++){
-
-        // Get current character in the buffer
-        current_char = buffer[i];    
 
-        // We want to start parsing once we reach the ':' char
-        if (current_char != ':' && start_parse == false)
-            continue;
-        else if (current_char == ':'){
-            start_parse = true;
-            continue;
-        }
+    memset(&entry, 0, sizeof(PerformanceEntry));
 
-        if (current_char == '.'){
-            start_decimal = true;
-            continue;
-        }
+    // The record's key is its timestamp
+    len = (record->key_length < MAX_DATETIME_LEN - 1) ? record->key_length : MAX_DATETIME_LEN - 1;
+    memcpy(entry.datetime, record->key, len);
+    entry.datetime[len] = '\0';
 
-        if (current_char >= '0' && current_char <= '9'){
+    for (i=0; i<record->num_fields; i++){
+        field = &record->fields[i];
 
-            char_as_int = current_char - '0';
-            if (start_decimal == false){
-                parsed_double *= 10;
-                parsed_double += (double)char_as_int;
-            }
-            else{
-                parsed_decimal_part += (double)(char_as_int * pow(10,-decimal_count-1));
-                decimal_count++;
-            }
+        if (json_field_is(field, "inputs.blas_library"))
+            json_token_copy(field->value, entry.library, MAX_LIBRARY_LEN);
+        else if (json_field_is(field, "inputs.gemm_type")){
+            if (json_token_equals(field->value, "sgemm"))
+                entry.gemm_type = 1;
+            else if (json_token_equals(field->value, "dgemm"))
+                entry.gemm_type = 2;
+        }
+        else if (json_field_is(field, "inputs.iterations"))
+            entry.num_iters = (int)json_token_to_long(field->value);
+        else if (json_field_is(field, "inputs.threads"))
+            entry.num_threads = (int)json_token_to_long(field->value);
+        else if (json_field_is(field, "inputs.matrix_params.scalar_values.alpha"))
+            entry.alpha = json_token_to_double(field->value);
+        else if (json_field_is(field, "inputs.matrix_params.scalar_values.beta"))
+            entry.beta = json_token_to_double(field->value);
+        else if (json_field_is(field, "performance_results.average_execution_time_seconds"))
+            entry.avg_execution_time_sec = json_token_to_double(field->value);
+        else if (json_field_is(field, "performance_results.standard_deviation_seconds"))
+            entry.execution_time_stdev = json_token_to_double(field->value);
+        else if (json_field_is(field, "performance_results.average_gflops"))
+            entry.gflops_approx = json_token_to_double(field->value);
+        else if (strncmp(field->path, EXECUTION_TIMES_PATH, strlen(EXECUTION_TIMES_PATH)) == 0){
+            time_sec = json_token_to_double(field->value);
+            entry.num_execution_times++;
+            entry.execution_time_sum += time_sec;
+            entry.execution_time_sum_sq += time_sec * time_sec;
         }
     }
-    return parsed_double + parsed_decimal_part;
+
+    json_record_int_array(record, "inputs.matrix_params.dims.matrix_A", entry.matrix_A_dims, 2);
+    json_record_int_array(record, "inputs.matrix_params.dims.matrix_B", entry.matrix_B_dims, 2);
+    json_record_int_array(record, "inputs.matrix_params.dims.matrix_C", entry.matrix_C_dims, 2);
+
+    reader->handle_entry(&entry, reader->handler_args);
+    return 0;
 }
 
 void check_dims(PerformanceEntry entry, bool *valid_M, bool *valid_N, bool *valid_K){
@@ -922,78 +509,315 @@ void check_dims(PerformanceEntry entry, bool *valid_M, bool *valid_N, bool *vali
             *valid_K = true;
 }
 
-int get_max_performance_index(CommonProfile cprofile){
-/* Gets the max performance in GFlops found in the entire profile
+void read_profiles_task(int file_id, void *task_args){
+/* Reads one file into its own ProfileBuilder
  *
  * Inputs
  * ------
- *     CommonProfile cprofile
- *         The common profile to assess, which contains the results
- *         of various runs in GFlops
+ *     int file_id
+ *         Index of the file (and of its builder)
  *
- * Returns
- * -------
- *     int max_performance_idx
- *         The index value which points to the location of the max
- *         performance in the CommonProfile
+ *     void *task_args
+ *         Array of ProfileBuilders, one per file
  */
-    int j, max_performance_idx, max_gflops, gflops_approx;
-    max_performance_idx = -1;
-    max_gflops = -1;
-    for (j=0; j<cprofile.num_profiles; j++){
-        gflops_approx = cprofile.gflops_approx[j];
-        if (gflops_approx > max_gflops){
-            max_gflops = gflops_approx;
-            max_performance_idx = j;
-        }
-    }
-    return max_performance_idx;
+    ProfileBuilder *builder = &((ProfileBuilder*)task_args)[file_id];
+
+    // Stream the JSON file, handing each entry to the profile builder as soon as it is complete
+    builder->num_entries = read_json(builder->filename, add_entry_to_profiles, builder);
 }
 
-void print_common_profile_max_performance(CommonProfile cprofile, char *profile_type, int profile_id, int max_idx){
-/* Prints the common profile information where the performance is
- * at its maximum.
+void read_scaling_groups_task(int file_id, void *task_args){
+/* Reads one file into its own ScalingBuilder
  *
  * Inputs
  * ------
- *     CommonProfile cprofile
- *         The common profile to print results from
+ *     int file_id
+ *         Index of the file (and of its builder)
  *
- *     char *profile_type
- *         SGEMM or DGEMM
+ *     void *task_args
+ *         Array of ScalingBuilders, one per file
+ */
+    ScalingBuilder *builder = &((ScalingBuilder*)task_args)[file_id];
+    builder->num_entries = read_json(builder->filename, add_entry_to_scaling_groups, builder);
+}
+
+bool validate_entry(PerformanceEntry *entry){
+/* Checks that a performance entry describes a valid run, and prints why if it does not
  *
- *     int profile_id
- *         ID of the profile
+ * Inputs
+ * ------
+ *     PerformanceEntry *entry
+ *         The entry to check
  *
- *     int max_idx
- *         The index that corresponds to the max performance in
- *         the custom profile
+ * Returns
+ * -------
+ *     false if the entry is invalid
  */
-    int M = cprofile.M;
-    int N = cprofile.N;
-    int K = cprofile.K;
-    double alpha = cprofile.alpha;
-    double beta = cprofile.beta;
-    int g;
+    bool valid_M, valid_N, valid_K;
+    char *invalid_dimension_error = "<< ERROR >> Dimension %s is invalid. %s must be a positive integer, and must align across matrices.\n";
 
-    printf("    %s Profile #%d\n", profile_type, profile_id);
-    printf("        |- M: %d\n", M);
-    printf("        |- N: %d\n", N);
-    printf("        |- K: %d\n", K);
-    printf("        |- alpha: %0.2f\n", alpha);
-    printf("        |- beta: %0.2f\n", beta);
-    printf("        Timestamp: ");
-    for (g=0; g<MAX_DATETIME_LEN; g++){
-        printf("%c", cprofile.datetimes[max_idx][g]);
+    // Check number of iterations and threads (to make sure the run was valid, even though we're
+    // not actually processing this data)
+    if (entry->num_threads <= 0)
+        fprintf(stderr, "<< ERROR >> Number of threads is invalid: %d\n", entry->num_threads);
+
+    if (entry->num_iters <= 0)
+        fprintf(stderr, "<< ERROR >> Number of iterations is invalid: %d\n", entry->num_iters);
+
+    // Check validity of dimensions
+    check_dims(*entry, &valid_M, &valid_N, &valid_K);
+    if (valid_M == false)
+        fprintf(stderr, invalid_dimension_error, "M", "M");
+    if (valid_N == false)
+        fprintf(stderr, invalid_dimension_error, "N", "N");
+    if (valid_K == false)
+        fprintf(stderr, invalid_dimension_error, "K", "K");
+    if (valid_M == false || valid_N == false || valid_K == false || entry->num_threads <= 0 || entry->num_iters <= 0)
+        return false;
+
+    // Make sure alpha and beta are greater than or equal to zero. But since alpha
+    // and beta are doubles, we have to check for +0 and -0
+    if (entry->alpha < 0 || entry->beta < 0){
+        fprintf(stderr, "alpha and beta must be greater than or equal to 0\n");
+        return false;
     }
-    printf("\n");
-    printf("        Max GFlops: %0.2f\n", cprofile.gflops_approx[max_idx]);
+    return true;
 }
 
-void save_results_to_json_file(char *gemm_type, int num_files, int entry_counts[], CommonProfile **cprofiles){
-/* Saves compared performance results to a JSON file for interpreting
+void entry_to_profile_key(PerformanceEntry *entry, ProfileKey *key){
+/* Builds the key which identifies the common profile of a performance entry
  *
- *  Inputs
+ * Inputs
+ * ------
+ *     PerformanceEntry *entry
+ *         The entry to build the key for
+ *
+ *     ProfileKey *key
+ *         The key to fill
+ */
+    // Zero the whole struct so that keys can be hashed and compared byte for byte without
+    // worrying about padding or leftover characters in 'library'
+    memset(key, 0, sizeof(ProfileKey));
+
+    // A = [M x K], B = [K x N]
+    key->gemm_type = entry->gemm_type;
+    key->M = entry->matrix_A_dims[0];
+    key->N = entry->matrix_B_dims[1];
+    key->K = entry->matrix_A_dims[1];
+
+    // +0 and -0 are the same profile, but hash differently
+    key->alpha = (entry->alpha == 0) ? 0.0 : entry->alpha;
+    key->beta = (entry->beta == 0) ? 0.0 : entry->beta;
+
+    key->num_threads = entry->num_threads;
+    memcpy(key->library, entry->library, MAX_LIBRARY_LEN);
+}
+
+int profile_index_find(KeyIndex *index, ProfileKey *key){
+/* Looks up a profile key in a hash index
+ *
+ * Inputs
+ * ------
+ *     KeyIndex *index
+ *         The index to search
+ *
+ *     ProfileKey *key
+ *         The key to look for, built by entry_to_profile_key()
+ *
+ * Returns
+ * -------
+ *     int value
+ *         The value stored with the key, or -1 if the key is not in the index
+ */
+    return key_index_find(index, key, sizeof(ProfileKey));
+}
+
+void profile_index_insert(KeyIndex *index, ProfileKey *key, int value){
+/* Inserts a profile key which is not yet in the index, and exits if memory runs out
+ *
+ * Inputs
+ * ------
+ *     KeyIndex *index
+ *         The index to insert into
+ *
+ *     ProfileKey *key
+ *         The new key, built by entry_to_profile_key()
+ *
+ *     int value
+ *         Value to store with the key (a position in a list of profiles)
+ */
+    if (key_index_insert(index, key, sizeof(ProfileKey), value) == -1){
+        fprintf(stderr, "Could not allocate memory for profile #%d in the index\n", index->count + 1);
+        exit(0);
+    }
+}
+
+void add_entry_to_profiles(PerformanceEntry *entry, void *handler_args){
+/* Validates a single performance entry and folds it into the common profile it belongs to,
+ * creating a new common profile if no existing one matches. Only the running count and the
+ * max performance data point of each profile are kept.
+ *
+ * Inputs
+ * ------
+ *     PerformanceEntry *entry
+ *         The entry to add
+ *
+ *     void *handler_args
+ *         A ProfileBuilder which holds the profile lists for the current file
+ */
+    ProfileBuilder *builder = (ProfileBuilder*)handler_args;
+    ProfileList *profile_list;
+    CommonProfile *cprofile;
+    ProfileKey key;
+    int h;
+
+    // Choose the list of profiles to add to
+    if (entry->gemm_type == 1){
+        profile_list = builder->sgemm_profiles;
+        builder->sgemm_count++;
+    }
+    else{
+        profile_list = builder->dgemm_profiles;
+        builder->dgemm_count++;
+    }
+#ifdef DEBUG
+    char *profile_type = (entry->gemm_type == 1) ? "SGEMM" : "DGEMM";
+#endif
+
+    // Make sure the run was valid before using it
+    if (validate_entry(entry) == false)
+        exit(0);
+
+    // We have a unique profile if we have a unique combination of gemm type, M, N, K, alpha, beta,
+    // threads, and library. Profiles are looked up through the hash index, so each entry is
+    // grouped in constant time.
+    entry_to_profile_key(entry, &key);
+    h = profile_index_find(builder->index, &key);
+
+    // If we have a unique profile, let's create one
+    if (h == -1){
+
+#ifdef DEBUG
+        printf("Creating unique %s profile #%d under %s\n", profile_type, profile_list->count+1, builder->filename);
+        printf("    <> Dims:\n");
+        printf("        - M: %d\n", key.M);
+        printf("        - N: %d\n", key.N);
+        printf("        - K: %d\n", key.K);
+        printf("    <> Scalar values:\n");
+        printf("        - alpha: %0.2f\n", key.alpha);
+        printf("        - beta:  %0.2f\n", key.beta);
+        printf("    <> Threads: %d\n", key.num_threads);
+        printf("    <> Library: %s\n", key.library);
+#endif
+
+        profile_index_insert(builder->index, &key, profile_list->count);
+        cprofile = profile_list_append(profile_list);
+        cprofile->key = key;
+        cprofile->num_profiles = 0;
+    }
+    else{
+        cprofile = &profile_list->profiles[h];
+#ifdef DEBUG
+        printf("Appending %s profile #%d with new data\n", profile_type, h+1);
+        printf("   New entry: %s\n", entry->datetime);
+#endif
+    }
+
+    // Keep the data point if it is the max performance seen so far for this profile
+    if (cprofile->num_profiles == 0 || entry->gflops_approx > cprofile->gflops_approx){
+        cprofile->gflops_approx = entry->gflops_approx;
+        cprofile->avg_execution_time_sec = entry->avg_execution_time_sec;
+        cprofile->execution_time_stdev = entry->execution_time_stdev;
+        memcpy(cprofile->datetime, entry->datetime, MAX_DATETIME_LEN);
+    }
+    cprofile->num_profiles += 1;
+}
+
+CommonProfile *profile_list_append(ProfileList *profile_list){
+/* Appends a zeroed common profile to a profile list, growing the list geometrically so that
+ * appending stays amortized constant time
+ *
+ * Inputs
+ * ------
+ *     ProfileList *profile_list
+ *         The list to append to
+ *
+ * Returns
+ * -------
+ *     CommonProfile *cprofile
+ *         Pointer to the new profile. Only valid until the next append.
+ */
+    CommonProfile *profiles;
+    int new_capacity;
+
+    if (profile_list->count == profile_list->capacity){
+        new_capacity = (profile_list->capacity == 0) ? INITIAL_CAPACITY : 2 * profile_list->capacity;
+        profiles = realloc(profile_list->profiles, sizeof(CommonProfile) * new_capacity);
+        if (profiles == NULL){
+            fprintf(stderr, "Could not allocate memory for %d common profiles\n", new_capacity);
+            exit(0);
+        }
+        profile_list->profiles = profiles;
+        profile_list->capacity = new_capacity;
+    }
+
+    memset(&profile_list->profiles[profile_list->count], 0, sizeof(CommonProfile));
+    profile_list->count++;
+    return &profile_list->profiles[profile_list->count - 1];
+}
+
+void profile_list_free(ProfileList *profile_list){
+/* Frees the memory held by a profile list
+ *
+ * Inputs
+ * ------
+ *     ProfileList *profile_list
+ *         The list to free
+ */
+    free(profile_list->profiles);
+    profile_list->profiles = NULL;
+    profile_list->count = 0;
+    profile_list->capacity = 0;
+}
+
+void print_common_profile_max_performance(CommonProfile cprofile, char *profile_type, int profile_id){
+/* Prints the common profile information where the performance is
+ * at its maximum.
+ *
+ * Inputs
+ * ------
+ *     CommonProfile cprofile
+ *         The common profile to print results from
+ *
+ *     char *profile_type
+ *         SGEMM or DGEMM
+ *
+ *     int profile_id
+ *         ID of the profile
+ */
+    int M = cprofile.key.M;
+    int N = cprofile.key.N;
+    int K = cprofile.key.K;
+    double alpha = cprofile.key.alpha;
+    double beta = cprofile.key.beta;
+
+    printf("    %s Profile #%d\n", profile_type, profile_id);
+    printf("        |- M: %d\n", M);
+    printf("        |- N: %d\n", N);
+    printf("        |- K: %d\n", K);
+    printf("        |- alpha: %0.2f\n", alpha);
+    printf("        |- beta: %0.2f\n", beta);
+    printf("        |- threads: %d\n", cprofile.key.num_threads);
+    if (cprofile.key.library[0] != '\0')
+        printf("        |- library: %s\n", cprofile.key.library);
+    printf("        Timestamp: %s\n", cprofile.datetime);
+    printf("        Max GFlops: %0.2f\n", cprofile.gflops_approx);
+}
+
+void save_results_to_json_file(char *gemm_type, int num_files, ProfileList *profile_lists){
+/* Saves compared performance results to a JSON file for interpreting
+ *
+ *  Inputs
  *  ------
  *      char *gemm_type
  *          The *GEMM routine. (either "sgemm" or "dgemm")
@@ -1001,15 +825,14 @@ void save_results_to_json_file(char *gemm_type, int num_files, int entry_counts[
  *      int num_files
  *          Number of files processed
  *
- *      int entry_counts[]
- *          Number of entries in `cprofiles`
- *
- *      CommonProfile cprofiles[][]
- *          Common profiles
+ *      ProfileList *profile_lists
+ *          Common profiles, one list per file
  *
  */
     // Initialize vars for processing loop
-    int g, h, i, max_idx, M, N, K;
+    int g, h, i, M, N, K;
+    int profile_id = 0;
+    int num_profiles_total = 0;
     double alpha, beta, gflops, avg_time_sec, avg_time_stdev;
     CommonProfile cprofile;
     char current_char;
@@ -1048,71 +871,68 @@ void save_results_to_json_file(char *gemm_type, int num_files, int entry_counts[
     }
 
     // The filename which we will save the results to
-    char filename_buffer[40];
-    sprintf(filename_buffer, "openblas_%s_results_%d-%d-%d_%d:%c%c:%c%c", gemm_type, year, month, day, hour, min_str[0], min_str[1], sec_str[0], sec_str[1]);
+    char filename_buffer[64];
+    snprintf(filename_buffer, sizeof(filename_buffer), "openblas_%s_results_%d-%d-%d_%d:%c%c:%c%c", gemm_type, year, month, day, hour, min_str[0], min_str[1], sec_str[0], sec_str[1]);
     char *results_filename = filename_buffer;
 
     // Create file now
     FILE *results_json = fopen(results_filename, "w");
 
-    // Find max performance for each common profile and save to JSON
+    // Count the profiles across all files so we know which one is last (for the trailing comma)
+    for (i=0; i<num_files; i++)
+        num_profiles_total += profile_lists[i].count;
+
+    // Save the max performance for each common profile to JSON
     fprintf(results_json, "{\n");
     fprintf(results_json, "    \"%s\": {\n", gemm_type);
     for (i=0; i<num_files; i++){
 
         // For each file, we want to iterate through each common profile
-        if (entry_counts[i] == 0)
-            continue;
-
-        h = 0;
-        while (cprofiles[i][h].M != 0){
+        for (h=0; h<profile_lists[i].count; h++){
 
             // Extract the current profile
-            cprofile = cprofiles[i][h];
-
-            // Get the index that points to the max sgemm gflops value
-            max_idx = get_max_performance_index(cprofile);
+            cprofile = profile_lists[i].profiles[h];
+            profile_id++;
 
             // Get cprofile matrix data
-            M = cprofile.M;
-            N = cprofile.N;
-            K = cprofile.K;
-            alpha = cprofile.alpha;
-            beta = cprofile.beta;
+            M = cprofile.key.M;
+            N = cprofile.key.N;
+            K = cprofile.key.K;
+            alpha = cprofile.key.alpha;
+            beta = cprofile.key.beta;
 
             // Get cprofile gflops and average time data
-            gflops = cprofile.gflops_approx[max_idx]; 
-            avg_time_sec = cprofile.avg_execution_time_sec[max_idx];
-            avg_time_stdev = cprofile.execution_time_stdev[max_idx];
+            gflops = cprofile.gflops_approx;
+            avg_time_sec = cprofile.avg_execution_time_sec;
+            avg_time_stdev = cprofile.execution_time_stdev;
 
             // Save to results JSON file
-            fprintf(results_json, "        \"profile%d\": {\n", h+1);
+            fprintf(results_json, "        \"profile%d\": {\n", profile_id);
             fprintf(results_json, "            \"matrix_info\": {\n");
             fprintf(results_json, "                \"M\": %d,\n", M);
             fprintf(results_json, "                \"N\": %d,\n", N);
             fprintf(results_json, "                \"K\": %d,\n", K);
             fprintf(results_json, "                \"alpha\": %0.2f,\n", alpha);
-            fprintf(results_json, "                \"beta\": %0.2f\n", beta);
+            fprintf(results_json, "                \"beta\": %0.2f,\n", beta);
+            fprintf(results_json, "                \"threads\": %d,\n", cprofile.key.num_threads);
+            fprintf(results_json, "                \"library\": \"%s\"\n", cprofile.key.library);
             fprintf(results_json, "            },\n");
             fprintf(results_json, "            \"max_performance\": {\n");
             fprintf(results_json, "                \"gflops\": %0.2f,\n", gflops);
             fprintf(results_json, "                \"average_execution_time_sec\": %0.2f,\n", avg_time_sec);
             fprintf(results_json, "                \"average_execution_time_stdev\": %0.2f,\n", avg_time_stdev);
             fprintf(results_json, "                \"timestamp\": \"");
-            for (g=0; g<MAX_DATETIME_LEN; g++){
-                current_char = cprofile.datetimes[max_idx][g];
+            for (g=0; g<MAX_DATETIME_LEN && cprofile.datetime[g] != '\0'; g++){
+                current_char = cprofile.datetime[g];
                 if ((current_char >= '0' && current_char <= '9') || (current_char == '-') || (current_char == ':') || (current_char == ' '))
                     fprintf(results_json, "%c", current_char);
             }
             fprintf(results_json, "\"\n");
             fprintf(results_json, "            }\n");
-            if (cprofiles[i][h+1].M != 0)
+            if (profile_id < num_profiles_total)
                 fprintf(results_json, "        },\n");
             else
                 fprintf(results_json, "        }\n");
-
-            // Update h
-            h++;
         }
     }
 
@@ -1122,3 +942,889 @@ void save_results_to_json_file(char *gemm_type, int num_files, int entry_counts[
     // Close filename
     fclose(results_json);
 }
+
+ScalingGroup *scaling_group_find_or_create(ScalingBuilder *builder, ProfileKey *key){
+/* Finds the scaling group with the given key, creating an empty one if it does not exist
+ *
+ * Inputs
+ * ------
+ *     ScalingBuilder *builder
+ *         Holds the groups
+ *
+ *     ProfileKey *key
+ *         Key of the group
+ *
+ * Returns
+ * -------
+ *     ScalingGroup *group
+ *         Pointer to the group. Only valid until the next group is created.
+ */
+    ScalingGroup *groups;
+    ScalingGroup *group;
+    int h, new_capacity;
+
+    h = profile_index_find(&builder->index, key);
+    if (h != -1)
+        return &builder->groups[h];
+
+    if (builder->count == builder->capacity){
+        new_capacity = (builder->capacity == 0) ? INITIAL_CAPACITY : 2 * builder->capacity;
+        groups = realloc(builder->groups, sizeof(ScalingGroup) * new_capacity);
+        if (groups == NULL){
+            fprintf(stderr, "Could not allocate memory for %d scaling groups\n", new_capacity);
+            exit(2);
+        }
+        builder->groups = groups;
+        builder->capacity = new_capacity;
+    }
+
+    h = builder->count;
+    builder->count++;
+    profile_index_insert(&builder->index, key, h);
+    group = &builder->groups[h];
+    memset(group, 0, sizeof(ScalingGroup));
+    group->key = *key;
+    return group;
+}
+
+void entry_to_sample_stats(PerformanceEntry *entry, SampleStats *stats){
+/* Converts the execution times of a performance entry into sample sums. If the entry holds the
+ * time of every iteration, those are used directly. Otherwise (older result files), the sums are
+ * rebuilt from the mean and the (population) standard deviation of the run, which gives the same
+ * mean and variance as the original samples.
+ *
+ * Inputs
+ * ------
+ *     PerformanceEntry *entry
+ *         The entry to convert
+ *
+ *     SampleStats *stats
+ *         Sums which the entry's samples are added to
+ */
+    double n, mean, stdev;
+
+    if (entry->num_execution_times > 0){
+        stats->num_samples += entry->num_execution_times;
+        stats->sum += entry->execution_time_sum;
+        stats->sum_sq += entry->execution_time_sum_sq;
+        return;
+    }
+
+    n = (double)entry->num_iters;
+    mean = entry->avg_execution_time_sec;
+    stdev = entry->execution_time_stdev;
+    stats->num_samples += entry->num_iters;
+    stats->sum += n * mean;
+    stats->sum_sq += n * (stdev * stdev + mean * mean);
+}
+
+void add_entry_to_scaling_groups(PerformanceEntry *entry, void *handler_args){
+/* Adds the samples of a performance entry to its (routine, shape, scalars, threads, library)
+ * group, creating the group if needed
+ *
+ * Inputs
+ * ------
+ *     PerformanceEntry *entry
+ *         The entry to add
+ *
+ *     void *handler_args
+ *         A ScalingBuilder
+ */
+    ScalingBuilder *builder = (ScalingBuilder*)handler_args;
+    ScalingGroup *group;
+    ProfileKey key;
+
+    // Invalid runs are counted, and fail the analysis once the file has been read
+    if (validate_entry(entry) == false){
+        builder->num_invalid++;
+        return;
+    }
+
+    entry_to_profile_key(entry, &key);
+    group = scaling_group_find_or_create(builder, &key);
+    entry_to_sample_stats(entry, &group->samples);
+}
+
+bool read_scaling_groups(char **files, int num_files, ScalingBuilder *builder){
+/* Reads a result set and groups its samples by profile key
+ *
+ * Inputs
+ * ------
+ *     char **files, int num_files
+ *         Files of the result set
+ *
+ *     ScalingBuilder *builder
+ *         Initialized by this function. Free its groups and index when done.
+ *
+ * Returns
+ * -------
+ *     false if any of the files could not be read, or holds an invalid entry
+ */
+    ScalingBuilder *file_builders = calloc(num_files, sizeof(ScalingBuilder));
+    ScalingGroup *file_group;
+    ScalingGroup *group;
+    bool success = true;
+    int i, h;
+
+    // Read every file into its own builder on a pool of threads...
+    for (i=0; i<num_files; i++)
+        file_builders[i].filename = files[i];
+    run_file_tasks(num_files, read_scaling_groups_task, file_builders);
+
+    // ...then merge them, in the order the files were passed, into one set of groups
+    memset(builder, 0, sizeof(ScalingBuilder));
+    for (i=0; i<num_files; i++){
+        if (file_builders[i].num_entries < 0)
+            success = false;
+        else if (file_builders[i].num_invalid > 0){
+            fprintf(stderr, "%s holds %d invalid entries.\n", file_builders[i].filename, file_builders[i].num_invalid);
+            success = false;
+        }
+
+        for (h=0; h<file_builders[i].count && success == true; h++){
+            file_group = &file_builders[i].groups[h];
+            group = scaling_group_find_or_create(builder, &file_group->key);
+            sample_stats_merge(&group->samples, &file_group->samples);
+        }
+
+        free(file_builders[i].groups);
+        key_index_free(&file_builders[i].index);
+    }
+    free(file_builders);
+
+    return success;
+}
+
+bool profile_key_same_shape(ProfileKey *key1, ProfileKey *key2){
+/* Checks whether two profile keys describe the same problem, ignoring the number of threads */
+    return (key1->gemm_type == key2->gemm_type && key1->M == key2->M && key1->N == key2->N && key1->K == key2->K &&
+            key1->alpha == key2->alpha && key1->beta == key2->beta && strcmp(key1->library, key2->library) == 0);
+}
+
+int compare_scaling_groups(const void *group1, const void *group2){
+/* qsort() comparator which orders groups by shape, then by number of threads */
+    const ProfileKey *key1 = &((const ScalingGroup*)group1)->key;
+    const ProfileKey *key2 = &((const ScalingGroup*)group2)->key;
+    int library_cmp;
+
+    if (key1->gemm_type != key2->gemm_type)
+        return (key1->gemm_type < key2->gemm_type) ? -1 : 1;
+    if (key1->M != key2->M)
+        return (key1->M < key2->M) ? -1 : 1;
+    if (key1->N != key2->N)
+        return (key1->N < key2->N) ? -1 : 1;
+    if (key1->K != key2->K)
+        return (key1->K < key2->K) ? -1 : 1;
+    if (key1->alpha != key2->alpha)
+        return (key1->alpha < key2->alpha) ? -1 : 1;
+    if (key1->beta != key2->beta)
+        return (key1->beta < key2->beta) ? -1 : 1;
+    library_cmp = strcmp(key1->library, key2->library);
+    if (library_cmp != 0)
+        return library_cmp;
+    if (key1->num_threads != key2->num_threads)
+        return (key1->num_threads < key2->num_threads) ? -1 : 1;
+    return 0;
+}
+
+void fit_scaling_models(ScalingPoint *points, int num_points, ScalingFit *fit){
+/* Estimates the serial fraction of a problem from its execution times at different thread counts.
+ *
+ * Amdahl's law (fixed problem size) models the execution time on p threads as T(p) = a + b / p,
+ * where 'a' is the serial part and 'b' the parallelizable part. Since this is linear in 1 / p, the
+ * fit is an ordinary least-squares line, and the serial fraction is a / (a + b). Fitting the times
+ * rather than the speedups means the smallest thread count does not have to be 1.
+ *
+ * Gustafson's law models the scaled speedup as S(r) = r - f (r - 1) for r times as many threads,
+ * so the serial fraction f is the least-squares slope of (r - S) against (r - 1).
+ *
+ * Inputs
+ * ------
+ *     ScalingPoint *points, int num_points
+ *         Measurements ordered by number of threads, with at least 2 distinct thread counts.
+ *         The speedups must already be set.
+ *
+ *     ScalingFit *fit
+ *         Fitted models
+ */
+    double mean_x = 0, mean_y = 0;
+    double sxx = 0, sxy = 0, syy = 0;
+    double x, y, r;
+    double gustafson_num = 0, gustafson_den = 0;
+    double a, b;
+    int i;
+
+    // Amdahl: least-squares line through (1/p, T(p))
+    for (i=0; i<num_points; i++){
+        mean_x += 1.0 / points[i].num_threads;
+        mean_y += points[i].avg_execution_time_sec;
+    }
+    mean_x /= num_points;
+    mean_y /= num_points;
+    for (i=0; i<num_points; i++){
+        x = 1.0 / points[i].num_threads - mean_x;
+        y = points[i].avg_execution_time_sec - mean_y;
+        sxx += x * x;
+        sxy += x * y;
+        syy += y * y;
+    }
+    b = sxy / sxx;
+    a = mean_y - b * mean_x;
+
+    // A negative intercept or slope is noise (or super-linear scaling), not a negative serial part
+    if (a < 0)
+        a = 0;
+    if (b < 0)
+        b = 0;
+    fit->amdahl_serial_fraction = (a + b > 0) ? a / (a + b) : 1.0;
+    fit->amdahl_max_speedup = (fit->amdahl_serial_fraction > 0) ? 1.0 / fit->amdahl_serial_fraction : INFINITY;
+    fit->amdahl_r_squared = (syy > 0) ? (sxy * sxy) / (sxx * syy) : 1.0;
+
+    // Gustafson: least-squares line through the origin of (r - 1, r - S(r))
+    for (i=0; i<num_points; i++){
+        r = (double)points[i].num_threads / points[0].num_threads;
+        gustafson_num += (r - points[i].speedup) * (r - 1.0);
+        gustafson_den += (r - 1.0) * (r - 1.0);
+    }
+    fit->gustafson_serial_fraction = (gustafson_den > 0) ? gustafson_num / gustafson_den : 0.0;
+    if (fit->gustafson_serial_fraction < 0)
+        fit->gustafson_serial_fraction = 0;
+    if (fit->gustafson_serial_fraction > 1)
+        fit->gustafson_serial_fraction = 1;
+}
+
+int run_scaling_analysis(int argc, char *argv[]){
+/* Turns the results of the same problem run at different thread counts into scaling figures. Runs
+ * are grouped by (routine, M, N, K, alpha, beta, library), and for each group the speedup and
+ * parallel efficiency at every thread count are printed along with the serial fractions estimated
+ * by Amdahl's and Gustafson's laws. The first thread count at which the efficiency drops below
+ * 'efficiency_threshold' is flagged, and the largest thread count before it is recommended.
+ *
+ * Usage: compare_gemm_results scaling [--efficiency <percent>] <file> [<file> ...]
+ *
+ * Inputs
+ * ------
+ *     int argc, char *argv[]
+ *         Arguments following "scaling"
+ *
+ * Returns
+ * -------
+ *     0 on success, 2 for invalid input
+ */
+    char *usage_str = "Usage: compare_gemm_results scaling [--efficiency <percent>] <file> [<file> ...]";
+    double efficiency_threshold = DEFAULT_EFFICIENCY_THRESHOLD;
+    char **files = malloc(sizeof(char*) * (argc + 1));
+    int num_files = 0;
+    char *pEnd;
+    int i, j;
+
+    // Parse arguments
+    for (i=0; i<argc; i++){
+        if (strcmp(argv[i], "--efficiency") == 0){
+            if (i + 1 >= argc){
+                fprintf(stderr, "%s requires a value. %s\n", argv[i], usage_str);
+                return 2;
+            }
+            efficiency_threshold = strtod(argv[i+1], &pEnd);
+            if (*pEnd != '\0'){
+                fprintf(stderr, "Invalid value '%s' for %s.\n", argv[i+1], argv[i]);
+                return 2;
+            }
+            i++;
+        }
+        else if (access(argv[i], F_OK) == -1){
+            fprintf(stderr, "%s does not exist.\n", argv[i]);
+            return 2;
+        }
+        else{
+            files[num_files] = argv[i];
+            num_files++;
+        }
+    }
+
+    if (num_files == 0){
+        fprintf(stderr, "At least one file is required. %s\n", usage_str);
+        return 2;
+    }
+    if (efficiency_threshold <= 0 || efficiency_threshold > 100){
+        fprintf(stderr, "The efficiency threshold must be between 0 and 100. You entered: %0.2f\n", efficiency_threshold);
+        return 2;
+    }
+
+    // Group the runs by profile key (which includes the number of threads), then order them so that
+    // the thread counts of each shape are next to each other
+    ScalingBuilder builder;
+    if (read_scaling_groups(files, num_files, &builder) == false)
+        return 2;
+    key_index_free(&builder.index);
+    qsort(builder.groups, builder.count, sizeof(ScalingGroup), compare_scaling_groups);
+
+    ScalingPoint *points = malloc(sizeof(ScalingPoint) * (builder.count + 1));
+    ScalingFit fit;
+    ScalingGroup *group;
+    int num_points, first_drop, recommended;
+    int num_shapes = 0;
+
+    printf("Thread Scaling (efficiency threshold: %0.1f%%)\n", efficiency_threshold);
+    printf("=======================\n");
+    for (i=0; i<builder.count; i += num_points){
+        group = &builder.groups[i];
+
+        // Collect the thread counts of this shape
+        num_points = 0;
+        while (i + num_points < builder.count && profile_key_same_shape(&group->key, &builder.groups[i + num_points].key) == true){
+            points[num_points].num_threads = builder.groups[i + num_points].key.num_threads;
+            points[num_points].num_samples = builder.groups[i + num_points].samples.num_samples;
+            points[num_points].avg_execution_time_sec = builder.groups[i + num_points].samples.sum / points[num_points].num_samples;
+            points[num_points].gflops_approx = 2.0 * group->key.M * group->key.N * group->key.K / (1e9 * points[num_points].avg_execution_time_sec);
+            num_points++;
+        }
+
+        printf("%s (M, N, K): (%d,%d,%d), (alpha, beta): (%0.2f,%0.2f)\n", (group->key.gemm_type == 1) ? "SGEMM" : "DGEMM",
+               group->key.M, group->key.N, group->key.K, group->key.alpha, group->key.beta);
+        if (group->key.library[0] != '\0')
+            printf("    Library: %s\n", group->key.library);
+
+        if (num_points < 2 || points[0].num_threads < 1){
+            printf("    Only found with %d thread(s). Skipping.\n\n", points[0].num_threads);
+            continue;
+        }
+        num_shapes++;
+
+        // Speedup and efficiency relative to the smallest thread count. If that is more than 1 thread,
+        // scaling up to it is assumed to be linear.
+        for (j=0; j<num_points; j++){
+            points[j].speedup = points[0].avg_execution_time_sec / points[j].avg_execution_time_sec;
+            points[j].efficiency = 100.0 * points[j].speedup * points[0].num_threads / points[j].num_threads;
+        }
+        fit_scaling_models(points, num_points, &fit);
+
+        if (points[0].num_threads > 1)
+            printf("    Speedups are relative to %d threads\n", points[0].num_threads);
+        printf("    %8s %12s %10s %9s %11s\n", "Threads", "Time (sec)", "GFlops", "Speedup", "Efficiency");
+        first_drop = -1;
+        for (j=0; j<num_points; j++){
+            if (first_drop == -1 && points[j].efficiency < efficiency_threshold)
+                first_drop = j;
+            printf("    %8d %12.5f %10.2f %8.2fx %10.1f%%%s\n", points[j].num_threads, points[j].avg_execution_time_sec,
+                   points[j].gflops_approx, points[j].speedup, points[j].efficiency, (j == first_drop) ? "  <<" : "");
+        }
+
+        printf("    Amdahl serial fraction:    %0.4f (max speedup: ", fit.amdahl_serial_fraction);
+        if (isinf(fit.amdahl_max_speedup))
+            printf("unbounded");
+        else
+            printf("%0.1fx", fit.amdahl_max_speedup);
+        printf(", R^2: %0.3f)\n", fit.amdahl_r_squared);
+        printf("    Gustafson serial fraction: %0.4f\n", fit.gustafson_serial_fraction);
+
+        if (first_drop == -1)
+            printf("    Efficiency stays at or above %0.1f%% up to %d threads\n\n", efficiency_threshold, points[num_points-1].num_threads);
+        else{
+            recommended = points[first_drop-1].num_threads;
+            printf("    Efficiency drops below %0.1f%% at %d threads. Recommended: %d threads\n\n", efficiency_threshold,
+                   points[first_drop].num_threads, recommended);
+        }
+    }
+
+    printf("%d shape(s) with more than one thread count\n", num_shapes);
+
+    free(points);
+    free(builder.groups);
+    free(files);
+
+    return 0;
+}
+
+long long datetime_to_timestamp(char *datetime){
+/* Converts a results timestamp ("YYYY-M-D H:M:S", as written by gemm_test.c, with or without zero
+ * padding) into a number which sorts in chronological order. Returns -1 if it cannot be parsed.
+ */
+    int year, month, day, hour, minute, second;
+
+    if (sscanf(datetime, "%d-%d-%d %d:%d:%d", &year, &month, &day, &hour, &minute, &second) != 6)
+        return -1;
+    return (((((long long)year * 13 + month) * 32 + day) * 24 + hour) * 60 + minute) * 60 + second;
+}
+
+HistorySeries *history_series_find_or_create(HistoryBuilder *builder, ProfileKey *key){
+/* Finds the series with the given key, creating an empty one if it does not exist
+ *
+ * Inputs
+ * ------
+ *     HistoryBuilder *builder
+ *         Holds the series
+ *
+ *     ProfileKey *key
+ *         Key of the series
+ *
+ * Returns
+ * -------
+ *     HistorySeries *series
+ *         Pointer to the series. Only valid until the next series is created.
+ */
+    HistorySeries *series;
+    int h, new_capacity;
+
+    h = profile_index_find(&builder->index, key);
+    if (h != -1)
+        return &builder->series[h];
+
+    if (builder->count == builder->capacity){
+        new_capacity = (builder->capacity == 0) ? INITIAL_CAPACITY : 2 * builder->capacity;
+        series = realloc(builder->series, sizeof(HistorySeries) * new_capacity);
+        if (series == NULL){
+            fprintf(stderr, "Could not allocate memory for %d history series\n", new_capacity);
+            exit(2);
+        }
+        builder->series = series;
+        builder->capacity = new_capacity;
+    }
+
+    h = builder->count;
+    builder->count++;
+    profile_index_insert(&builder->index, key, h);
+    series = &builder->series[h];
+    memset(series, 0, sizeof(HistorySeries));
+    series->key = *key;
+    return series;
+}
+
+void history_series_append(HistorySeries *series, HistoryPoint *point){
+/* Appends a run to a series, growing it as needed */
+    HistoryPoint *points;
+    int new_capacity;
+
+    if (series->count == series->capacity){
+        new_capacity = (series->capacity == 0) ? INITIAL_CAPACITY : 2 * series->capacity;
+        points = realloc(series->points, sizeof(HistoryPoint) * new_capacity);
+        if (points == NULL){
+            fprintf(stderr, "Could not allocate memory for %d history points\n", new_capacity);
+            exit(2);
+        }
+        series->points = points;
+        series->capacity = new_capacity;
+    }
+    series->points[series->count] = *point;
+    series->count++;
+}
+
+void add_entry_to_history(PerformanceEntry *entry, void *handler_args){
+/* Adds a run to the series of its profile
+ *
+ * Inputs
+ * ------
+ *     PerformanceEntry *entry
+ *         The run to add
+ *
+ *     void *handler_args
+ *         The HistoryBuilder of the file being read
+ */
+    HistoryBuilder *builder = (HistoryBuilder*)handler_args;
+    HistorySeries *series;
+    HistoryPoint point;
+    SampleStats stats;
+    ProfileKey key;
+
+    // Invalid runs are counted, and fail the analysis once the file has been read
+    if (validate_entry(entry) == false){
+        builder->num_invalid++;
+        return;
+    }
+
+    point.timestamp = datetime_to_timestamp(entry->datetime);
+    if (point.timestamp < 0){
+        fprintf(stderr, "<< WARNING >> Could not parse the timestamp '%s' in %s. Skipping this entry.\n", entry->datetime, builder->filename);
+        return;
+    }
+    memcpy(point.datetime, entry->datetime, MAX_DATETIME_LEN);
+    point.order = builder->num_entries;
+
+    // Each run contributes one point: its mean execution time
+    memset(&stats, 0, sizeof(SampleStats));
+    entry_to_sample_stats(entry, &stats);
+    if (stats.num_samples == 0)
+        return;
+    point.avg_execution_time_sec = stats.sum / stats.num_samples;
+
+    entry_to_profile_key(entry, &key);
+    series = history_series_find_or_create(builder, &key);
+    history_series_append(series, &point);
+    builder->num_entries++;
+}
+
+void read_history_task(int file_id, void *task_args){
+/* Reads one file into its own HistoryBuilder
+ *
+ * Inputs
+ * ------
+ *     int file_id
+ *         Index of the file (and of its builder)
+ *
+ *     void *task_args
+ *         Array of HistoryBuilders, one per file
+ */
+    HistoryBuilder *builder = &((HistoryBuilder*)task_args)[file_id];
+    int num_entries = read_json(builder->filename, add_entry_to_history, builder);
+    if (num_entries < 0)
+        builder->num_entries = -1;
+}
+
+int compare_history_points(const void *point1, const void *point2){
+/* qsort() comparator which orders runs chronologically, then in the order they were read */
+    const HistoryPoint *p1 = (const HistoryPoint*)point1;
+    const HistoryPoint *p2 = (const HistoryPoint*)point2;
+
+    if (p1->timestamp != p2->timestamp)
+        return (p1->timestamp < p2->timestamp) ? -1 : 1;
+    return (p1->order < p2->order) ? -1 : (p1->order > p2->order);
+}
+
+double estimate_noise_stdev(double *values, int num_values){
+/* Estimates the run-to-run standard deviation of a series from the median absolute difference of
+ * consecutive values. Unlike the sample standard deviation, this is not inflated by the shifts
+ * that are being looked for, since a shift only affects one difference.
+ *
+ * Inputs
+ * ------
+ *     double *values, int num_values
+ *         The series (at least 2 values)
+ *
+ * Returns
+ * -------
+ *     double stdev
+ */
+    double *diffs = malloc(sizeof(double) * num_values);
+    double median, tmp;
+    int num_diffs = num_values - 1;
+    int i, j;
+
+    for (i=0; i<num_diffs; i++)
+        diffs[i] = fabs(values[i+1] - values[i]);
+
+    // Insertion sort: histories are short
+    for (i=1; i<num_diffs; i++){
+        tmp = diffs[i];
+        for (j=i-1; j>=0 && diffs[j] > tmp; j--)
+            diffs[j+1] = diffs[j];
+        diffs[j+1] = tmp;
+    }
+    median = (num_diffs % 2 == 1) ? diffs[num_diffs/2] : 0.5 * (diffs[num_diffs/2 - 1] + diffs[num_diffs/2]);
+    free(diffs);
+
+    // For normal noise, the MAD is 0.6745 sigma and differences have a variance of 2 sigma^2
+    return median / (0.6745 * sqrt(2.0));
+}
+
+int detect_changepoints(double *values, int num_values, double penalty, int min_segment_len, int *changepoints){
+/* Finds the changes in mean of a series with PELT (Pruned Exact Linear Time, Killick et al. 2012).
+ * The series is split into the segments that minimize the sum of squared deviations from each
+ * segment's mean, plus 'penalty' per changepoint. Candidate split points which can no longer be
+ * part of an optimal split are pruned, which keeps the search close to linear.
+ *
+ * Inputs
+ * ------
+ *     double *values, int num_values
+ *         The series, normalized by its noise standard deviation
+ *
+ *     double penalty
+ *         Cost of adding a changepoint
+ *
+ *     int min_segment_len
+ *         Minimum number of values between changepoints
+ *
+ *     int *changepoints
+ *         Filled with the index of the first value after each change, in ascending order. Must hold
+ *         at least num_values elements.
+ *
+ * Returns
+ * -------
+ *     int num_changepoints
+ */
+    double *sum = malloc(sizeof(double) * (num_values + 1));
+    double *sum_sq = malloc(sizeof(double) * (num_values + 1));
+    double *best_cost = malloc(sizeof(double) * (num_values + 1));
+    double *candidate_cost = malloc(sizeof(double) * (num_values + 1));
+    int *last_change = malloc(sizeof(int) * (num_values + 1));
+    int *candidates = malloc(sizeof(int) * (num_values + 1));
+    int num_candidates = 0;
+    int num_changepoints = 0;
+    double segment_sum, cost;
+    int i, c, s, t, kept;
+
+    // Prefix sums give the cost of any segment in constant time
+    sum[0] = 0;
+    sum_sq[0] = 0;
+    for (i=0; i<num_values; i++){
+        sum[i+1] = sum[i] + values[i];
+        sum_sq[i+1] = sum_sq[i] + values[i] * values[i];
+    }
+
+    best_cost[0] = -penalty;
+    for (t=1; t<=num_values; t++){
+        best_cost[t] = INFINITY;
+        last_change[t] = 0;
+
+        // A segment ending at 't' may start at 't - min_segment_len' at the latest
+        s = t - min_segment_len;
+        if (s == 0 || (s >= min_segment_len && isfinite(best_cost[s])))
+            candidates[num_candidates++] = s;
+
+        for (c=0; c<num_candidates; c++){
+            s = candidates[c];
+            segment_sum = sum[t] - sum[s];
+            cost = (sum_sq[t] - sum_sq[s]) - segment_sum * segment_sum / (t - s);
+            candidate_cost[c] = best_cost[s] + cost;
+            if (candidate_cost[c] + penalty < best_cost[t]){
+                best_cost[t] = candidate_cost[c] + penalty;
+                last_change[t] = s;
+            }
+        }
+
+        // Prune candidates which cannot beat 't' as a split point from here on
+        kept = 0;
+        for (c=0; c<num_candidates; c++){
+            if (candidate_cost[c] <= best_cost[t])
+                candidates[kept++] = candidates[c];
+        }
+        num_candidates = kept;
+    }
+
+    // Walk back through the optimal segmentation
+    for (t=num_values; last_change[t] > 0; t=last_change[t])
+        changepoints[num_changepoints++] = last_change[t];
+    for (i=0; i<num_changepoints/2; i++){
+        c = changepoints[i];
+        changepoints[i] = changepoints[num_changepoints - 1 - i];
+        changepoints[num_changepoints - 1 - i] = c;
+    }
+
+    free(sum);
+    free(sum_sq);
+    free(best_cost);
+    free(candidate_cost);
+    free(last_change);
+    free(candidates);
+
+    return num_changepoints;
+}
+
+int run_history_analysis(int argc, char *argv[]){
+/* Looks for shifts in performance over time. Runs are grouped by (routine, M, N, K, alpha, beta,
+ * threads, library) and ordered by their timestamps, and changepoints in the mean execution time of
+ * each group are found with PELT. Every shift of at least 'min_shift' percent is reported with the
+ * run it starts at and the mean execution times before and after it.
+ *
+ * Usage: compare_gemm_results history [--penalty <value>] [--min-shift <percent>] [--min-segment <runs>]
+ *                                     <file> [<file> ...]
+ *
+ * Inputs
+ * ------
+ *     int argc, char *argv[]
+ *         Arguments following "history"
+ *
+ * Returns
+ * -------
+ *     0 if no slowdown was found, 1 if the latest runs of at least one group are slower than its
+ *     earliest runs, 2 for invalid input
+ */
+    char *usage_str = "Usage: compare_gemm_results history [--penalty <value>] [--min-shift <percent>] [--min-segment <runs>] <file> [<file> ...]";
+    double penalty = -1;            //defaults to 2 ln(n) per series
+    double min_shift = DEFAULT_MIN_SHIFT;
+    int min_segment_len = DEFAULT_MIN_SEGMENT_LEN;
+    char **files = malloc(sizeof(char*) * (argc + 1));
+    int num_files = 0;
+    double value;
+    char *pEnd;
+    int i, j, h;
+
+    // Parse arguments
+    for (i=0; i<argc; i++){
+        if (strcmp(argv[i], "--penalty") == 0 || strcmp(argv[i], "--min-shift") == 0 || strcmp(argv[i], "--min-segment") == 0){
+            if (i + 1 >= argc){
+                fprintf(stderr, "%s requires a value. %s\n", argv[i], usage_str);
+                return 2;
+            }
+            value = strtod(argv[i+1], &pEnd);
+            if (*pEnd != '\0' || value < 0){
+                fprintf(stderr, "Invalid value '%s' for %s.\n", argv[i+1], argv[i]);
+                return 2;
+            }
+            if (strcmp(argv[i], "--penalty") == 0)
+                penalty = value;
+            else if (strcmp(argv[i], "--min-shift") == 0)
+                min_shift = value;
+            else if (value < 1 || value != (int)value){
+                fprintf(stderr, "The minimum segment length must be a positive integer. You entered: %s\n", argv[i+1]);
+                return 2;
+            }
+            else
+                min_segment_len = (int)value;
+            i++;
+        }
+        else if (access(argv[i], F_OK) == -1){
+            fprintf(stderr, "%s does not exist.\n", argv[i]);
+            return 2;
+        }
+        else{
+            files[num_files] = argv[i];
+            num_files++;
+        }
+    }
+
+    if (num_files == 0){
+        fprintf(stderr, "At least one file is required. %s\n", usage_str);
+        return 2;
+    }
+
+    // Read every file into its own builder on a pool of threads...
+    HistoryBuilder *file_builders = calloc(num_files, sizeof(HistoryBuilder));
+    for (i=0; i<num_files; i++)
+        file_builders[i].filename = files[i];
+    run_file_tasks(num_files, read_history_task, file_builders);
+
+    // ...then merge their series, in the order the files were passed
+    HistoryBuilder builder;
+    HistorySeries *series;
+    HistoryPoint point;
+    memset(&builder, 0, sizeof(HistoryBuilder));
+    for (i=0; i<num_files; i++){
+        if (file_builders[i].num_entries < 0)
+            return 2;
+        if (file_builders[i].num_invalid > 0){
+            fprintf(stderr, "%s holds %d invalid entries.\n", file_builders[i].filename, file_builders[i].num_invalid);
+            return 2;
+        }
+
+        for (h=0; h<file_builders[i].count; h++){
+            series = history_series_find_or_create(&builder, &file_builders[i].series[h].key);
+            for (j=0; j<file_builders[i].series[h].count; j++){
+                point = file_builders[i].series[h].points[j];
+                point.order = series->count;
+                history_series_append(series, &point);
+            }
+            free(file_builders[i].series[h].points);
+        }
+        free(file_builders[i].series);
+        key_index_free(&file_builders[i].index);
+    }
+    free(file_builders);
+
+    // Look for shifts in every series
+    double *times = malloc(sizeof(double) * 1);
+    double *normalized = malloc(sizeof(double) * 1);
+    int *changepoints = malloc(sizeof(int) * 1);
+    int max_count = 0;
+    int num_changepoints, num_shifts, start, end, next;
+    int total_shifts = 0;
+    int num_analyzed = 0;
+    int num_slower = 0;
+    double mean, stdev, series_penalty;
+    double before, after, change_percent, overall_percent;
+    double flops;
+
+    printf("Performance History (minimum shift: %0.2f%%, minimum segment: %d run(s))\n", min_shift, min_segment_len);
+    printf("=======================\n");
+    for (h=0; h<builder.count; h++){
+        series = &builder.series[h];
+        qsort(series->points, series->count, sizeof(HistoryPoint), compare_history_points);
+
+        printf("%s (M, N, K): (%d,%d,%d), (alpha, beta): (%0.2f,%0.2f), %d thread(s)\n", (series->key.gemm_type == 1) ? "SGEMM" : "DGEMM",
+               series->key.M, series->key.N, series->key.K, series->key.alpha, series->key.beta, series->key.num_threads);
+        if (series->key.library[0] != '\0')
+            printf("    Library: %s\n", series->key.library);
+        printf("    %d run(s) from %s to %s\n", series->count, series->points[0].datetime, series->points[series->count-1].datetime);
+
+        if (series->count < 2 * min_segment_len){
+            printf("    Not enough runs to look for shifts. Skipping.\n\n");
+            continue;
+        }
+        num_analyzed++;
+
+        if (series->count > max_count){
+            max_count = series->count;
+            times = realloc(times, sizeof(double) * max_count);
+            normalized = realloc(normalized, sizeof(double) * max_count);
+            changepoints = realloc(changepoints, sizeof(int) * max_count);
+        }
+
+        // Normalize by the run-to-run noise so that one penalty fits every series. The noise is kept
+        // above 0.1% of the mean, so timer resolution alone is never reported as a shift.
+        mean = 0;
+        for (i=0; i<series->count; i++){
+            times[i] = series->points[i].avg_execution_time_sec;
+            mean += times[i];
+        }
+        mean /= series->count;
+        stdev = estimate_noise_stdev(times, series->count);
+        if (stdev < 1e-3 * mean)
+            stdev = 1e-3 * mean;
+        for (i=0; i<series->count; i++)
+            normalized[i] = (times[i] - mean) / stdev;
+
+        series_penalty = (penalty < 0) ? 2.0 * log((double)series->count) : penalty;
+        num_changepoints = detect_changepoints(normalized, series->count, series_penalty, min_segment_len, changepoints);
+
+        // Report the change in mean execution time across every changepoint
+        flops = 2.0 * series->key.M * series->key.N * series->key.K / 1e9;
+        num_shifts = 0;
+        start = 0;
+        for (j=0; j<num_changepoints; j++){
+            end = changepoints[j];
+            next = (j + 1 < num_changepoints) ? changepoints[j+1] : series->count;
+
+            before = 0;
+            for (i=start; i<end; i++)
+                before += times[i];
+            before /= (end - start);
+            after = 0;
+            for (i=end; i<next; i++)
+                after += times[i];
+            after /= (next - end);
+            start = end;
+
+            change_percent = 100.0 * (after - before) / before;
+            if (fabs(change_percent) < min_shift)
+                continue;
+            num_shifts++;
+            printf("    Shift at %s (run %d of %d): %0.5f -> %0.5f sec (%+0.2f%%), %0.2f -> %0.2f GFlops, %s\n",
+                   series->points[end].datetime, end + 1, series->count, before, after, change_percent,
+                   flops / before, flops / after, (change_percent > 0) ? "SLOWER" : "faster");
+        }
+        total_shifts += num_shifts;
+
+        if (num_shifts == 0){
+            printf("    No shift of %0.2f%% or more found\n\n", min_shift);
+            continue;
+        }
+
+        // Net effect: earliest segment against the latest one
+        end = changepoints[0];
+        before = 0;
+        for (i=0; i<end; i++)
+            before += times[i];
+        before /= end;
+        start = changepoints[num_changepoints-1];
+        after = 0;
+        for (i=start; i<series->count; i++)
+            after += times[i];
+        after /= (series->count - start);
+        overall_percent = 100.0 * (after - before) / before;
+        printf("    Overall: %+0.2f%% from the earliest to the latest runs\n\n", overall_percent);
+        if (overall_percent >= min_shift)
+            num_slower++;
+    }
+
+    printf("%d shift(s) found in %d series. %d series got slower overall.\n", total_shifts, num_analyzed, num_slower);
+
+    for (h=0; h<builder.count; h++)
+        free(builder.series[h].points);
+    free(builder.series);
+    key_index_free(&builder.index);
+    free(times);
+    free(normalized);
+    free(changepoints);
+    free(files);
+
+    return (num_slower > 0) ? 1 : 0;
+}
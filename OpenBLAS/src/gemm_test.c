@@ -10,6 +10,7 @@
 #include <math.h>
 
 extern void openblas_set_num_threads(int num_threads);
+extern char* openblas_get_config(void);
 void openblas_set_num_threads_(int* num_threads){
         openblas_set_num_threads(*num_threads);
 };
@@ -394,6 +395,7 @@ int main(int argc, char *argv[]){
 #endif
     fprintf(tmp_gemm_JSON_doc, "            \"iterations:\": %d,\n", num_iters);
     fprintf(tmp_gemm_JSON_doc, "            \"threads\": %d,\n", nthreads);
+    fprintf(tmp_gemm_JSON_doc, "            \"blas_library\": \"%s\",\n", openblas_get_config());
     fprintf(tmp_gemm_JSON_doc, "            \"matrix_params\": {\n");
     fprintf(tmp_gemm_JSON_doc, "                \"dims\": {\n");
     fprintf(tmp_gemm_JSON_doc, "                    \"matrix_A\": [%d,%d],\n", dim_M, dim_K);
@@ -409,7 +411,13 @@ int main(int argc, char *argv[]){
     fprintf(tmp_gemm_JSON_doc, "        \"performance_results\": {\n");
     fprintf(tmp_gemm_JSON_doc, "            \"average_execution_time_seconds\": %0.5f,\n", average_execution_time_sec);
     fprintf(tmp_gemm_JSON_doc, "            \"standard_deviation_seconds\": %0.5Lf,\n", stdev);
-    fprintf(tmp_gemm_JSON_doc, "            \"average_gflops\": %0.5f\n", gflops_approx);
+    fprintf(tmp_gemm_JSON_doc, "            \"average_gflops\": %0.5f,\n", gflops_approx);
+
+    // Save the time of every iteration so that runs can be compared statistically (see compare.c)
+    fprintf(tmp_gemm_JSON_doc, "            \"execution_times_seconds\": [");
+    for (i=0; i<num_iters-1; i++)
+        fprintf(tmp_gemm_JSON_doc, "%0.6f,", performance_times_sec[i]);
+    fprintf(tmp_gemm_JSON_doc, "%0.6f]\n", performance_times_sec[num_iters-1]);
     fprintf(tmp_gemm_JSON_doc, "        }\n");
     fprintf(tmp_gemm_JSON_doc, "    }\n");
     fprintf(tmp_gemm_JSON_doc, "}\n");
@@ -0,0 +1,3 @@
+#!/bin/bash
+
+gcc src/compare_results.c src/results_json.c src/results_stats.c src/results_compare.c -Isrc -o compare_results -lm -lpthread -Wall
@@ -0,0 +1,26 @@
+/* Unified comparison of the results written by the math-library benchmarks in this repository.
+ *
+ * Records of every layout described in results_compare.c can be mixed freely, so a single command
+ * can summarize or gate every benchmark run on a node.
+ *
+ * Usage: compare_results summary <file> [<file> ...]
+ *        compare_results regress [--threshold <percent>] [--alpha <significance>]
+ *                                --baseline <file> [<file> ...] --candidate <file> [<file> ...]
+ */
+#include <stdio.h>
+#include <string.h>
+#include "results_compare.h"
+
+int main(int argc, char *argv[]){
+
+    char *usage_str = "Usage: compare_results summary <file> [<file> ...]\n"
+                      "       compare_results regress [--threshold <percent>] [--alpha <significance>] --baseline <file> [<file> ...] --candidate <file> [<file> ...]";
+
+    if (argc > 1 && strcmp(argv[1], "summary") == 0)
+        return run_results_summary(argc - 2, argv + 2, "compare_results", RESULT_SCHEMAS, NUM_RESULT_SCHEMAS);
+    if (argc > 1 && strcmp(argv[1], "regress") == 0)
+        return run_regression_gate(argc - 2, argv + 2, "compare_results", RESULT_SCHEMAS, NUM_RESULT_SCHEMAS);
+
+    fprintf(stderr, "%s\n", usage_str);
+    return 2;
+}
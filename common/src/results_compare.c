@@ -0,0 +1,1044 @@
+/* Schema-driven grouping and comparison of benchmark results. See results_compare.h */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "results_compare.h"
+
+#define INITIAL_CAPACITY 16
+#define INITIAL_INDEX_SLOTS 64
+#define INITIAL_KEY_LEN 256
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+#define MAX_VALUE_LEN 128
+#define MAX_USAGE_LEN 512
+
+// Layouts written by OpenBLAS/src/gemm_test.c, FFTW/src/multidimensional_cosine_dft.c and
+// FFTW/src/guru_real_2D_dft_fftw_malloc.c. Unused metric slots are NULL.
+const ResultSchema RESULT_SCHEMAS[NUM_RESULT_SCHEMAS] = {
+    [GEMM_SCHEMA] = {
+        "gemm", "inputs.gemm_type",
+        (char*[]){"inputs.gemm_type", "inputs.matrix_params.dims.matrix_A", "inputs.matrix_params.dims.matrix_B",
+                  "inputs.matrix_params.scalar_values.alpha", "inputs.matrix_params.scalar_values.beta", "inputs.threads",
+                  "inputs.blas_library", NULL},
+        "inputs.iterations",
+        {
+            {"execution", "performance_results.average_execution_time_seconds", "performance_results.standard_deviation_seconds",
+             "performance_results.average_gflops", NULL, "performance_results.execution_times_seconds"}
+        }
+    },
+    [ND_COSINE_DFT_SCHEMA] = {
+        "nd_cosine_dft", "performance_results.inputs.rank",
+        (char*[]){"performance_results.inputs.rank", "performance_results.inputs.dims", "performance_results.inputs.fs_Hz",
+                  "performance_results.inputs.threads", "performance_results.inputs.rigor", "performance_results.inputs.precision",
+                  "performance_results.inputs.in_place", "performance_results.inputs.howmany", "performance_results.inputs.stride",
+                  "performance_results.inputs.dist", "performance_results.inputs.signal", "performance_results.inputs.threads_backend",
+                  "performance_results.inputs.busy_openmp_threads", "performance_results.inputs.embed",
+                  "performance_results.inputs.transposed", NULL},
+        "performance_results.inputs.iterations",
+        {
+            {"forward DFT", "performance_results.phases.forward.average_time_seconds", "performance_results.phases.forward.stdev_time_seconds",
+             "performance_results.forward_dft_results.average_gflops", NULL, NULL},
+            {"backward DFT", "performance_results.phases.backward.average_time_seconds", "performance_results.phases.backward.stdev_time_seconds",
+             "performance_results.backward_dft_results.average_gflops", NULL, NULL},
+            {"forward plan", "performance_results.forward_dft_results.plan_time_seconds", NULL, NULL, NULL, NULL},
+            {"backward plan", "performance_results.backward_dft_results.plan_time_seconds", NULL, NULL, NULL, NULL}
+        }
+    },
+    [BLUR_2D_SCHEMA] = {
+        "2d_blur", "performance_results.inputs.num_images",
+        (char*[]){"performance_results.inputs.num_images", "performance_results.inputs.image_dims", "performance_results.inputs.threads",
+                  "performance_results.inputs.threads_backend", "performance_results.inputs.busy_openmp_threads", NULL},
+        NULL,
+        {
+            {"forward DFT", "performance_results.forward_dft_results.total_execution_time_seconds", NULL,
+             "performance_results.forward_dft_results.average_gflops", NULL, NULL},
+            {"backward DFT", "performance_results.backward_dft_results.total_execution_time_seconds", NULL,
+             "performance_results.backward_dft_results.average_gflops", NULL, NULL},
+            {"blur", "performance_results.misc.blur_time_seconds", NULL, NULL, NULL, NULL},
+            {"wall", "performance_results.misc.wall_time_seconds", NULL, NULL, NULL, NULL}
+        }
+    }
+};
+
+typedef struct {
+    FileTask task;
+    void *task_args;
+    int num_files;
+    int next_file;        //next file to hand out, protected by 'lock'
+    pthread_mutex_t lock;
+} FilePool;
+
+typedef struct {
+    char *filename;
+    int side;                   //0 for baseline (or summary) files, 1 for candidate files
+    const ResultSchema *schemas;
+    int num_schemas;
+    GroupSet set;               //groups of this file only
+    char *key;                  //group key of the current record, reused across records
+    size_t key_capacity;
+    int num_records;            //negative if the file could not be parsed
+    int num_unknown;            //records which do not match any schema
+    bool out_of_memory;
+} ResultFileReader;
+
+static bool __key_append(char **key, size_t *key_capacity, size_t *len, const char *format, ...);
+static void *__file_pool_worker(void *pool_args);
+static void __metric_stats_merge(MetricStats *stats, MetricStats *other);
+static int __add_record_to_groups(JsonRecord *record, void *handler_args);
+static void __read_result_file_task(int file_id, void *task_args);
+
+uint64_t fnv1a_hash(const void *data, size_t len){
+/* 64-bit FNV-1a hash of 'len' bytes */
+    const unsigned char *bytes = (const unsigned char*)data;
+    uint64_t hash = FNV_OFFSET_BASIS;
+    size_t i;
+    for (i=0; i<len; i++){
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+int key_index_find(KeyIndex *index, const void *key, size_t key_len){
+/* Looks up a key in a hash index (open addressing with linear probing)
+ *
+ * Inputs
+ * ------
+ *     KeyIndex *index
+ *         The index to search
+ *
+ *     const void *key, size_t key_len
+ *         The key to look for
+ *
+ * Returns
+ * -------
+ *     int value
+ *         The value stored with the key, or -1 if the key is not in the index
+ */
+    uint64_t hash;
+    KeyIndexSlot *slot;
+    int h;
+
+    if (index->count == 0)
+        return -1;
+
+    hash = fnv1a_hash(key, key_len);
+    for (h=(int)(hash & (uint64_t)(index->num_slots - 1)); index->slots[h].value != -1; h=(h + 1) & (index->num_slots - 1)){
+        slot = &index->slots[h];
+        if (slot->hash == hash && slot->key_len == key_len && memcmp(slot->key, key, key_len) == 0)
+            return slot->value;
+    }
+    return -1;
+}
+
+int key_index_insert(KeyIndex *index, const void *key, size_t key_len, int value){
+/* Inserts a key which is not yet in the index. The index doubles in size whenever it becomes half
+ * full, so lookups stay constant time on average.
+ *
+ * Inputs
+ * ------
+ *     KeyIndex *index
+ *         The index to insert into
+ *
+ *     const void *key, size_t key_len
+ *         The new key. The index keeps its own copy.
+ *
+ *     int value
+ *         Value to store with the key (e.g., a position in a list of groups)
+ *
+ * Returns
+ * -------
+ *     0 on success, -1 if memory could not be allocated
+ */
+    KeyIndexSlot *old_slots = index->slots;
+    int old_num_slots = index->num_slots;
+    uint64_t hash;
+    void *key_copy;
+    int i, h;
+
+    // Grow (and rehash) the table if needed
+    if (2 * (index->count + 1) > index->num_slots){
+        index->num_slots = (old_num_slots == 0) ? INITIAL_INDEX_SLOTS : 2 * old_num_slots;
+        index->slots = malloc(sizeof(KeyIndexSlot) * index->num_slots);
+        if (index->slots == NULL){
+            index->slots = old_slots;
+            index->num_slots = old_num_slots;
+            return -1;
+        }
+        for (i=0; i<index->num_slots; i++)
+            index->slots[i].value = -1;
+
+        for (i=0; i<old_num_slots; i++){
+            if (old_slots[i].value == -1)
+                continue;
+            for (h=(int)(old_slots[i].hash & (uint64_t)(index->num_slots - 1)); index->slots[h].value != -1; h=(h + 1) & (index->num_slots - 1));
+            index->slots[h] = old_slots[i];
+        }
+        free(old_slots);
+    }
+
+    key_copy = malloc(key_len);
+    if (key_copy == NULL)
+        return -1;
+    memcpy(key_copy, key, key_len);
+
+    hash = fnv1a_hash(key, key_len);
+    for (h=(int)(hash & (uint64_t)(index->num_slots - 1)); index->slots[h].value != -1; h=(h + 1) & (index->num_slots - 1));
+    index->slots[h].hash = hash;
+    index->slots[h].value = value;
+    index->slots[h].key = key_copy;
+    index->slots[h].key_len = key_len;
+    index->count++;
+    return 0;
+}
+
+void key_index_free(KeyIndex *index){
+/* Frees the memory held by a hash index */
+    int i;
+    for (i=0; i<index->num_slots; i++){
+        if (index->slots[i].value != -1)
+            free(index->slots[i].key);
+    }
+    free(index->slots);
+    index->slots = NULL;
+    index->num_slots = 0;
+    index->count = 0;
+}
+
+int get_num_ingest_threads(int num_files){
+/* Gets the number of threads used to read result files: one per online CPU, but never more than
+ * the number of files. Debug builds read files one at a time so that their output stays in order.
+ *
+ * Inputs
+ * ------
+ *     int num_files
+ *         Number of files to read
+ *
+ * Returns
+ * -------
+ *     int num_threads
+ */
+#ifdef DEBUG
+    (void)num_files;
+    return 1;
+#else
+    long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (num_cpus < 1)
+        num_cpus = 1;
+    return (num_files < num_cpus) ? num_files : (int)num_cpus;
+#endif
+}
+
+static void *__file_pool_worker(void *pool_args){
+/* Worker loop of the file pool: keeps taking the next unprocessed file until there are none
+ * left. Do not call this function directly!
+ */
+    FilePool *pool = (FilePool*)pool_args;
+    int file_id;
+
+    while (true){
+        pthread_mutex_lock(&pool->lock);
+        file_id = pool->next_file;
+        pool->next_file++;
+        pthread_mutex_unlock(&pool->lock);
+
+        if (file_id >= pool->num_files)
+            break;
+        pool->task(file_id, pool->task_args);
+    }
+    return NULL;
+}
+
+void run_file_tasks(int num_files, FileTask task, void *task_args){
+/* Runs 'task' once for every file on a pool of threads. Files are handed out one at a time, so a
+ * thread which finishes a small file simply moves on to the next one. Returns once every file
+ * has been processed.
+ *
+ * Inputs
+ * ------
+ *     int num_files
+ *         Number of files (tasks)
+ *
+ *     FileTask task
+ *         Function called with each file ID in [0, num_files)
+ *
+ *     void *task_args
+ *         Arguments passed through to 'task'
+ */
+    int num_threads = get_num_ingest_threads(num_files);
+    pthread_t *threads;
+    FilePool pool;
+    int i;
+
+    pool.task = task;
+    pool.task_args = task_args;
+    pool.num_files = num_files;
+    pool.next_file = 0;
+    pthread_mutex_init(&pool.lock, NULL);
+
+    // No need to spawn threads for a single file (or a debug build)
+    if (num_threads <= 1){
+        __file_pool_worker(&pool);
+        pthread_mutex_destroy(&pool.lock);
+        return;
+    }
+
+    threads = malloc(sizeof(pthread_t) * num_threads);
+    if (threads == NULL)
+        num_threads = 0;
+    for (i=0; i<num_threads; i++){
+        if (pthread_create(&threads[i], NULL, __file_pool_worker, &pool) != 0){
+            fprintf(stderr, "Could not create thread %d. Reading the remaining files with %d thread(s).\n", i+1, i);
+            break;
+        }
+    }
+    num_threads = i;
+
+    // If no thread could be created, do the work on this one
+    if (num_threads == 0)
+        __file_pool_worker(&pool);
+
+    for (i=0; i<num_threads; i++)
+        pthread_join(threads[i], NULL);
+
+    pthread_mutex_destroy(&pool.lock);
+    free(threads);
+}
+
+int find_schema(JsonRecord *record, const ResultSchema *schemas, int num_schemas){
+/* Finds the schema a record follows
+ *
+ * Inputs
+ * ------
+ *     JsonRecord *record
+ *         The record
+ *
+ *     const ResultSchema *schemas, int num_schemas
+ *         The schemas to try, in order
+ *
+ * Returns
+ * -------
+ *     int schema_id
+ *         Index into 'schemas', or -1 if the record does not follow any of them
+ */
+    int i;
+    for (i=0; i<num_schemas; i++){
+        if (json_record_find(record, schemas[i].detect_path) != NULL)
+            return i;
+    }
+    return -1;
+}
+
+static bool __key_append(char **key, size_t *key_capacity, size_t *len, const char *format, ...){
+/* Appends formatted text to a group key, growing it as needed. Do not call this function
+ * directly!
+ */
+    va_list args;
+    size_t needed, new_capacity;
+    char *new_key;
+    int written;
+
+    va_start(args, format);
+    written = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+    if (written < 0)
+        return false;
+
+    needed = *len + (size_t)written + 1;
+    if (needed > *key_capacity){
+        new_capacity = (*key_capacity == 0) ? INITIAL_KEY_LEN : 2 * *key_capacity;
+        while (new_capacity < needed)
+            new_capacity *= 2;
+        new_key = realloc(*key, new_capacity);
+        if (new_key == NULL)
+            return false;
+        *key = new_key;
+        *key_capacity = new_capacity;
+    }
+
+    va_start(args, format);
+    vsnprintf(*key + *len, *key_capacity - *len, format, args);
+    va_end(args);
+    *len += (size_t)written;
+    return true;
+}
+
+bool record_group_key(JsonRecord *record, const ResultSchema *schema, char **key, size_t *key_capacity){
+/* Builds the group key of a record: the schema name followed by one "name=value" line per input,
+ * e.g. "gemm\ngemm_type=dgemm\nmatrix_A=[1000,1000]\n...\nthreads=8". Numbers are normalized, so
+ * "0.1" and "0.10" (or "0" and "-0") give the same key. Key fields which are missing (e.g.,
+ * "blas_library" in older files) are left out.
+ *
+ * Inputs
+ * ------
+ *     JsonRecord *record
+ *         The record
+ *
+ *     const ResultSchema *schema
+ *         The schema the record follows
+ *
+ *     char **key, size_t *key_capacity
+ *         Buffer which holds the key, and its size. Grown (or allocated, if NULL) as needed.
+ *
+ * Returns
+ * -------
+ *     false if memory could not be allocated
+ */
+    char value[MAX_VALUE_LEN];
+    char element_path[MAX_JSON_PATH_LEN];
+    const char *name;
+    JsonField *field;
+    double number;
+    size_t len = 0;
+    int i, j, num_elements;
+    bool success;
+
+    success = __key_append(key, key_capacity, &len, "%s", schema->name);
+    for (i=0; schema->key_paths[i] != NULL && success == true; i++){
+        name = strrchr(schema->key_paths[i], '.');
+        name = (name == NULL) ? schema->key_paths[i] : name + 1;
+
+        field = json_record_find(record, schema->key_paths[i]);
+        if (field != NULL){
+            if (field->value.type == JSON_TOKEN_NUMBER){
+                number = json_token_to_double(field->value);
+                snprintf(value, MAX_VALUE_LEN, "%.10g", (number == 0) ? 0.0 : number);
+            }
+            else
+                json_token_copy(field->value, value, MAX_VALUE_LEN);
+            success = __key_append(key, key_capacity, &len, "\n%s=%s", name, value);
+            continue;
+        }
+
+        // Arrays are flattened into "path[0]", "path[1]", ...
+        num_elements = json_record_int_array(record, schema->key_paths[i], NULL, 0);
+        if (num_elements == 0)
+            continue;
+        success = __key_append(key, key_capacity, &len, "\n%s=[", name);
+        for (j=0; j<num_elements && success == true; j++){
+            snprintf(element_path, MAX_JSON_PATH_LEN, "%s[%d]", schema->key_paths[i], j);
+            field = json_record_find(record, element_path);
+            if (field == NULL)
+                strcpy(value, "?");
+            else{
+                number = json_token_to_double(field->value);
+                snprintf(value, MAX_VALUE_LEN, "%.10g", (number == 0) ? 0.0 : number);
+            }
+            success = __key_append(key, key_capacity, &len, "%s%s", (j == 0) ? "" : ",", value);
+        }
+        if (success == true)
+            success = __key_append(key, key_capacity, &len, "]");
+    }
+
+    return success;
+}
+
+bool record_metric_stats(JsonRecord *record, const ResultSchema *schema, const MetricSchema *metric, MetricStats *stats){
+/* Adds the timing samples of one metric of a record to 'stats'. The samples are, in order of
+ * preference:
+ *
+ *     1. the per-iteration times, if the record holds them
+ *     2. 'count' samples rebuilt from the mean time and its standard deviation. If only the
+ *        standard deviation of the GFlops is known, the relative standard deviation of the time
+ *        is taken to be the same (to first order, since GFlops are inversely proportional to time).
+ *     3. the time itself, as a single sample
+ *
+ * Inputs
+ * ------
+ *     JsonRecord *record
+ *         The record
+ *
+ *     const ResultSchema *schema, const MetricSchema *metric
+ *         The schema of the record and the metric to read
+ *
+ *     MetricStats *stats
+ *         Samples and GFlops the record's values are added to
+ *
+ * Returns
+ * -------
+ *     false if the record does not hold the metric
+ */
+    JsonField *time_field = json_record_find(record, metric->time_path);
+    JsonField *field;
+    size_t prefix_len;
+    double n, mean, stdev, gflops, value;
+    int i, num_samples = 0;
+
+    if (time_field == NULL || time_field->value.type != JSON_TOKEN_NUMBER)
+        return false;
+    mean = json_token_to_double(time_field->value);
+
+    gflops = 0;
+    if (metric->gflops_path != NULL && (field = json_record_find(record, metric->gflops_path)) != NULL){
+        gflops = json_token_to_double(field->value);
+        stats->gflops_sum += gflops;
+        stats->num_gflops++;
+    }
+
+    // 1. Per-iteration times
+    if (metric->samples_path != NULL){
+        prefix_len = strlen(metric->samples_path);
+        for (i=0; i<record->num_fields; i++){
+            field = &record->fields[i];
+            if (strncmp(field->path, metric->samples_path, prefix_len) != 0 || field->path[prefix_len] != '[')
+                continue;
+            value = json_token_to_double(field->value);
+            stats->times.sum += value;
+            stats->times.sum_sq += value * value;
+            num_samples++;
+        }
+        if (num_samples > 0){
+            stats->times.num_samples += num_samples;
+            return true;
+        }
+    }
+
+    // 2. Mean and standard deviation of 'count' iterations
+    n = 0;
+    if (schema->count_path != NULL && (field = json_record_find(record, schema->count_path)) != NULL)
+        n = (double)json_token_to_long(field->value);
+
+    stdev = -1;
+    if (metric->stdev_path != NULL && (field = json_record_find(record, metric->stdev_path)) != NULL)
+        stdev = json_token_to_double(field->value);
+    else if (metric->stdev_gflops_path != NULL && gflops > 0 && (field = json_record_find(record, metric->stdev_gflops_path)) != NULL)
+        stdev = mean * json_token_to_double(field->value) / gflops;
+
+    if (n >= 1 && stdev >= 0){
+        stats->times.num_samples += (int)n;
+        stats->times.sum += n * mean;
+        stats->times.sum_sq += n * (stdev * stdev + mean * mean);
+        return true;
+    }
+
+    // 3. A single sample
+    stats->times.num_samples++;
+    stats->times.sum += mean;
+    stats->times.sum_sq += mean * mean;
+    return true;
+}
+
+ResultGroup *group_find_or_create(GroupSet *set, char *key, const ResultSchema *schema){
+/* Finds the group with the given key, creating an empty one if it does not exist
+ *
+ * Inputs
+ * ------
+ *     GroupSet *set
+ *         Holds the groups and their index
+ *
+ *     char *key
+ *         Key of the group. The group keeps its own copy.
+ *
+ *     const ResultSchema *schema
+ *         Schema of the group's records
+ *
+ * Returns
+ * -------
+ *     ResultGroup *group
+ *         Pointer to the group, or NULL if memory could not be allocated. Only valid until the
+ *         next group is created.
+ */
+    size_t key_len = strlen(key) + 1;
+    ResultGroup *groups;
+    ResultGroup *group;
+    char *key_copy;
+    int h, new_capacity;
+
+    h = key_index_find(&set->index, key, key_len);
+    if (h != -1)
+        return &set->groups[h];
+
+    if (set->count == set->capacity){
+        new_capacity = (set->capacity == 0) ? INITIAL_CAPACITY : 2 * set->capacity;
+        groups = realloc(set->groups, sizeof(ResultGroup) * new_capacity);
+        if (groups == NULL)
+            return NULL;
+        set->groups = groups;
+        set->capacity = new_capacity;
+    }
+
+    key_copy = malloc(key_len);
+    if (key_copy == NULL)
+        return NULL;
+    memcpy(key_copy, key, key_len);
+    if (key_index_insert(&set->index, key, key_len, set->count) == -1){
+        free(key_copy);
+        return NULL;
+    }
+
+    group = &set->groups[set->count];
+    set->count++;
+    memset(group, 0, sizeof(ResultGroup));
+    group->key = key_copy;
+    group->schema = schema;
+    return group;
+}
+
+void group_set_free(GroupSet *set){
+/* Frees the memory held by a set of groups */
+    int i;
+    for (i=0; i<set->count; i++)
+        free(set->groups[i].key);
+    free(set->groups);
+    key_index_free(&set->index);
+    memset(set, 0, sizeof(GroupSet));
+}
+
+static void __metric_stats_merge(MetricStats *stats, MetricStats *other){
+/* Adds the samples and GFlops of 'other' to 'stats'. Do not call this function directly! */
+    sample_stats_merge(&stats->times, &other->times);
+    stats->gflops_sum += other->gflops_sum;
+    stats->num_gflops += other->num_gflops;
+}
+
+static int __add_record_to_groups(JsonRecord *record, void *handler_args){
+/* Record handler which adds a record's metrics to its group. Do not call this function directly!
+ *
+ * Inputs
+ * ------
+ *     JsonRecord *record
+ *         The record to add
+ *
+ *     void *handler_args
+ *         The ResultFileReader of the file being read
+ *
+ * Returns
+ * -------
+ *     0 so that reading continues, or -1 if memory could not be allocated
+ */
+    ResultFileReader *reader = (ResultFileReader*)handler_args;
+    const ResultSchema *schema;
+    ResultGroup *group;
+    int schema_id, i;
+
+    schema_id = find_schema(record, reader->schemas, reader->num_schemas);
+    if (schema_id == -1){
+        reader->num_unknown++;
+        return 0;
+    }
+    schema = &reader->schemas[schema_id];
+
+    if (record_group_key(record, schema, &reader->key, &reader->key_capacity) == false ||
+        (group = group_find_or_create(&reader->set, reader->key, schema)) == NULL){
+        reader->out_of_memory = true;
+        return -1;
+    }
+
+    group->num_runs[reader->side]++;
+    for (i=0; i<MAX_METRICS && schema->metrics[i].name != NULL; i++)
+        record_metric_stats(record, schema, &schema->metrics[i], &group->metrics[reader->side][i]);
+
+    return 0;
+}
+
+static void __read_result_file_task(int file_id, void *task_args){
+/* Reads one file into the groups of its own ResultFileReader. Do not call this function directly! */
+    ResultFileReader *reader = &((ResultFileReader*)task_args)[file_id];
+    reader->num_records = json_read_records(reader->filename, __add_record_to_groups, reader);
+}
+
+int read_result_files(char **files, int num_files, int num_baseline_files, const ResultSchema *schemas, int num_schemas, GroupSet *set){
+/* Reads result files into a set of groups. Every file is read into its own set of groups on a pool
+ * of threads, one file per task, and the sets are then merged in the order the files were passed.
+ *
+ * Inputs
+ * ------
+ *     char **files, int num_files
+ *         The files to read
+ *
+ *     int num_baseline_files
+ *         The first 'num_baseline_files' files are the baseline (or summary) side, the rest are the
+ *         candidate side
+ *
+ *     const ResultSchema *schemas, int num_schemas
+ *         Layouts to accept. Records which follow none of them are skipped with a warning.
+ *
+ *     GroupSet *set
+ *         Initialized by this function. Free it with group_set_free() when done.
+ *
+ * Returns
+ * -------
+ *     0 on success, -1 if any of the files could not be read
+ */
+    ResultFileReader *readers = calloc(num_files, sizeof(ResultFileReader));
+    ResultGroup *file_group;
+    ResultGroup *group;
+    int success = 0;
+    int i, h, m;
+
+    memset(set, 0, sizeof(GroupSet));
+    if (readers == NULL){
+        fprintf(stderr, "Could not allocate memory to read %d files\n", num_files);
+        return -1;
+    }
+
+    // Read every file into its own set of groups on a pool of threads...
+    for (i=0; i<num_files; i++){
+        readers[i].filename = files[i];
+        readers[i].side = (i < num_baseline_files) ? 0 : 1;
+        readers[i].schemas = schemas;
+        readers[i].num_schemas = num_schemas;
+    }
+    run_file_tasks(num_files, __read_result_file_task, readers);
+
+    // ...then merge them, in the order the files were passed, into one set of groups
+    for (i=0; i<num_files; i++){
+        if (success == 0 && readers[i].out_of_memory == true){
+            fprintf(stderr, "Could not allocate memory for the groups of %s\n", files[i]);
+            success = -1;
+        }
+        else if (success == 0 && readers[i].num_records < 0){
+            fprintf(stderr, "Could not parse %s\n", files[i]);
+            success = -1;
+        }
+        else if (success == 0 && readers[i].num_unknown > 0)
+            fprintf(stderr, "<< WARNING >> %d of %d entries in %s do not match any known results layout. Skipping them.\n",
+                    readers[i].num_unknown, readers[i].num_records, files[i]);
+
+        for (h=0; h<readers[i].set.count && success == 0; h++){
+            file_group = &readers[i].set.groups[h];
+            group = group_find_or_create(set, file_group->key, file_group->schema);
+            if (group == NULL){
+                fprintf(stderr, "Could not allocate memory for %d groups\n", set->count + 1);
+                success = -1;
+                break;
+            }
+            group->num_runs[0] += file_group->num_runs[0];
+            group->num_runs[1] += file_group->num_runs[1];
+            for (m=0; m<MAX_METRICS; m++){
+                __metric_stats_merge(&group->metrics[0][m], &file_group->metrics[0][m]);
+                __metric_stats_merge(&group->metrics[1][m], &file_group->metrics[1][m]);
+            }
+        }
+
+        group_set_free(&readers[i].set);
+        free(readers[i].key);
+    }
+    free(readers);
+
+    return success;
+}
+
+void print_group_header(ResultGroup *group){
+/* Prints the key of a group, one input per line */
+    char *input = group->key;
+    char *end;
+
+    end = strchr(input, '\n');
+    printf("%.*s\n", (end == NULL) ? (int)strlen(input) : (int)(end - input), input);
+    while (end != NULL){
+        input = end + 1;
+        end = strchr(input, '\n');
+        printf("    %.*s\n", (end == NULL) ? (int)strlen(input) : (int)(end - input), input);
+    }
+}
+
+int parse_regression_args(int argc, char *argv[], char *usage_str, RegressionArgs *args){
+/* Parses the arguments of a regression gate:
+ *
+ *     [--threshold <percent>] [--alpha <significance>] --baseline <file> [<file> ...] --candidate <file> [<file> ...]
+ *
+ * Inputs
+ * ------
+ *     int argc, char *argv[]
+ *         Arguments following "regress"
+ *
+ *     char *usage_str
+ *         Printed along with errors about the arguments
+ *
+ *     RegressionArgs *args
+ *         Filled by this function. Free its file lists when done.
+ *
+ * Returns
+ * -------
+ *     0 on success, -1 for invalid arguments (after printing why)
+ */
+    char ***current_files = NULL;
+    int *current_count = NULL;
+    char *pEnd;
+    int i;
+
+    args->threshold = DEFAULT_REGRESSION_THRESHOLD;
+    args->significance = DEFAULT_SIGNIFICANCE;
+    args->baseline_files = malloc(sizeof(char*) * (argc + 1));
+    args->candidate_files = malloc(sizeof(char*) * (argc + 1));
+    args->num_baseline_files = 0;
+    args->num_candidate_files = 0;
+    if (args->baseline_files == NULL || args->candidate_files == NULL){
+        fprintf(stderr, "Could not allocate memory for %d file names\n", argc);
+        goto invalid;
+    }
+
+    for (i=0; i<argc; i++){
+        if (strcmp(argv[i], "--threshold") == 0 || strcmp(argv[i], "--alpha") == 0){
+            if (i + 1 >= argc){
+                fprintf(stderr, "%s requires a value. %s\n", argv[i], usage_str);
+                goto invalid;
+            }
+            if (strcmp(argv[i], "--threshold") == 0)
+                args->threshold = strtod(argv[i+1], &pEnd);
+            else
+                args->significance = strtod(argv[i+1], &pEnd);
+            if (*pEnd != '\0'){
+                fprintf(stderr, "Invalid value '%s' for %s.\n", argv[i+1], argv[i]);
+                goto invalid;
+            }
+            current_files = NULL;
+            i++;
+        }
+        else if (strcmp(argv[i], "--baseline") == 0){
+            current_files = &args->baseline_files;
+            current_count = &args->num_baseline_files;
+        }
+        else if (strcmp(argv[i], "--candidate") == 0){
+            current_files = &args->candidate_files;
+            current_count = &args->num_candidate_files;
+        }
+        else if (current_files != NULL){
+            if (access(argv[i], F_OK) == -1){
+                fprintf(stderr, "%s does not exist.\n", argv[i]);
+                goto invalid;
+            }
+            (*current_files)[*current_count] = argv[i];
+            (*current_count)++;
+        }
+        else{
+            fprintf(stderr, "Unexpected argument '%s'. %s\n", argv[i], usage_str);
+            goto invalid;
+        }
+    }
+
+    if (args->num_baseline_files == 0 || args->num_candidate_files == 0){
+        fprintf(stderr, "At least one baseline and one candidate file are required. %s\n", usage_str);
+        goto invalid;
+    }
+    if (args->threshold < 0){
+        fprintf(stderr, "The threshold must be greater than or equal to 0. You entered: %0.2f\n", args->threshold);
+        goto invalid;
+    }
+    if (args->significance <= 0 || args->significance >= 1){
+        fprintf(stderr, "The significance level must be between 0 and 1. You entered: %0.3f\n", args->significance);
+        goto invalid;
+    }
+    return 0;
+
+invalid:
+    free(args->baseline_files);
+    free(args->candidate_files);
+    args->baseline_files = NULL;
+    args->candidate_files = NULL;
+    return -1;
+}
+
+int run_results_summary(int argc, char *argv[], char *tool_name, const ResultSchema *schemas, int num_schemas){
+/* Prints every group found in the given files, along with the mean time (and GFlops) of each
+ * metric
+ *
+ * Inputs
+ * ------
+ *     int argc, char *argv[]
+ *         Files following "summary"
+ *
+ *     char *tool_name
+ *         Name of the calling executable, used in the usage message
+ *
+ *     const ResultSchema *schemas, int num_schemas
+ *         Layouts to accept
+ *
+ * Returns
+ * -------
+ *     0 on success, 2 for invalid input
+ */
+    GroupSet set;
+    MetricStats *stats;
+    const ResultSchema *schema;
+    double mean, stdev;
+    int i, m;
+
+    if (argc == 0){
+        fprintf(stderr, "At least one file is required. Usage: %s summary <file> [<file> ...]\n", tool_name);
+        return 2;
+    }
+    for (i=0; i<argc; i++){
+        if (access(argv[i], F_OK) == -1){
+            fprintf(stderr, "%s does not exist.\n", argv[i]);
+            return 2;
+        }
+    }
+
+    if (read_result_files(argv, argc, argc, schemas, num_schemas, &set) == -1){
+        group_set_free(&set);
+        return 2;
+    }
+
+    printf("Results Summary\n");
+    printf("=======================\n");
+    for (i=0; i<set.count; i++){
+        schema = set.groups[i].schema;
+        print_group_header(&set.groups[i]);
+        printf("    %d run(s)\n", set.groups[i].num_runs[0]);
+
+        for (m=0; m<MAX_METRICS && schema->metrics[m].name != NULL; m++){
+            stats = &set.groups[i].metrics[0][m];
+            if (stats->times.num_samples == 0)
+                continue;
+            mean = stats->times.sum / stats->times.num_samples;
+            stdev = (stats->times.num_samples > 1) ? sqrt(fmax((stats->times.sum_sq - stats->times.num_samples * mean * mean) / (stats->times.num_samples - 1), 0.0)) : 0.0;
+            printf("    %-13s %0.6f sec (stdev: %0.6f, n = %d)", schema->metrics[m].name, mean, stdev, stats->times.num_samples);
+            if (stats->num_gflops > 0)
+                printf(", %0.2f GFlops", stats->gflops_sum / stats->num_gflops);
+            printf("\n");
+        }
+        printf("\n");
+    }
+    printf("%d group(s)\n", set.count);
+
+    group_set_free(&set);
+    return 0;
+}
+
+int run_regression_gate(int argc, char *argv[], char *tool_name, const ResultSchema *schemas, int num_schemas){
+/* Compares a baseline result set against a candidate result set, which may mix the results of any
+ * of the given layouts. Within each group, every metric is compared with Welch's t-test. A metric
+ * regresses when the candidate's mean time is more than 'threshold' percent higher than the
+ * baseline's AND the slowdown is statistically significant. Baseline groups without a matching
+ * candidate group are listed, and the gate fails as invalid input if no metric could be compared.
+ *
+ * Inputs
+ * ------
+ *     int argc, char *argv[]
+ *         Arguments following "regress"
+ *
+ *     char *tool_name
+ *         Name of the calling executable, used in the usage message
+ *
+ *     const ResultSchema *schemas, int num_schemas
+ *         Layouts to accept
+ *
+ * Returns
+ * -------
+ *     0 if nothing regressed, 1 if at least one metric regressed, 2 for invalid input (including
+ *     result sets which have no metric in common)
+ */
+    char usage_str[MAX_USAGE_LEN];
+    RegressionArgs args;
+    char **files;
+    GroupSet set;
+    int i, m;
+
+    snprintf(usage_str, MAX_USAGE_LEN, "Usage: %s regress [--threshold <percent>] [--alpha <significance>] "
+             "--baseline <file> [<file> ...] --candidate <file> [<file> ...]", tool_name);
+    if (parse_regression_args(argc, argv, usage_str, &args) == -1)
+        return 2;
+
+    // Group the samples of both result sets, baseline files first
+    files = malloc(sizeof(char*) * (args.num_baseline_files + args.num_candidate_files));
+    if (files == NULL){
+        fprintf(stderr, "Could not allocate memory for %d file names\n", args.num_baseline_files + args.num_candidate_files);
+        free(args.baseline_files);
+        free(args.candidate_files);
+        return 2;
+    }
+    memcpy(files, args.baseline_files, sizeof(char*) * args.num_baseline_files);
+    memcpy(files + args.num_baseline_files, args.candidate_files, sizeof(char*) * args.num_candidate_files);
+    i = read_result_files(files, args.num_baseline_files + args.num_candidate_files, args.num_baseline_files, schemas, num_schemas, &set);
+    free(files);
+    free(args.baseline_files);
+    free(args.candidate_files);
+    if (i == -1){
+        group_set_free(&set);
+        return 2;
+    }
+
+    // Test every metric of every group which appears in both result sets
+    const ResultSchema *schema;
+    ResultGroup *group;
+    MetricStats *baseline, *candidate;
+    WelchResult result;
+    int num_compared = 0;
+    int num_regressions = 0;
+    int num_unmatched = 0;
+    bool regressed;
+    char *c;
+
+    printf("Regression Gate (threshold: %0.2f%%, significance: %0.3f)\n", args.threshold, args.significance);
+    printf("=======================\n");
+    for (i=0; i<set.count; i++){
+        group = &set.groups[i];
+        schema = group->schema;
+        print_group_header(group);
+
+        if (group->num_runs[0] == 0 || group->num_runs[1] == 0){
+            printf("    Only found in the %s. Skipping.\n\n", (group->num_runs[0] == 0) ? "candidate" : "baseline");
+            if (group->num_runs[1] == 0)
+                num_unmatched++;
+            continue;
+        }
+
+        for (m=0; m<MAX_METRICS && schema->metrics[m].name != NULL; m++){
+            baseline = &group->metrics[0][m];
+            candidate = &group->metrics[1][m];
+            if (baseline->times.num_samples == 0 && candidate->times.num_samples == 0)
+                continue;
+
+            printf("    [%s]\n", schema->metrics[m].name);
+            if (welch_t_test(&baseline->times, &candidate->times, args.significance, &result) == false){
+                printf("        Not enough samples to compare (baseline: %d, candidate: %d). Skipping.\n",
+                       baseline->times.num_samples, candidate->times.num_samples);
+                continue;
+            }
+
+            num_compared++;
+            regressed = (result.change_percent > args.threshold && result.p_value < args.significance);
+            if (regressed == true)
+                num_regressions++;
+
+            printf("        Baseline:  %0.6f sec (n = %d)", result.baseline_mean, baseline->times.num_samples);
+            if (baseline->num_gflops > 0)
+                printf(", %0.2f GFlops", baseline->gflops_sum / baseline->num_gflops);
+            printf("\n");
+            printf("        Candidate: %0.6f sec (n = %d)", result.candidate_mean, candidate->times.num_samples);
+            if (candidate->num_gflops > 0)
+                printf(", %0.2f GFlops", candidate->gflops_sum / candidate->num_gflops);
+            printf("\n");
+            printf("        Change in time: %+0.2f%% (%0.0f%% CI: %+0.2f%% to %+0.2f%%)\n", result.change_percent,
+                   100.0 * (1.0 - args.significance), result.ci_low_percent, result.ci_high_percent);
+            printf("        Welch's t: %0.3f, df: %0.1f, p-value: %0.4g, Hedges' g: %0.3f\n", result.t, result.df, result.p_value, result.hedges_g);
+            printf("        Result: %s\n", (regressed == true) ? "REGRESSION" : "ok");
+        }
+        printf("\n");
+    }
+
+    printf("%d of %d compared metric(s) regressed\n", num_regressions, num_compared);
+
+    // Baseline groups without a candidate usually mean that the inputs differ, e.g. a key field
+    // which older result files do not hold (such as "blas_library"). List them on one line each.
+    if (num_unmatched > 0){
+        fprintf(stderr, "<< WARNING >> %d baseline group(s) have no matching candidate group:\n", num_unmatched);
+        for (i=0; i<set.count; i++){
+            if (set.groups[i].num_runs[0] == 0 || set.groups[i].num_runs[1] > 0)
+                continue;
+            fprintf(stderr, "    ");
+            for (c=set.groups[i].key; *c != '\0'; c++){
+                if (*c == '\n')
+                    fprintf(stderr, ", ");
+                else
+                    fputc(*c, stderr);
+            }
+            fprintf(stderr, "\n");
+        }
+    }
+
+    group_set_free(&set);
+
+    // A gate which tested nothing must not pass
+    if (num_compared == 0){
+        fprintf(stderr, "No metric could be compared between the baseline and the candidate.\n");
+        return 2;
+    }
+    return (num_regressions > 0) ? 1 : 0;
+}
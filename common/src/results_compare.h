@@ -0,0 +1,114 @@
+/* Schema-driven grouping and comparison of benchmark results, shared by the results comparison
+ * tools.
+ *
+ * Every benchmark writes its own JSON layout. Rather than hard-coding one of them, each layout is
+ * described by a schema: the field which identifies it, the fields which make two runs comparable
+ * (their "group"), and the timing metrics of a run. Result files are read in parallel, one file
+ * per task, and their records are folded into groups through a hash index. Groups can then be
+ * summarized, or the baseline and candidate sides of each group compared with Welch's t-test.
+ */
+#ifndef RESULTS_COMPARE_H
+#define RESULTS_COMPARE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "results_json.h"
+#include "results_stats.h"
+
+#define MAX_METRICS 4
+#define DEFAULT_REGRESSION_THRESHOLD 5.0   //percent increase in execution time
+#define DEFAULT_SIGNIFICANCE 0.05
+
+typedef struct {
+    char *name;
+    char *time_path;            //mean time per iteration, or total time of the run
+    char *stdev_path;           //standard deviation of the time per iteration (optional)
+    char *gflops_path;          //GFlops of the run (optional)
+    char *stdev_gflops_path;    //standard deviation of the GFlops (optional, used without 'stdev_path')
+    char *samples_path;         //array of per-iteration times (optional)
+} MetricSchema;
+
+typedef struct {
+    char *name;
+    char *detect_path;          //records holding this field follow this schema
+    char **key_paths;           //NULL-terminated list of fields (or arrays) identifying comparable runs
+    char *count_path;           //number of iterations behind 'time_path' (optional)
+    MetricSchema metrics[MAX_METRICS];
+} ResultSchema;
+
+// Layouts written by the benchmarks of this repository, indexed by the IDs below
+#define GEMM_SCHEMA 0
+#define ND_COSINE_DFT_SCHEMA 1
+#define BLUR_2D_SCHEMA 2
+#define NUM_RESULT_SCHEMAS 3
+extern const ResultSchema RESULT_SCHEMAS[NUM_RESULT_SCHEMAS];
+
+typedef struct {
+    uint64_t hash;
+    int value;          //-1 for empty slots
+    void *key;          //copy of the key
+    size_t key_len;
+} KeyIndexSlot;
+
+// Open-addressing hash index from byte strings to ints. Keys are compared byte for byte, so
+// struct keys must be zeroed (padding included) before they are filled.
+typedef struct {
+    KeyIndexSlot *slots;
+    int num_slots;      //always a power of 2
+    int count;
+} KeyIndex;
+
+// A task which processes the file with the given ID
+typedef void (*FileTask)(int file_id, void *task_args);
+
+typedef struct {
+    SampleStats times;
+    double gflops_sum;
+    int num_gflops;
+} MetricStats;
+
+typedef struct {
+    char *key;                              //schema name followed by one "name=value" line per input
+    const ResultSchema *schema;
+    int num_runs[2];                        //baseline, candidate
+    MetricStats metrics[2][MAX_METRICS];
+} ResultGroup;
+
+typedef struct {
+    ResultGroup *groups;
+    int count;
+    int capacity;
+    KeyIndex index;     //maps a group key to its position in 'groups'
+} GroupSet;
+
+typedef struct {
+    double threshold;           //percent increase in execution time
+    double significance;
+    char **baseline_files;
+    int num_baseline_files;
+    char **candidate_files;
+    int num_candidate_files;
+} RegressionArgs;
+
+uint64_t fnv1a_hash(const void *data, size_t len);
+int key_index_find(KeyIndex *index, const void *key, size_t key_len);
+int key_index_insert(KeyIndex *index, const void *key, size_t key_len, int value);
+void key_index_free(KeyIndex *index);
+
+int get_num_ingest_threads(int num_files);
+void run_file_tasks(int num_files, FileTask task, void *task_args);
+
+int find_schema(JsonRecord *record, const ResultSchema *schemas, int num_schemas);
+bool record_group_key(JsonRecord *record, const ResultSchema *schema, char **key, size_t *key_capacity);
+bool record_metric_stats(JsonRecord *record, const ResultSchema *schema, const MetricSchema *metric, MetricStats *stats);
+ResultGroup *group_find_or_create(GroupSet *set, char *key, const ResultSchema *schema);
+void group_set_free(GroupSet *set);
+int read_result_files(char **files, int num_files, int num_baseline_files, const ResultSchema *schemas, int num_schemas, GroupSet *set);
+void print_group_header(ResultGroup *group);
+
+int parse_regression_args(int argc, char *argv[], char *usage_str, RegressionArgs *args);
+int run_results_summary(int argc, char *argv[], char *tool_name, const ResultSchema *schemas, int num_schemas);
+int run_regression_gate(int argc, char *argv[], char *tool_name, const ResultSchema *schemas, int num_schemas);
+
+#endif
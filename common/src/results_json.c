@@ -0,0 +1,546 @@
+/* Single-pass, zero-copy reader for benchmark results files. See results_json.h */
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "results_json.h"
+
+#define INITIAL_NUM_FIELDS 32
+#define MAX_NUMBER_LEN 64
+
+static int __parse_value(JsonTokenizer *tokenizer, JsonToken token, JsonRecord *record, char *path, size_t path_len, int depth, const char *source_name);
+
+int json_map_file(const char *filename, JsonMappedFile *mapped_file){
+/* Maps a file into memory (read-only)
+ *
+ * Inputs
+ * ------
+ *     const char *filename
+ *         File to map
+ *
+ *     JsonMappedFile *mapped_file
+ *         Holds the mapped data and its size. An empty file maps to (NULL, 0)
+ *
+ * Returns
+ * -------
+ *     0 on success, -1 if the file could not be opened or mapped
+ */
+    struct stat file_info;
+    void *data;
+    int fd;
+
+    mapped_file->data = NULL;
+    mapped_file->size = 0;
+
+    fd = open(filename, O_RDONLY);
+    if (fd == -1)
+        return -1;
+
+    if (fstat(fd, &file_info) == -1){
+        close(fd);
+        return -1;
+    }
+
+    if (file_info.st_size == 0){
+        close(fd);
+        return 0;
+    }
+
+    data = mmap(NULL, (size_t)file_info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return -1;
+
+    // We only ever walk the file front to back
+    madvise(data, (size_t)file_info.st_size, MADV_SEQUENTIAL);
+
+    mapped_file->data = (char*)data;
+    mapped_file->size = (size_t)file_info.st_size;
+    return 0;
+}
+
+void json_unmap_file(JsonMappedFile *mapped_file){
+/* Unmaps a file mapped by json_map_file */
+    if (mapped_file->data != NULL)
+        munmap(mapped_file->data, mapped_file->size);
+    mapped_file->data = NULL;
+    mapped_file->size = 0;
+}
+
+void json_tokenizer_init(JsonTokenizer *tokenizer, const char *data, size_t size){
+/* Prepares a tokenizer to walk 'size' bytes of 'data' */
+    tokenizer->data = data;
+    tokenizer->size = size;
+    tokenizer->pos = 0;
+    tokenizer->line = 1;
+}
+
+JsonToken json_next_token(JsonTokenizer *tokenizer){
+/* Returns the next token in the buffer. Tokens point into the buffer, so nothing is copied.
+ *
+ * Inputs
+ * ------
+ *     JsonTokenizer *tokenizer
+ *         The tokenizer to advance
+ *
+ * Returns
+ * -------
+ *     JsonToken token
+ *         JSON_TOKEN_END at the end of the buffer, JSON_TOKEN_ERROR for anything that is not JSON
+ */
+    const char *data = tokenizer->data;
+    size_t size = tokenizer->size;
+    size_t pos = tokenizer->pos;
+    JsonToken token;
+    char c;
+
+    // Skip whitespace, keeping track of line numbers for error messages
+    while (pos < size && isspace((unsigned char)data[pos])){
+        if (data[pos] == '\n')
+            tokenizer->line++;
+        pos++;
+    }
+
+    token.start = data + pos;
+    token.length = 1;
+    token.line = tokenizer->line;
+
+    if (pos >= size){
+        token.type = JSON_TOKEN_END;
+        token.length = 0;
+        tokenizer->pos = pos;
+        return token;
+    }
+
+    c = data[pos];
+    switch (c){
+        case '{': token.type = JSON_TOKEN_OBJECT_START; pos++; break;
+        case '}': token.type = JSON_TOKEN_OBJECT_END; pos++; break;
+        case '[': token.type = JSON_TOKEN_ARRAY_START; pos++; break;
+        case ']': token.type = JSON_TOKEN_ARRAY_END; pos++; break;
+        case ':': token.type = JSON_TOKEN_COLON; pos++; break;
+        case ',': token.type = JSON_TOKEN_COMMA; pos++; break;
+        case '"':
+            // Strings are returned without their quotes. Escapes are skipped over, not decoded.
+            pos++;
+            token.start = data + pos;
+            while (pos < size && data[pos] != '"'){
+                if (data[pos] == '\\')
+                    pos++;
+                else if (data[pos] == '\n')
+                    break;
+                pos++;
+            }
+            if (pos >= size || data[pos] != '"'){
+                token.type = JSON_TOKEN_ERROR;
+                break;
+            }
+            token.type = JSON_TOKEN_STRING;
+            token.length = (size_t)(data + pos - token.start);
+            pos++;
+            break;
+        default:
+            if (c == '-' || c == '+' || c == '.' || isdigit((unsigned char)c)){
+                token.type = JSON_TOKEN_NUMBER;
+                pos++;
+
+                // A sign followed by letters is a non-finite value written by printf (e.g., -nan)
+                if ((c == '-' || c == '+') && pos < size && isalpha((unsigned char)data[pos]))
+                    token.type = JSON_TOKEN_LITERAL;
+
+                while (pos < size && (isalnum((unsigned char)data[pos]) || data[pos] == '.' || data[pos] == '-' || data[pos] == '+'))
+                    pos++;
+            }
+            else if (isalpha((unsigned char)c)){
+                // true, false, null (and nan/inf from printf)
+                token.type = JSON_TOKEN_LITERAL;
+                while (pos < size && isalpha((unsigned char)data[pos]))
+                    pos++;
+            }
+            else{
+                token.type = JSON_TOKEN_ERROR;
+                pos++;
+            }
+            token.length = (size_t)(data + pos - token.start);
+            break;
+    }
+
+    tokenizer->pos = pos;
+    return token;
+}
+
+static void __syntax_error(const char *source_name, JsonToken token, const char *expected){
+/* Prints a syntax error. Do not call this function directly! */
+    fprintf(stderr, "Invalid JSON in '%s' on line %zu: expected %s, found '%.*s'.\n", source_name, token.line, expected, (int)(token.length > 20 ? 20 : token.length), token.start);
+}
+
+static int __add_field(JsonRecord *record, const char *path, size_t path_len, JsonToken value){
+/* Appends a (path, value) pair to a record, growing the field list if needed. Do not call this
+ * function directly!
+ */
+    JsonField *fields;
+    int new_capacity;
+
+    if (record->num_fields == record->capacity){
+        new_capacity = (record->capacity == 0) ? INITIAL_NUM_FIELDS : 2 * record->capacity;
+        fields = realloc(record->fields, sizeof(JsonField) * new_capacity);
+        if (fields == NULL)
+            return -1;
+        record->fields = fields;
+        record->capacity = new_capacity;
+    }
+
+    memcpy(record->fields[record->num_fields].path, path, path_len);
+    record->fields[record->num_fields].path[path_len] = '\0';
+    record->fields[record->num_fields].value = value;
+    record->num_fields++;
+    return 0;
+}
+
+static size_t __append_key(char *path, size_t path_len, JsonToken key){
+/* Appends ".key" (or "key" at the start of the path) and returns the new path length. Trailing
+ * colons and spaces inside the key are dropped. Do not call this function directly!
+ */
+    size_t key_len = key.length;
+    while (key_len > 0 && (key.start[key_len-1] == ':' || key.start[key_len-1] == ' '))
+        key_len--;
+
+    if (path_len > 0 && path_len < MAX_JSON_PATH_LEN - 1)
+        path[path_len++] = '.';
+    if (path_len + key_len >= MAX_JSON_PATH_LEN)
+        key_len = MAX_JSON_PATH_LEN - 1 - path_len;
+    memcpy(path + path_len, key.start, key_len);
+    path_len += key_len;
+    path[path_len] = '\0';
+    return path_len;
+}
+
+static int __parse_object(JsonTokenizer *tokenizer, JsonRecord *record, char *path, size_t path_len, int depth, const char *source_name){
+/* Parses the members of an object whose '{' has already been read. Do not call this function directly! */
+    JsonToken token = json_next_token(tokenizer);
+    size_t member_path_len;
+
+    if (token.type == JSON_TOKEN_OBJECT_END)
+        return 0;
+
+    while (true){
+        if (token.type != JSON_TOKEN_STRING){
+            __syntax_error(source_name, token, "a key");
+            return -1;
+        }
+        member_path_len = __append_key(path, path_len, token);
+
+        token = json_next_token(tokenizer);
+        if (token.type != JSON_TOKEN_COLON){
+            __syntax_error(source_name, token, "':'");
+            return -1;
+        }
+
+        if (__parse_value(tokenizer, json_next_token(tokenizer), record, path, member_path_len, depth + 1, source_name) != 0)
+            return -1;
+        path[path_len] = '\0';
+
+        token = json_next_token(tokenizer);
+        if (token.type == JSON_TOKEN_OBJECT_END)
+            return 0;
+        if (token.type != JSON_TOKEN_COMMA){
+            __syntax_error(source_name, token, "',' or '}'");
+            return -1;
+        }
+        token = json_next_token(tokenizer);
+    }
+}
+
+static int __parse_array(JsonTokenizer *tokenizer, JsonRecord *record, char *path, size_t path_len, int depth, const char *source_name){
+/* Parses the elements of an array whose '[' has already been read. Elements get the path
+ * "path[i]". Do not call this function directly!
+ */
+    JsonToken token = json_next_token(tokenizer);
+    int index = 0;
+    int written;
+
+    if (token.type == JSON_TOKEN_ARRAY_END)
+        return 0;
+
+    while (true){
+        written = snprintf(path + path_len, MAX_JSON_PATH_LEN - path_len, "[%d]", index);
+        if (written < 0 || (size_t)written >= MAX_JSON_PATH_LEN - path_len){
+            fprintf(stderr, "JSON path too long in '%s' on line %zu.\n", source_name, token.line);
+            return -1;
+        }
+
+        if (__parse_value(tokenizer, token, record, path, path_len + written, depth + 1, source_name) != 0)
+            return -1;
+        path[path_len] = '\0';
+        index++;
+
+        token = json_next_token(tokenizer);
+        if (token.type == JSON_TOKEN_ARRAY_END)
+            return 0;
+        if (token.type != JSON_TOKEN_COMMA){
+            __syntax_error(source_name, token, "',' or ']'");
+            return -1;
+        }
+        token = json_next_token(tokenizer);
+    }
+}
+
+static int __parse_value(JsonTokenizer *tokenizer, JsonToken token, JsonRecord *record, char *path, size_t path_len, int depth, const char *source_name){
+/* Parses any JSON value, flattening scalars into the record. Do not call this function directly! */
+    if (depth > MAX_JSON_DEPTH){
+        fprintf(stderr, "JSON in '%s' is nested too deeply on line %zu.\n", source_name, token.line);
+        return -1;
+    }
+
+    switch (token.type){
+        case JSON_TOKEN_OBJECT_START:
+            return __parse_object(tokenizer, record, path, path_len, depth, source_name);
+        case JSON_TOKEN_ARRAY_START:
+            return __parse_array(tokenizer, record, path, path_len, depth, source_name);
+        case JSON_TOKEN_STRING:
+        case JSON_TOKEN_NUMBER:
+        case JSON_TOKEN_LITERAL:
+            if (__add_field(record, path, path_len, token) != 0){
+                fprintf(stderr, "Could not allocate memory for JSON fields.\n");
+                return -1;
+            }
+            return 0;
+        default:
+            __syntax_error(source_name, token, "a value");
+            return -1;
+    }
+}
+
+static int __parse_records(const char *data, size_t size, JsonRecordHandler handle_record, void *handler_args, const char *source_name){
+/* Walks the top-level object and hands each record to 'handle_record'. Do not call this function directly! */
+    JsonTokenizer tokenizer;
+    JsonRecord record;
+    JsonToken token;
+    char path[MAX_JSON_PATH_LEN];
+    int num_records = 0;
+    int status = 0;
+
+    json_tokenizer_init(&tokenizer, data, size);
+    memset(&record, 0, sizeof(JsonRecord));
+
+    // An empty file simply has no records
+    token = json_next_token(&tokenizer);
+    if (token.type == JSON_TOKEN_END)
+        return 0;
+    if (token.type != JSON_TOKEN_OBJECT_START){
+        __syntax_error(source_name, token, "'{'");
+        return -1;
+    }
+
+    token = json_next_token(&tokenizer);
+    if (token.type == JSON_TOKEN_OBJECT_END)
+        token.type = JSON_TOKEN_END;
+
+    while (token.type != JSON_TOKEN_END){
+
+        // Each member of the top-level object is one record, keyed by its timestamp
+        if (token.type != JSON_TOKEN_STRING){
+            __syntax_error(source_name, token, "a timestamp key");
+            status = -1;
+            break;
+        }
+        record.key = token.start;
+        record.key_length = token.length;
+        record.line = token.line;
+        record.num_fields = 0;
+
+        token = json_next_token(&tokenizer);
+        if (token.type != JSON_TOKEN_COLON){
+            __syntax_error(source_name, token, "':'");
+            status = -1;
+            break;
+        }
+
+        token = json_next_token(&tokenizer);
+        if (token.type != JSON_TOKEN_OBJECT_START){
+            __syntax_error(source_name, token, "'{'");
+            status = -1;
+            break;
+        }
+
+        path[0] = '\0';
+        if (__parse_object(&tokenizer, &record, path, 0, 1, source_name) != 0){
+            status = -1;
+            break;
+        }
+
+        num_records++;
+        if (handle_record(&record, handler_args) < 0)
+            break;
+
+        token = json_next_token(&tokenizer);
+        if (token.type == JSON_TOKEN_OBJECT_END){
+            token = json_next_token(&tokenizer);
+            if (token.type != JSON_TOKEN_END){
+                __syntax_error(source_name, token, "the end of the file");
+                status = -1;
+            }
+            break;
+        }
+        if (token.type != JSON_TOKEN_COMMA){
+            __syntax_error(source_name, token, "',' or '}'");
+            status = -1;
+            break;
+        }
+        token = json_next_token(&tokenizer);
+    }
+
+    free(record.fields);
+    return (status == 0) ? num_records : status;
+}
+
+int json_parse_records(const char *data, size_t size, JsonRecordHandler handle_record, void *handler_args){
+/* Parses the records held in a buffer
+ *
+ * Inputs
+ * ------
+ *     const char *data, size_t size
+ *         Buffer holding a results file
+ *
+ *     JsonRecordHandler handle_record
+ *         Called once per record. The record (and its tokens) are only valid during the call.
+ *
+ *     void *handler_args
+ *         Passed through to 'handle_record'
+ *
+ * Returns
+ * -------
+ *     Number of records read, or -1 if the buffer is not valid JSON
+ */
+    return __parse_records(data, size, handle_record, handler_args, "<buffer>");
+}
+
+int json_read_records(const char *filename, JsonRecordHandler handle_record, void *handler_args){
+/* Maps a results file and hands each record to 'handle_record' in a single pass
+ *
+ * Inputs
+ * ------
+ *     const char *filename
+ *         Results file to read
+ *
+ *     JsonRecordHandler handle_record
+ *         Called once per record. The record (and its tokens) are only valid during the call.
+ *
+ *     void *handler_args
+ *         Passed through to 'handle_record'
+ *
+ * Returns
+ * -------
+ *     Number of records read, -1 if the file is not valid JSON, or -2 if it could not be read
+ */
+    JsonMappedFile mapped_file;
+    int num_records;
+
+    if (json_map_file(filename, &mapped_file) != 0){
+        fprintf(stderr, "Could not open '%s'.\n", filename);
+        return -2;
+    }
+
+    num_records = __parse_records(mapped_file.data, mapped_file.size, handle_record, handler_args, filename);
+    json_unmap_file(&mapped_file);
+    return num_records;
+}
+
+JsonField *json_record_find(JsonRecord *record, const char *path){
+/* Finds a field by its full path, e.g. "performance_results.inputs.threads". Returns NULL if missing. */
+    int i;
+    for (i=0; i<record->num_fields; i++){
+        if (strcmp(record->fields[i].path, path) == 0)
+            return &record->fields[i];
+    }
+    return NULL;
+}
+
+int json_record_int_array(JsonRecord *record, const char *path, int *values, int max_values){
+/* Reads the integer array at 'path' (i.e., the fields "path[0]", "path[1]", ...)
+ *
+ * Returns
+ * -------
+ *     Number of elements found (which may exceed 'max_values'; only the first 'max_values' are stored)
+ */
+    size_t prefix_len = strlen(path);
+    char *index_end;
+    long index;
+    int num_values = 0;
+    int i;
+
+    for (i=0; i<record->num_fields; i++){
+        if (strncmp(record->fields[i].path, path, prefix_len) != 0 || record->fields[i].path[prefix_len] != '[')
+            continue;
+
+        // Only direct elements (no nested paths after the index)
+        index = strtol(record->fields[i].path + prefix_len + 1, &index_end, 10);
+        if (index_end[0] != ']' || index_end[1] != '\0' || index < 0)
+            continue;
+
+        if (index < max_values)
+            values[index] = (int)json_token_to_long(record->fields[i].value);
+        if (index + 1 > num_values)
+            num_values = (int)index + 1;
+    }
+    return num_values;
+}
+
+bool json_field_is(JsonField *field, const char *path){
+/* Checks whether a field has the given path */
+    return strcmp(field->path, path) == 0;
+}
+
+double json_token_to_double(JsonToken token){
+/* Converts a number (or nan/inf literal) token to a double */
+    char number[MAX_NUMBER_LEN];
+    json_token_copy(token, number, MAX_NUMBER_LEN);
+    return strtod(number, NULL);
+}
+
+long json_token_to_long(JsonToken token){
+/* Converts a number token to a long (fractions are truncated) */
+    char number[MAX_NUMBER_LEN];
+    json_token_copy(token, number, MAX_NUMBER_LEN);
+    if (json_token_is_integer(token))
+        return strtol(number, NULL, 10);
+    return (long)strtod(number, NULL);
+}
+
+bool json_token_is_integer(JsonToken token){
+/* Checks whether a token is a whole number (no fraction or exponent) */
+    size_t i = 0;
+    if (token.type != JSON_TOKEN_NUMBER || token.length == 0)
+        return false;
+    if (token.start[0] == '-' || token.start[0] == '+')
+        i++;
+    if (i == token.length)
+        return false;
+    for (; i<token.length; i++){
+        if (!isdigit((unsigned char)token.start[i]))
+            return false;
+    }
+    return true;
+}
+
+bool json_token_equals(JsonToken token, const char *str){
+/* Compares a (string) token against a C string */
+    size_t len = strlen(str);
+    return token.length == len && strncmp(token.start, str, len) == 0;
+}
+
+void json_token_copy(JsonToken token, char *dest, size_t dest_size){
+/* Copies a token into a NUL-terminated buffer, truncating if necessary */
+    size_t len = token.length;
+    if (dest_size == 0)
+        return;
+    if (len > dest_size - 1)
+        len = dest_size - 1;
+    memcpy(dest, token.start, len);
+    dest[len] = '\0';
+}
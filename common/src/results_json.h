@@ -0,0 +1,89 @@
+/* Shared reader for the JSON results files written by the FFTW and OpenBLAS benchmarks.
+ *
+ * A results file is a single JSON object whose keys are timestamps and whose values are the
+ * results of one run (a "record"). The file is mmap'd and tokenized in a single pass without
+ * copying its contents, and each record is flattened into a list of (path, value) fields, e.g.
+ *
+ *     "performance_results.inputs.dims[1]"  ->  300
+ *     "inputs.gemm_type"                    ->  "dgemm"
+ *
+ * The reader follows the JSON grammar rather than the line layout of the writers, so it does
+ * not care about whitespace, line breaks or the order of keys. Trailing colons inside keys
+ * (e.g. "iterations:" written by gemm_test.c) are dropped from the path.
+ */
+#ifndef RESULTS_JSON_H
+#define RESULTS_JSON_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#define MAX_JSON_PATH_LEN 256
+#define MAX_JSON_DEPTH 32
+
+typedef enum {
+    JSON_TOKEN_OBJECT_START,
+    JSON_TOKEN_OBJECT_END,
+    JSON_TOKEN_ARRAY_START,
+    JSON_TOKEN_ARRAY_END,
+    JSON_TOKEN_COLON,
+    JSON_TOKEN_COMMA,
+    JSON_TOKEN_STRING,
+    JSON_TOKEN_NUMBER,
+    JSON_TOKEN_LITERAL,
+    JSON_TOKEN_END,
+    JSON_TOKEN_ERROR
+} JsonTokenType;
+
+typedef struct {
+    JsonTokenType type;
+    const char *start;  //points into the mapped file. Strings exclude their quotes
+    size_t length;
+    size_t line;
+} JsonToken;
+
+typedef struct {
+    const char *data;
+    size_t size;
+    size_t pos;
+    size_t line;
+} JsonTokenizer;
+
+typedef struct {
+    char path[MAX_JSON_PATH_LEN];
+    JsonToken value;
+} JsonField;
+
+typedef struct {
+    const char *key;    //the record's timestamp key (not NUL-terminated)
+    size_t key_length;
+    size_t line;
+    JsonField *fields;
+    int num_fields;
+    int capacity;
+} JsonRecord;
+
+typedef struct {
+    char *data;
+    size_t size;
+} JsonMappedFile;
+
+// Return a negative value from a handler to stop reading early
+typedef int (*JsonRecordHandler)(JsonRecord *record, void *handler_args);
+
+int json_map_file(const char *filename, JsonMappedFile *mapped_file);
+void json_unmap_file(JsonMappedFile *mapped_file);
+void json_tokenizer_init(JsonTokenizer *tokenizer, const char *data, size_t size);
+JsonToken json_next_token(JsonTokenizer *tokenizer);
+int json_read_records(const char *filename, JsonRecordHandler handle_record, void *handler_args);
+int json_parse_records(const char *data, size_t size, JsonRecordHandler handle_record, void *handler_args);
+
+JsonField *json_record_find(JsonRecord *record, const char *path);
+int json_record_int_array(JsonRecord *record, const char *path, int *values, int max_values);
+bool json_field_is(JsonField *field, const char *path);
+double json_token_to_double(JsonToken token);
+long json_token_to_long(JsonToken token);
+bool json_token_is_integer(JsonToken token);
+bool json_token_equals(JsonToken token, const char *str);
+void json_token_copy(JsonToken token, char *dest, size_t dest_size);
+
+#endif
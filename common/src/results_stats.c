@@ -0,0 +1,186 @@
+#include <math.h>
+#include "results_stats.h"
+
+void sample_stats_merge(SampleStats *stats, SampleStats *other){
+/* Adds the samples summarized by 'other' to 'stats' */
+    stats->num_samples += other->num_samples;
+    stats->sum += other->sum;
+    stats->sum_sq += other->sum_sq;
+}
+
+double regularized_incomplete_beta(double a, double b, double x){
+/* Computes the regularized incomplete beta function I_x(a, b) with Lentz's continued fraction
+ * (see Numerical Recipes, section 6.4)
+ *
+ * Inputs
+ * ------
+ *     double a, b
+ *         Shape parameters (> 0)
+ *
+ *     double x
+ *         Upper limit of integration, in [0, 1]
+ *
+ * Returns
+ * -------
+ *     double I_x(a, b)
+ */
+    double ln_front, aa, c, d, h, delta;
+    int m, m2;
+
+    if (x <= 0.0)
+        return 0.0;
+    if (x >= 1.0)
+        return 1.0;
+
+    // The continued fraction converges quickly only for x < (a + 1) / (a + b + 2)
+    if (x > (a + 1.0) / (a + b + 2.0))
+        return 1.0 - regularized_incomplete_beta(b, a, 1.0 - x);
+
+    ln_front = lgamma(a + b) - lgamma(a) - lgamma(b) + a * log(x) + b * log(1.0 - x);
+
+    c = 1.0;
+    d = 1.0 - (a + b) * x / (a + 1.0);
+    if (fabs(d) < 1e-300)
+        d = 1e-300;
+    d = 1.0 / d;
+    h = d;
+    for (m=1; m<=MAX_BETA_ITERATIONS; m++){
+        m2 = 2 * m;
+
+        // Even step
+        aa = m * (b - m) * x / ((a + m2 - 1.0) * (a + m2));
+        d = 1.0 + aa * d;
+        if (fabs(d) < 1e-300)
+            d = 1e-300;
+        c = 1.0 + aa / c;
+        if (fabs(c) < 1e-300)
+            c = 1e-300;
+        d = 1.0 / d;
+        h *= d * c;
+
+        // Odd step
+        aa = -(a + m) * (a + b + m) * x / ((a + m2) * (a + m2 + 1.0));
+        d = 1.0 + aa * d;
+        if (fabs(d) < 1e-300)
+            d = 1e-300;
+        c = 1.0 + aa / c;
+        if (fabs(c) < 1e-300)
+            c = 1e-300;
+        d = 1.0 / d;
+        delta = d * c;
+        h *= delta;
+
+        if (fabs(delta - 1.0) < 1e-14)
+            break;
+    }
+
+    return exp(ln_front) * h / a;
+}
+
+double students_t_cdf(double t, double df){
+/* Cumulative distribution function of Student's t distribution with 'df' degrees of freedom */
+    double tail = 0.5 * regularized_incomplete_beta(df / 2.0, 0.5, df / (df + t * t));
+    return (t > 0) ? 1.0 - tail : tail;
+}
+
+double students_t_quantile(double p, double df){
+/* Inverse of 'students_t_cdf', found by bisection
+ *
+ * Inputs
+ * ------
+ *     double p
+ *         Probability, in (0, 1)
+ *
+ *     double df
+ *         Degrees of freedom
+ *
+ * Returns
+ * -------
+ *     double t
+ *         The value for which P(T <= t) = p
+ */
+    double low = -1e4;
+    double high = 1e4;
+    double mid = 0.0;
+    int i;
+
+    for (i=0; i<200 && high - low > STATS_PRECISION * STATS_PRECISION; i++){
+        mid = 0.5 * (low + high);
+        if (students_t_cdf(mid, df) < p)
+            low = mid;
+        else
+            high = mid;
+    }
+    return mid;
+}
+
+bool welch_t_test(SampleStats *baseline, SampleStats *candidate, double significance, WelchResult *result){
+/* Runs Welch's unequal-variance t-test on the execution times of a baseline and a candidate,
+ * testing whether the candidate is slower (i.e., has a larger mean). Also computes Hedges' g (bias-corrected effect size)
+ * and the (1 - significance) confidence interval of the change in mean execution time.
+ *
+ * Inputs
+ * ------
+ *     SampleStats *baseline, *candidate
+ *         Execution time samples of each side
+ *
+ *     double significance
+ *         Significance level (e.g., 0.05)
+ *
+ *     WelchResult *result
+ *         Holds the results of the test
+ *
+ * Returns
+ * -------
+ *     false if either side has fewer than two samples (in which case nothing is tested)
+ */
+    double n1 = baseline->num_samples;
+    double n2 = candidate->num_samples;
+    double m1, m2, v1, v2, se_sq, se, diff, t_critical, pooled_stdev;
+    double ci_low, ci_high;
+
+    if (n1 < 2 || n2 < 2)
+        return false;
+
+    // Means and (sample) variances
+    m1 = baseline->sum / n1;
+    m2 = candidate->sum / n2;
+    v1 = fmax((baseline->sum_sq - n1 * m1 * m1) / (n1 - 1), 0.0);
+    v2 = fmax((candidate->sum_sq - n2 * m2 * m2) / (n2 - 1), 0.0);
+
+    // A positive difference means the candidate is slower
+    diff = m2 - m1;
+    se_sq = v1 / n1 + v2 / n2;
+
+    if (se_sq > 0){
+        se = sqrt(se_sq);
+        result->t = diff / se;
+
+        // Welch-Satterthwaite degrees of freedom
+        result->df = (se_sq * se_sq) / ((v1 / n1) * (v1 / n1) / (n1 - 1) + (v2 / n2) * (v2 / n2) / (n2 - 1));
+        result->p_value = 1.0 - students_t_cdf(result->t, result->df);
+
+        t_critical = students_t_quantile(1.0 - significance / 2.0, result->df);
+        ci_low = diff - t_critical * se;
+        ci_high = diff + t_critical * se;
+    }
+    else{
+        // Every sample on both sides is identical, so any difference is certain
+        result->t = (diff > 0) ? INFINITY : ((diff < 0) ? -INFINITY : 0.0);
+        result->df = n1 + n2 - 2;
+        result->p_value = (diff > 0) ? 0.0 : 1.0;
+        ci_low = diff;
+        ci_high = diff;
+    }
+
+    // Hedges' g: Cohen's d with the pooled standard deviation, corrected for small samples
+    pooled_stdev = sqrt(((n1 - 1) * v1 + (n2 - 1) * v2) / (n1 + n2 - 2));
+    result->hedges_g = (pooled_stdev > 0) ? (diff / pooled_stdev) * (1.0 - 3.0 / (4.0 * (n1 + n2) - 9.0)) : 0.0;
+
+    result->baseline_mean = m1;
+    result->candidate_mean = m2;
+    result->change_percent = 100.0 * diff / m1;
+    result->ci_low_percent = 100.0 * ci_low / m1;
+    result->ci_high_percent = 100.0 * ci_high / m1;
+    return true;
+}
@@ -0,0 +1,39 @@
+/* Statistics shared by the results comparison tools.
+ *
+ * Samples are summarized by their count, sum and sum of squares, so that the samples of many runs
+ * (or many files) can be combined without keeping them around. Two summaries can then be compared
+ * with Welch's t-test, which does not assume that both sides have the same variance.
+ */
+#ifndef RESULTS_STATS_H
+#define RESULTS_STATS_H
+
+#include <stdbool.h>
+
+#define MAX_BETA_ITERATIONS 300
+#define STATS_PRECISION 1e-5
+
+typedef struct {
+    int num_samples;
+    double sum;
+    double sum_sq;
+} SampleStats;
+
+typedef struct {
+    double baseline_mean;
+    double candidate_mean;
+    double change_percent;      //relative change in mean
+    double ci_low_percent;      //confidence interval of 'change_percent'
+    double ci_high_percent;
+    double t;
+    double df;
+    double p_value;             //one-sided: probability of an increase at least this large by chance
+    double hedges_g;
+} WelchResult;
+
+void sample_stats_merge(SampleStats *stats, SampleStats *other);
+double regularized_incomplete_beta(double a, double b, double x);
+double students_t_cdf(double t, double df);
+double students_t_quantile(double p, double df);
+bool welch_t_test(SampleStats *baseline, SampleStats *candidate, double significance, WelchResult *result);
+
+#endif